@@ -30,5 +30,8 @@ public class EquipmentSystemCore : ModuleRules
 				"GameplayCore"
 			}
 		);
+
+		// Replication fragments of the containers and instances, see RegisterReplicationFragments
+		SetupIrisSupport(Target);
 	}
 }
\ No newline at end of file
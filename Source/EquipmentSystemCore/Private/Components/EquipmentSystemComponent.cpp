@@ -8,7 +8,6 @@
 #include "Data/Slots/EquipmentSlotMapData.h"
 #include "Data/Slots/SlotDefinition.h"
 #include "Definitions/Fragments/ItemFragment_Equippable.h"
-#include "Engine/ActorChannel.h"
 #include "GameplayTags/EquipmentGameplayTags.h"
 #include "Instances/EquipmentInstance.h"
 #include "Instances/ItemInstance.h"
@@ -37,21 +36,6 @@ void UEquipmentSystemComponent::GetLifetimeReplicatedProps(TArray<FLifetimePrope
 	DOREPLIFETIME(ThisClass, EquipmentList);
 }
 
-bool UEquipmentSystemComponent::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
-{
-	bool bReplicated = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
-
-	for (FEquipmentEntry& Entry : EquipmentList.Entries)
-	{
-		if (UEquipmentInstance* Instance = Entry.Instance; IsValid(Instance))
-		{
-			bReplicated |= Channel->ReplicateSubobject(Instance, *Bunch, *RepFlags);
-		}
-	}
-
-	return bReplicated;
-}
-
 void UEquipmentSystemComponent::ReadyForReplication()
 {
 	Super::ReadyForReplication();
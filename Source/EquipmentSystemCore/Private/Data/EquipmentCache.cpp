@@ -3,6 +3,7 @@
 #include "Data/EquipmentCache.h"
 
 #include "Definitions/EquipmentDefinition.h"
+#include "Misc/ScopeRWLock.h"
 
 UEquipmentCache::UEquipmentCache()
 {
@@ -23,8 +24,21 @@ UEquipmentDefinition* UEquipmentCache::GetCachedDefinition(const TSubclassOf<UEq
 		return nullptr;
 	}
 
-	// Lock the critical section to ensure thread-safe access to the cache
-	FScopeLock Lock(&CacheLock);
+	// Hits only share the read lock
+	{
+		FReadScopeLock ReadLock(CacheLock);
+		if (const TWeakObjectPtr<UEquipmentDefinition>* const FoundDefinition = CachedDefinitionMap.Find(Class))
+		{
+			if (UEquipmentDefinition* Definition = FoundDefinition->Get(); IsValid(Definition))
+			{
+				return Definition;
+			}
+		}
+	}
+
+	FWriteScopeLock WriteLock(CacheLock);
+
+	// May have been added by another thread between the locks
 	if (const TWeakObjectPtr<UEquipmentDefinition>* const FoundDefinition = CachedDefinitionMap.Find(Class))
 	{
 		if (UEquipmentDefinition* Definition = FoundDefinition->Get(); IsValid(Definition))
@@ -40,9 +54,9 @@ UEquipmentDefinition* UEquipmentCache::GetCachedDefinition(const TSubclassOf<UEq
 	return NewDefinition;
 }
 
-bool UEquipmentCache::IsCachedDefinition(const TSubclassOf<UEquipmentDefinition>& Class)
+bool UEquipmentCache::IsCachedDefinition(const TSubclassOf<UEquipmentDefinition>& Class) const
 {
-	FScopeLock Lock(&CacheLock);
+	FReadScopeLock ReadLock(CacheLock);
 	const bool IsCachedDefinition = CachedDefinitionMap.Contains(Class);
 	return IsCachedDefinition;
 }
@@ -51,8 +65,7 @@ void UEquipmentCache::Clean()
 {
 	if (IsValid(this))
 	{
-		// Lock the critical section to ensure thread-safe access to the cache
-		FScopeLock Lock(&CacheLock);
+		FWriteScopeLock WriteLock(CacheLock);
 		for (auto It = CachedDefinitionMap.CreateIterator(); It; ++It)
 		{
 			if (It.Value() == nullptr || !It.Value().IsValid())
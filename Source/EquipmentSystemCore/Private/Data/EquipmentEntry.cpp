@@ -3,6 +3,7 @@
 #include "Data/EquipmentEntry.h"
 
 #include "Components/EquipmentSystemComponent.h"
+#include "Data/DefinitionNetIdTable.h"
 #include "Data/EquipmentList.h"
 #include "Definitions/EquipmentDefinition.h"
 #include "Instances/EquipmentInstance.h"
@@ -32,6 +33,16 @@ void FEquipmentEntry::PostReplicatedChange(const FEquipmentList& InArraySerializ
 	}
 }
 
+bool FEquipmentEntry::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	UObject* Object = Instance;
+	bOutSuccess = Map->SerializeObject(Ar, UEquipmentInstance::StaticClass(), Object);
+	Instance = Cast<UEquipmentInstance>(Object);
+
+	bOutSuccess &= FDefinitionNetIdTable::NetSerializeClass(Ar, Map, EquipmentDefinition);
+	return true;
+}
+
 FString FEquipmentEntry::GetDebugString() const
 {
 	return FString::Printf(TEXT("%s [Def: %s]"), *GetNameSafe(Instance), *GetNameSafe(EquipmentDefinition.Get()));
@@ -142,6 +142,7 @@ FEquipmentResult FEquipmentList::Add(const TSubclassOf<UEquipmentDefinition>& De
 
 	// Mark the item dirty for the serializer replication
 	MarkItemDirty(Entry);
+	WakeDormantOwner();
 
 	return Result;
 }
@@ -165,6 +166,7 @@ void FEquipmentList::Remove(UEquipmentInstance* Instance, FGameplayTag& OutFailu
 
 			EntryIterator.RemoveCurrent();
 			MarkArrayDirty();
+			WakeDormantOwner();
 		}
 	}
 }
@@ -204,6 +206,16 @@ void FEquipmentList::Internal_OnEntryRemoved(const int32 Index, const FEquipment
 	OwnerComponent->PostEquipmentChanged(Data);
 }
 
+void FEquipmentList::WakeDormantOwner() const
+{
+	// Dormant actors are not considered for replication, whatever their dirty state
+	AActor* OwnerActor = OwnerComponent ? OwnerComponent->GetOwner() : nullptr;
+	if (OwnerActor && OwnerActor->NetDormancy > DORM_Awake && OwnerActor->HasAuthority())
+	{
+		OwnerActor->FlushNetDormancy();
+	}
+}
+
 UAbilitySystemComponent* FEquipmentList::GetAbilitySystemComponent() const
 {
 	check(OwnerComponent);
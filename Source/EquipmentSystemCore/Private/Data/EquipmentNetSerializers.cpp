@@ -0,0 +1,138 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Data/InventoryNetSerializers.h"
+
+#if UE_WITH_IRIS
+
+#include "Data/EquipmentEntry.h"
+#include "Definitions/EquipmentDefinition.h"
+#include "Instances/EquipmentInstance.h"
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+#include "Iris/Serialization/ObjectNetSerializer.h"
+
+/**
+ * Iris counterpart of FEquipmentEntry::NetSerialize, registered for the struct name so that the equipment definition is
+ * sent as its FDefinitionNetIdTable code on both replication systems, like the inventory entries.
+ */
+namespace UE::Net
+{
+	struct FEquipmentEntryNetSerializerConfig : public FNetSerializerConfig
+	{
+	};
+
+	/**
+	 * @struct FEquipmentEntryNetSerializer
+	 * @see FEquipmentEntry::NetSerialize
+	 * @brief Sends the instance of an equipment entry as an object reference and its definition as its net code
+	 */
+	struct FEquipmentEntryNetSerializer
+	{
+		static constexpr uint32 Version = 0;
+		static constexpr bool bHasCustomNetReference = true;
+
+		struct FQuantizedType
+		{
+			FNetObjectReference Instance;
+			InventoryNetSerializers::FQuantizedDefinitionClass EquipmentDefinition;
+		};
+
+		typedef FEquipmentEntry SourceType;
+		typedef FQuantizedType QuantizedType;
+		typedef FEquipmentEntryNetSerializerConfig ConfigType;
+		static const ConfigType DefaultConfig;
+
+		static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+		{
+			const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			InventoryNetSerializers::SerializeObject(Context, Source.Instance);
+			InventoryNetSerializers::SerializeDefinitionClass(Context, Source.EquipmentDefinition);
+		}
+
+		static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+		{
+			QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+			InventoryNetSerializers::DeserializeObject(Context, Target.Instance);
+			InventoryNetSerializers::DeserializeDefinitionClass(Context, Target.EquipmentDefinition);
+		}
+
+		static void Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+		{
+			const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+			QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+
+			InventoryNetSerializers::QuantizeObject(Context, Source.Instance, Target.Instance);
+			InventoryNetSerializers::QuantizeDefinitionClass(Context, UEquipmentDefinition::StaticClass(), Source.EquipmentDefinition, Target.EquipmentDefinition);
+		}
+
+		static void Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+		{
+			const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+
+			// Only the replicated fields are written, the granted handles and the last instance are kept
+			Target.Instance = Cast<UEquipmentInstance>(InventoryNetSerializers::DequantizeObject(Context, Source.Instance));
+			Target.EquipmentDefinition = InventoryNetSerializers::DequantizeDefinitionClass(Context, UEquipmentDefinition::StaticClass(), Source.EquipmentDefinition);
+		}
+
+		static bool IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+		{
+			if (Args.bStateIsQuantized)
+			{
+				const QuantizedType& A = *reinterpret_cast<const QuantizedType*>(Args.Source0);
+				const QuantizedType& B = *reinterpret_cast<const QuantizedType*>(Args.Source1);
+				return A.Instance == B.Instance && A.EquipmentDefinition == B.EquipmentDefinition;
+			}
+
+			const SourceType& A = *reinterpret_cast<const SourceType*>(Args.Source0);
+			const SourceType& B = *reinterpret_cast<const SourceType*>(Args.Source1);
+			return A.Instance == B.Instance && A.EquipmentDefinition == B.EquipmentDefinition;
+		}
+
+		static bool Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args)
+		{
+			return true;
+		}
+
+		static void CollectNetReferences(FNetSerializationContext& Context, const FNetCollectReferencesArgs& Args)
+		{
+			const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			InventoryNetSerializers::CollectObjectReference(Context, Args, Source.Instance);
+			InventoryNetSerializers::CollectDefinitionClassReference(Context, Args, Source.EquipmentDefinition);
+		}
+
+	private:
+		class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+		{
+		public:
+			virtual ~FNetSerializerRegistryDelegates() override;
+
+		private:
+			virtual void OnPreFreezeNetSerializerRegistry() override;
+		};
+
+		static FEquipmentEntryNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+	};
+
+	UE_NET_IMPLEMENT_SERIALIZER(FEquipmentEntryNetSerializer);
+
+	const FEquipmentEntryNetSerializer::ConfigType FEquipmentEntryNetSerializer::DefaultConfig;
+
+	// Used by Iris for every property of this struct type, in place of the reflection of its members
+	static const FName PropertyNetSerializerRegistry_NAME_EquipmentEntry("EquipmentEntry");
+	UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_EquipmentEntry, FEquipmentEntryNetSerializer);
+
+	FEquipmentEntryNetSerializer::FNetSerializerRegistryDelegates FEquipmentEntryNetSerializer::NetSerializerRegistryDelegates;
+
+	FEquipmentEntryNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+	{
+		UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_EquipmentEntry);
+	}
+
+	void FEquipmentEntryNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+	{
+		UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_EquipmentEntry);
+	}
+}
+
+#endif
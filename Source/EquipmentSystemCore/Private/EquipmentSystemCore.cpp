@@ -1,9 +1,13 @@
 ﻿#include "EquipmentSystemCore.h"
 
+#include "Data/DefinitionNetIdTable.h"
+#include "Definitions/EquipmentDefinition.h"
+
 #define LOCTEXT_NAMESPACE "FEquipmentSystemCoreModule"
 
 void FEquipmentSystemCoreModule::StartupModule()
 {
+	FDefinitionNetIdTable::RegisterBaseClass(UEquipmentDefinition::StaticClass());
 }
 
 void FEquipmentSystemCoreModule::ShutdownModule()
@@ -7,6 +7,7 @@
 #include "Net/UnrealNetwork.h"
 
 #if UE_WITH_IRIS
+#include "Iris/ReplicationSystem/ReplicationFragmentUtil.h"
 #endif
 
 UEquipmentInstance::UEquipmentInstance(const FObjectInitializer& ObjectInitializer)
@@ -33,6 +34,14 @@ void UEquipmentInstance::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& O
 	DOREPLIFETIME(ThisClass, Components);
 }
 
+#if UE_WITH_IRIS
+void UEquipmentInstance::RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags)
+{
+	// Builds the replication state descriptors of the replicated properties, fast arrays included
+	UE::Net::FReplicationFragmentUtil::CreateAndRegisterFragmentsForObject(this, Context, RegistrationFlags);
+}
+#endif
+
 APawn* UEquipmentInstance::GetPawn() const
 {
 	return Cast<APawn>(GetOuter());
@@ -13,7 +13,8 @@ class UEquipmentDefinition;
  * UEquipmentCache
  *
  * A cache system for EquipmentDefinition to improve performance by reducing object creation.
- * This class manages a thread-safe cache of EquipmentDefinitions.
+ * This class manages a thread-safe cache of EquipmentDefinitions. Lookups only share a read lock, the write lock
+ * being taken to add missing definitions and to prune collected ones.
  */
 UCLASS()
 class EQUIPMENTSYSTEMCORE_API UEquipmentCache : public UObject
@@ -41,7 +42,7 @@ public:
 	 * @param Class The class of the EquipmentDefinition.
 	 * @return True if the cache contains a default object of the given class.
 	 */
-	bool IsCachedDefinition(const TSubclassOf<UEquipmentDefinition>& Class);
+	bool IsCachedDefinition(const TSubclassOf<UEquipmentDefinition>& Class) const;
 
 private:
 	/**
@@ -54,6 +55,6 @@ private:
 	UPROPERTY()
 	TMap<TSubclassOf<UEquipmentDefinition>, TWeakObjectPtr<UEquipmentDefinition>> CachedDefinitionMap;
 
-	/** Critical section to ensure thread-safe access to the cache */
-	FCriticalSection CacheLock;
+	/** Read/write lock to ensure thread-safe access to the cache */
+	mutable FRWLock CacheLock;
 };
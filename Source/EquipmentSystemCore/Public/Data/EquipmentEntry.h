@@ -10,6 +10,8 @@
 
 class UEquipmentDefinition;
 class UEquipmentInstance;
+namespace UE::Net { struct FEquipmentEntryNetSerializer; }
+
 /**
  * @class FEquipmentEntry
  *
@@ -23,6 +25,7 @@ struct EQUIPMENTSYSTEMCORE_API FEquipmentEntry : public FFastArraySerializerItem
 
 	friend class UEquipmentSystemComponent;
 	friend struct FEquipmentList;
+	friend struct UE::Net::FEquipmentEntryNetSerializer;
 
 	FEquipmentEntry()
 	{
@@ -40,6 +43,9 @@ struct EQUIPMENTSYSTEMCORE_API FEquipmentEntry : public FFastArraySerializerItem
 	FString GetDebugString() const;
 	// ~FFastArraySerializer
 
+	/** Serializes the instance and the definition of the entry, the definition as its compact net id. See UE::Net::FEquipmentEntryNetSerializer for Iris */
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
 protected:
 	UPROPERTY(SaveGame)
 	TObjectPtr<UEquipmentInstance> Instance = nullptr;
@@ -54,3 +60,12 @@ protected:
 	UPROPERTY(NotReplicated)
 	TWeakObjectPtr<UEquipmentInstance> LastInstance;
 };
+
+template <>
+struct TStructOpsTypeTraits<FEquipmentEntry> : TStructOpsTypeTraitsBase2<FEquipmentEntry>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
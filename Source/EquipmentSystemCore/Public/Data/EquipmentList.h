@@ -99,6 +99,9 @@ protected:
 	/** Get the ability system component of the owner. */
 	UAbilitySystemComponent* GetAbilitySystemComponent() const;
 
+	/** Flush the net dormancy of the owner actor, so that a change of the list reaches the clients. */
+	void WakeDormantOwner() const;
+
 	/** Array of equipment entries */
 	UPROPERTY()
 	TArray<FEquipmentEntry> Entries;
@@ -19,6 +19,7 @@ public class InventorySystemCore : ModuleRules
 		PrivateDependencyModuleNames.AddRange(
 			new[]
 			{
+				"AssetRegistry",
 				"CoreUObject",
 				"Engine",
 				"GameplayAbilities",
@@ -27,5 +28,8 @@ public class InventorySystemCore : ModuleRules
 				"SlateCore"
 			}
 		);
+
+		// Replication fragments of the containers and instances, see RegisterReplicationFragments
+		SetupIrisSupport(Target);
 	}
 }
\ No newline at end of file
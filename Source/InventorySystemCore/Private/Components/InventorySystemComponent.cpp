@@ -4,12 +4,22 @@
 
 #include "GameplayTagContainer.h"
 #include "Containers/InventoryContainer.h"
-#include "Data/InventoryCache.h"
 #include "Data/InventoryEntry.h"
 #include "Data/InventorySet.h"
-#include "Engine/ActorChannel.h"
+#include "Async/Async.h"
+#include "Data/InventorySnapshot.h"
+#include "Data/InventorySnapshotLoader.h"
+#include "Definitions/Fragments/ItemFragment_Storable.h"
+#include "Engine/World.h"
 #include "GameplayTags/InventoryGameplayTags.h"
 #include "Instances/ItemInstance.h"
+#include "Log/InventorySystemLog.h"
+#include "Net/Core/Misc/NetConditionGroupManager.h"
+#include "Settings/InventorySystemSettings.h"
+#include "Subsystems/ItemDefinitionRegistry.h"
+#include "Subsystems/ItemInstancePool.h"
+#include "Tasks/Task.h"
+#include "TimerManager.h"
 
 UInventorySystemComponent::UInventorySystemComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer.Get())
@@ -26,22 +36,6 @@ void UInventorySystemComponent::GetLifetimeReplicatedProps(TArray<FLifetimePrope
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 }
 
-bool UInventorySystemComponent::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
-{
-	bool bReplicated = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
-
-	for (const auto& [Tag, Container] : Containers)
-	{
-		if (IsValid(Container))
-		{
-			bReplicated |= Channel->ReplicateSubobject(Container, *Bunch, *RepFlags);
-			bReplicated |= Container->ReplicateSubobjects(Channel, Bunch, RepFlags);
-		}
-	}
-
-	return bReplicated;
-}
-
 void UInventorySystemComponent::ReadyForReplication()
 {
 	Super::ReadyForReplication();
@@ -53,14 +47,14 @@ void UInventorySystemComponent::ReadyForReplication()
 		{
 			if (IsValid(Container))
 			{
-				AddReplicatedSubObject(Container);
+				AddReplicatedInventorySubObject(Container, Container->GetReplicationRule());
 
 				FInventoryList& InventoryList = Container->GetInventoryList();
 				for (const FInventoryEntry& Entry : InventoryList.Entries)
 				{
 					if (UItemInstance* Instance = Entry.Instance; IsValid(Instance))
 					{
-						AddReplicatedSubObject(Instance);
+						AddReplicatedInventorySubObject(Instance, Container->GetReplicationRule());
 					}
 				}
 			}
@@ -72,9 +66,6 @@ void UInventorySystemComponent::InitializeComponent()
 {
 	Super::InitializeComponent();
 
-	// Cache initialization
-	Cache = NewObject<UInventoryCache>(this);
-
 	if (IsValid(DefaultContainerClass) && !Containers.Contains(DefaultContainerTag) && IsValidContainerTag(DefaultContainerTag))
 	{
 		UInventoryContainer* DefaultContainer = NewObject<UInventoryContainer>(this, DefaultContainerClass);
@@ -85,10 +76,25 @@ void UInventorySystemComponent::InitializeComponent()
 	{
 		DefaultInventorySet->GiveToInventorySystem(this);
 	}
+
+	// Idle storages skip the per tick replication checks, every inventory change flushes the dormancy
+	AActor* Owner = GetOwner();
+	if (bMakeOwnerDormant && Owner && Owner->HasAuthority() && Owner->NetDormancy == DORM_Awake)
+	{
+		Owner->SetNetDormancy(DORM_DormantAll);
+	}
 }
 
 void UInventorySystemComponent::UninitializeComponent()
 {
+	CancelSnapshotLoad();
+	FlushChangeNotifications();
+
+	if (const UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(PredictionTimerHandle);
+	}
+
 	Super::UninitializeComponent();
 }
 
@@ -97,15 +103,9 @@ FInventoryResult UInventorySystemComponent::TryAddItemDefinitionIn(const FGamepl
 	if (UInventoryContainer* Container = GetContainer(ContainerTag))
 	{
 		FInventoryResult Result = Container->TryAddItemDefinition(ItemDefinition, Count);
-		if (Result.Succeeded() && IsUsingRegisteredSubObjectList() && IsReadyForReplication())
+		if (Result.Succeeded())
 		{
-			for (UItemInstance* Instance : Result.Instances)
-			{
-				if (!IsReplicatedSubObjectRegistered(Instance))
-				{
-					AddReplicatedSubObject(Instance);
-				}
-			}
+			RegisterReplicatedInstances(Result);
 		}
 		return Result;
 	}
@@ -117,15 +117,9 @@ FInventoryResult UInventorySystemComponent::TryAddItemInstanceIn(const FGameplay
 	if (UInventoryContainer* Container = GetContainer(ContainerTag))
 	{
 		FInventoryResult Result = Container->TryAddItemInstance(ItemInstance, StackCount);
-		if (Result.Succeeded() && IsUsingRegisteredSubObjectList() && IsReadyForReplication())
+		if (Result.Succeeded())
 		{
-			for (UItemInstance* Instance : Result.Instances)
-			{
-				if (!IsReplicatedSubObjectRegistered(Instance))
-				{
-					AddReplicatedSubObject(Instance);
-				}
-			}
+			RegisterReplicatedInstances(Result);
 		}
 		return Result;
 	}
@@ -142,6 +136,53 @@ FInventoryResult UInventorySystemComponent::TryAddItemInstance(UItemInstance* It
 	return TryAddItemInstanceIn(DefaultContainerTag, ItemInstance, StackCount);
 }
 
+FInventoryBatchResult UInventorySystemComponent::TryAddItemDefinitions(const TArray<FInventoryAddRequest>& Requests)
+{
+	FInventoryBatchResult BatchResult;
+	BatchResult.Results.SetNum(Requests.Num());
+
+	// Requests grouped by target container, keeping their order
+	TMap<UInventoryContainer*, TArray<int32>, TInlineSetAllocator<4>> RequestsPerContainer;
+	for (int32 RequestIndex = 0; RequestIndex < Requests.Num(); ++RequestIndex)
+	{
+		const FGameplayTag& ContainerTag = Requests[RequestIndex].ContainerTag.IsValid() ? Requests[RequestIndex].ContainerTag : DefaultContainerTag;
+		if (UInventoryContainer* Container = GetContainer(ContainerTag))
+		{
+			RequestsPerContainer.FindOrAdd(Container).Add(RequestIndex);
+		}
+		else
+		{
+			BatchResult.Results[RequestIndex].FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_ContainerNotFound;
+		}
+	}
+
+	FInventoryChangeScope ChangeScope(this);
+
+	TArray<FInventoryAddRequest> ContainerRequests;
+	for (const auto& [Container, RequestIndices] : RequestsPerContainer)
+	{
+		ContainerRequests.Reset(RequestIndices.Num());
+		for (const int32 RequestIndex : RequestIndices)
+		{
+			ContainerRequests.Add(Requests[RequestIndex]);
+		}
+
+		FInventoryBatchResult ContainerResult = Container->TryAddItemDefinitions(ContainerRequests);
+		for (int32 Index = 0; Index < RequestIndices.Num(); ++Index)
+		{
+			BatchResult.Results[RequestIndices[Index]] = MoveTemp(ContainerResult.Results[Index]);
+		}
+	}
+
+	// Partially added requests still created instances to replicate
+	for (const FInventoryResult& Result : BatchResult.Results)
+	{
+		RegisterReplicatedInstances(Result);
+	}
+
+	return BatchResult;
+}
+
 bool UInventorySystemComponent::TryRemoveFromHandle(FInventoryEntryHandle Handle, FGameplayTag& OutFailureReason)
 {
 	if (!Handle.IsHandleValid() || !IsValid(Handle.Container))
@@ -151,13 +192,35 @@ bool UInventorySystemComponent::TryRemoveFromHandle(FInventoryEntryHandle Handle
 	}
 
 	const bool Succeed = Handle.Container->TryRemoveItem(Handle, OutFailureReason);
-	if (Succeed && IsUsingRegisteredSubObjectList() && IsReadyForReplication())
+	if (Succeed && Handle.ItemInstance && IsUsingRegisteredSubObjectList() && IsReadyForReplication())
 	{
-		RemoveReplicatedSubObject(Handle.ItemInstance);
+		RemoveReplicatedInventorySubObject(Handle.ItemInstance, Handle.Container->GetReplicationRule());
 	}
 	return Succeed;
 }
 
+bool UInventorySystemComponent::TryDestroyFromHandle(FInventoryEntryHandle Handle, FGameplayTag& OutFailureReason)
+{
+	if (!Handle.IsHandleValid() || !IsValid(Handle.Container))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
+		return false;
+	}
+
+	UItemInstance* Instance = Handle.ItemInstance;
+	if (!Handle.Container->TryRemoveItem(Handle, OutFailureReason))
+	{
+		return false;
+	}
+
+	// Commodity entries have no instance to destroy
+	if (Instance)
+	{
+		ReleaseItemInstance(Instance);
+	}
+	return true;
+}
+
 FInventoryResult UInventorySystemComponent::TryMoveByHandle(const FInventoryEntryHandle Handle, UInventoryContainer* TargetContainer)
 {
 	if (!Handle.IsHandleValid() || !IsValid(Handle.Container) || !IsValid(TargetContainer))
@@ -167,186 +230,1052 @@ FInventoryResult UInventorySystemComponent::TryMoveByHandle(const FInventoryEntr
 	return Handle.Container->TryMoveItemTo(Handle, TargetContainer);
 }
 
-void UInventorySystemComponent::Empty()
+FInventoryResult UInventorySystemComponent::TryTransferItems(const FInventoryEntryHandle Handle, UInventoryContainer* TargetContainer, const int32 Count)
 {
-	if (!IsUsingRegisteredSubObjectList())
+	FInventoryResult Result;
+
+	// Plan: everything is checked before the first modification, a refusal leaves both containers untouched
+	if (!GetOwner()->HasAuthority())
 	{
-		return;
+		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_NotAuthority;
+		return Result;
+	}
+	if (!CanModifyContent(Result.FailureReason))
+	{
+		return Result;
 	}
 
-	TArray<FInventoryEntryHandle> Handles;
-	for (const auto& Pair : Containers)
+	UInventoryContainer* SourceContainer = Handle.Container;
+	if (!Handle.IsHandleValid() || !IsValid(SourceContainer) || SourceContainer->IsHandleStale(Handle))
 	{
-		if (UInventoryContainer* Container = Pair.Value)
-		{
-			FInventoryList& InventoryList = Container->GetInventoryList();
-			for (const FInventoryEntry& Entry : InventoryList.Entries)
-			{
-				if (UItemInstance* Instance = Entry.Instance; IsValid(Instance))
-				{
-					RemoveReplicatedSubObject(Instance);
-				}
-			}
-			Container->GetInventoryList().Entries.Empty();
-		}
+		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
+		return Result;
+	}
+	if (SourceContainer->InventoryList.IsEntryLocked(Handle.EntryId))
+	{
+		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Locked;
+		return Result;
+	}
+	if (!IsValid(TargetContainer) || TargetContainer == SourceContainer || SourceContainer->OwnerComponent != this || TargetContainer->OwnerComponent != this)
+	{
+		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidContainer;
+		return Result;
 	}
-}
 
-FInventoryEntryHandle UInventorySystemComponent::FindHandleFromInstanceIn(const FGameplayTag& ContainerTag, UItemInstance* Instance) const
-{
-	for (const auto& Pair : Containers)
+	FInventoryList& SourceList = SourceContainer->InventoryList;
+	FInventoryList& TargetList = TargetContainer->InventoryList;
+	const int32 SourceIndex = SourceList.FindEntryIndex(Handle);
+	const FInventoryEntry& SourceEntry = SourceList.Entries[SourceIndex];
+	if (Count <= 0 || Count > SourceEntry.StackCount)
 	{
-		if (const UInventoryContainer* Container = Pair.Value)
-		{
-			FInventoryEntryHandle Handle = Container->FindHandle(Instance);
-			if (Handle.IsHandleValid())
-			{
-				return Handle;
-			}
-		}
+		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidCount;
+		return Result;
 	}
-	return FInventoryEntryHandle();
-}
 
-FInventoryEntryHandle UInventorySystemComponent::FindHandleFromInstance(UItemInstance* Instance) const
-{
-	return FindHandleFromInstanceIn(InventorySystemGameplayTags::TAG_Inventory_Container, Instance);
-}
+	const TSubclassOf<UItemDefinition> DefinitionClass = SourceEntry.GetDefinitionClass();
+	UItemInstance* SourceInstance = SourceEntry.Instance;
+	if (!TargetList.CanAddDefinition(DefinitionClass, Result.FailureReason) || !TargetList.CanAddCount(DefinitionClass, Result.FailureReason, Count))
+	{
+		return Result;
+	}
+	if (SourceInstance && !TargetContainer->ValidateStorage(SourceInstance, Result.FailureReason))
+	{
+		return Result;
+	}
 
-TArray<FInventoryEntryHandle> UInventorySystemComponent::GetAllStacks() const
-{
-	TArray<FInventoryEntryHandle> Handles;
-	for (const auto& Pair : Containers)
+	const UItemFragment_Storable* StorableFragment = GetCachedDefinition(DefinitionClass)->FindFragmentByClass<UItemFragment_Storable>();
+	const int32 MergedCount = FMath::Min(Count, TargetList.GetFreeStackRoom(DefinitionClass));
+	const int32 RemainingCount = Count - MergedCount;
+	const bool bWholeStack = Count == SourceEntry.StackCount;
+
+	// The instance of a whole stack keeps its state by moving as is, split items are stored in new stacks
+	const bool bMoveInstance = bWholeStack && SourceInstance && RemainingCount > 0;
+	const int32 MaxStackCount = StorableFragment->CanStack() ? StorableFragment->MaxStackCount : 1;
+	const int32 NewStacks = bMoveInstance ? 1 : FMath::DivideAndRoundUp(RemainingCount, MaxStackCount);
+	if (!TargetList.CanAddStacks(DefinitionClass, NewStacks, Result.FailureReason)
+		|| !TargetContainer->ValidateCapacity(DefinitionClass, Count, NewStacks, Result.FailureReason))
 	{
-		if (UInventoryContainer* Container = Pair.Value)
-		{
-			Handles.Append(Container->GetInventoryList().GetAllHandles());
-		}
+		return Result;
 	}
-	return Handles;
-}
 
-int32 UInventorySystemComponent::GetStackCountByDefinitionIn(const TSubclassOf<UItemDefinition> DefinitionClass, const FGameplayTag& ContainerTag) const
-{
-	int32 Count = 0;
-	if (const UInventoryContainer* Container = GetContainer(ContainerTag); IsValid(Container))
+	// Commit: the plan is complete, so the target inserts below cannot be refused. Both containers are modified in the
+	// same frame, so they replicate together, and are reported at once
+	FInventoryChangeScope ChangeScope(this);
+
+	if (bWholeStack)
 	{
-		Count += Container->GetStackCountByDefinition(DefinitionClass);
+		SourceList.Internal_OnEntryRemoved(SourceIndex, SourceEntry);
+		SourceList.Internal_RemoveEntryAt(SourceIndex);
+	}
+	else
+	{
+		SourceList.SetEntryStackCount(SourceIndex, SourceEntry.StackCount - Count);
 	}
-	return Count;
-}
 
-int32 UInventorySystemComponent::GetTotalCountByDefinitionIn(const TSubclassOf<UItemDefinition> DefinitionClass, const FGameplayTag& ContainerTag) const
-{
-	int32 Count = 0;
-	if (const UInventoryContainer* Container = GetContainer(ContainerTag); IsValid(Container))
+	const int32 UnmergedCount = TargetList.TopUpStacks(DefinitionClass, MergedCount, Result);
+	ensureMsgf(UnmergedCount == 0, TEXT("Transfer of %s merged less items than planned."), *GetNameSafe(DefinitionClass));
+
+	if (bMoveInstance)
 	{
-		Count += Container->GetTotalCountByDefinition(DefinitionClass);
+		TargetList.InsertInstance(SourceInstance, RemainingCount);
+		Result.Instances.Add(SourceInstance);
+	}
+	else if (RemainingCount > 0)
+	{
+		TargetList.CreateStacks(DefinitionClass, RemainingCount, Result);
 	}
-	return Count;
-}
 
-int32 UInventorySystemComponent::GetStackCountByDefinition(const TSubclassOf<UItemDefinition> DefinitionClass) const
-{
-	int32 Count = 0;
-	for (const auto& Pair : Containers)
+	// The instance of a whole stack entirely merged into the target stacks is no longer stored
+	if (bWholeStack && SourceInstance && !bMoveInstance)
 	{
-		Count += GetStackCountByDefinitionIn(DefinitionClass, Pair.Key);
+		ReleaseItemInstance(SourceInstance);
 	}
-	return Count;
+
+	RegisterReplicatedInstances(Result);
+	return Result;
 }
 
-int32 UInventorySystemComponent::GetTotalCountByDefinition(const TSubclassOf<UItemDefinition> DefinitionClass) const
+bool UInventorySystemComponent::TryConsumeFromHandle(const FInventoryEntryHandle Handle, const int32 Count, FGameplayTag& OutFailureReason)
 {
-	int32 Count = 0;
-	for (const auto& Pair : Containers)
+	if (!GetOwner()->HasAuthority())
 	{
-		Count += GetTotalCountByDefinitionIn(DefinitionClass, Pair.Key);
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_NotAuthority;
+		return false;
 	}
-	return Count;
+	if (!CanModifyContent(OutFailureReason))
+	{
+		return false;
+	}
+
+	UInventoryContainer* Container = Handle.Container;
+	if (!Handle.IsHandleValid() || !IsValid(Container) || Container->OwnerComponent != this || Container->IsHandleStale(Handle))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
+		return false;
+	}
+
+	FInventoryList& List = Container->InventoryList;
+	if (List.IsEntryLocked(Handle.EntryId))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Locked;
+		return false;
+	}
+
+	const int32 Index = List.FindEntryIndex(Handle);
+	const int32 StackCount = List.Entries[Index].StackCount;
+	if (Count <= 0 || Count > StackCount)
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidCount;
+		return false;
+	}
+
+	if (Count == StackCount)
+	{
+		return TryDestroyFromHandle(List.MakeHandle(Index), OutFailureReason);
+	}
+	List.SetEntryStackCount(Index, StackCount - Count);
+	return true;
 }
 
-bool UInventorySystemComponent::RegisterContainer(const FGameplayTag& Tag, UInventoryContainer* Container)
+bool UInventorySystemComponent::PredictConsumeItems(const FInventoryEntryHandle Handle, const int32 Count, int32& OutPredictionKey, FGameplayTag& OutFailureReason)
 {
-	if (!IsValid(Container) || !Tag.IsValid() || !IsValidContainerTag(Tag))
+	OutPredictionKey = 0;
+	if (GetOwner()->HasAuthority())
 	{
-		return false;
+		return TryConsumeFromHandle(Handle, Count, OutFailureReason);
 	}
-	Container->SetOwnerComponent(this);
 
-	Containers.Add(Tag, Container);
-	if (IsUsingRegisteredSubObjectList() && IsReadyForReplication())
+	UInventoryContainer* Container = Handle.Container;
+	if (!Handle.IsHandleValid() || !IsValid(Container) || Container->OwnerComponent != this || Container->IsHandleStale(Handle))
 	{
-		if (!IsReplicatedSubObjectRegistered(Container))
-		{
-			AddReplicatedSubObject(Container);
-		}
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
+		return false;
 	}
+	if (Count <= 0 || Count > GetPredictedStackCount(Handle))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidCount;
+		return false;
+	}
+
+	FInventoryPredictedChange Change;
+	Change.Operation = EInventoryPredictedOperation::Consume;
+	Change.Container = Container;
+	Change.DefinitionClass = Handle.DefinitionClass;
+	Change.EntryId = Handle.EntryId;
+	Change.Generation = Handle.Generation;
+	Change.Count = Count;
+	OutPredictionKey = RecordPrediction(MoveTemp(Change));
+
+	ServerConsumeItems(OutPredictionKey, Handle, Count);
 	return true;
 }
 
-bool UInventorySystemComponent::UnregisterContainer(const FGameplayTag& Tag)
+bool UInventorySystemComponent::PredictTransferItems(const FInventoryEntryHandle Handle, UInventoryContainer* TargetContainer, const int32 Count, int32& OutPredictionKey, FGameplayTag& OutFailureReason)
 {
-	if (!Tag.IsValid() || !Containers.Contains(Tag))
+	OutPredictionKey = 0;
+	if (GetOwner()->HasAuthority())
+	{
+		const FInventoryResult Result = TryTransferItems(Handle, TargetContainer, Count);
+		OutFailureReason = Result.FailureReason;
+		return Result.Succeeded();
+	}
+
+	UInventoryContainer* SourceContainer = Handle.Container;
+	if (!Handle.IsHandleValid() || !IsValid(SourceContainer) || SourceContainer->OwnerComponent != this || SourceContainer->IsHandleStale(Handle))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
+		return false;
+	}
+	if (!IsValid(TargetContainer) || TargetContainer == SourceContainer || TargetContainer->OwnerComponent != this)
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidContainer;
+		return false;
+	}
+	if (Count <= 0 || Count > GetPredictedStackCount(Handle))
 	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidCount;
 		return false;
 	}
 
-	if (IsUsingRegisteredSubObjectList() && IsReadyForReplication())
+	// Only the checks the replicated state can answer, the server has the final word
+	FInventoryList& TargetList = TargetContainer->InventoryList;
+	if (!TargetList.CanAddDefinition(Handle.DefinitionClass, OutFailureReason) || !TargetList.CanAddCount(Handle.DefinitionClass, OutFailureReason, Count))
 	{
-		if (UInventoryContainer* Container = Containers.FindRef(Tag))
-		{
-			RemoveReplicatedSubObject(Container);
-		}
+		return false;
 	}
-	Containers.Remove(Tag);
+
+	FInventoryPredictedChange Change;
+	Change.Operation = EInventoryPredictedOperation::Move;
+	Change.Container = SourceContainer;
+	Change.TargetContainer = TargetContainer;
+	Change.DefinitionClass = Handle.DefinitionClass;
+	Change.EntryId = Handle.EntryId;
+	Change.Generation = Handle.Generation;
+	Change.Count = Count;
+	OutPredictionKey = RecordPrediction(MoveTemp(Change));
+
+	ServerTransferItems(OutPredictionKey, Handle, TargetContainer, Count);
 	return true;
 }
 
-UInventoryContainer* UInventorySystemComponent::GetContainer(const FGameplayTag& ContainerTag) const
+void UInventorySystemComponent::AcknowledgePrediction(const int32 PredictionKey, const bool bAccepted)
 {
-	if (const TObjectPtr<UInventoryContainer>* Container = Containers.Find(ContainerTag))
+	if (PredictionKey > 0 && GetOwner()->HasAuthority())
 	{
-		return *Container;
+		ClientAcknowledgePrediction(PredictionKey, bAccepted);
 	}
-	return nullptr;
 }
 
-TMap<FGameplayTag, UInventoryContainer*> UInventorySystemComponent::GetAllContainers() const
+int32 UInventorySystemComponent::GetPredictedTotalCountByDefinitionIn(const TSubclassOf<UItemDefinition> DefinitionClass, const FGameplayTag& ContainerTag) const
 {
-	TMap<FGameplayTag, UInventoryContainer*> Out;
-	for (const auto& Pair : Containers)
+	const UInventoryContainer* Container = GetContainer(ContainerTag);
+	if (!IsValid(Container))
 	{
-		Out.Add(Pair.Key, Pair.Value);
+		return 0;
 	}
-	return Out;
+	return FMath::Max(0, Container->GetTotalCountByDefinition(DefinitionClass) + PredictionOverlay.GetCountDelta(Container, DefinitionClass));
 }
 
+int32 UInventorySystemComponent::GetPredictedStackCount(const FInventoryEntryHandle& Handle) const
+{
+	const UInventoryContainer* Container = Handle.Container;
+	if (!Handle.IsHandleValid() || !IsValid(Container) || Container->IsHandleStale(Handle))
+	{
+		return 0;
+	}
+
+	const FInventoryList& List = Container->InventoryList;
+	const int32 StackCount = List.Entries[List.FindEntryIndex(Handle)].StackCount;
+	return FMath::Max(0, StackCount + PredictionOverlay.GetEntryDelta(Container, Handle.EntryId, Handle.Generation));
+}
 
-UItemDefinition* UInventorySystemComponent::GetCachedDefinition(const TSubclassOf<UItemDefinition>& Class) const
+void UInventorySystemComponent::Empty()
 {
-	if (IsValid(Cache))
+	// The load would refill the inventory, unless it is the one emptying it
+	if (!bRestoringSnapshot)
 	{
-		return Cache->GetCachedDefinition(Class);
+		CancelSnapshotLoad();
 	}
-	if (IsValid(Class))
+
+	if (!IsUsingRegisteredSubObjectList())
 	{
-		return NewObject<UItemDefinition>(GetOuter(), Class);
+		return;
+	}
+
+	// Clients only learn about the destroyed instances once the component replicates
+	const bool bReadyForReplication = IsReadyForReplication();
+	TArray<UItemInstance*> ReleasedInstances;
+	for (const auto& Pair : Containers)
+	{
+		if (UInventoryContainer* Container = Pair.Value)
+		{
+			FInventoryList& InventoryList = Container->GetInventoryList();
+			RecordJournal([Container](FInventoryJournal& InJournal) { InJournal.RecordCleared(*Container); });
+			for (const FInventoryEntry& Entry : InventoryList.Entries)
+			{
+				if (UItemInstance* Instance = Entry.Instance; IsValid(Instance))
+				{
+					if (bReadyForReplication)
+					{
+						DestroyReplicatedSubObjectOnRemotePeers(Instance);
+					}
+					ReleasedInstances.Add(Instance);
+				}
+			}
+			InventoryList.Empty();
+		}
+	}
+
+	for (UItemInstance* Instance : ReleasedInstances)
+	{
+		UItemInstancePool::ReleaseInstance(Instance);
 	}
-	return nullptr;
 }
 
-bool UInventorySystemComponent::IsValidContainerTag(const FGameplayTag& Tag)
+void UInventorySystemComponent::SaveSnapshot(TArray<uint8>& OutData)
 {
-	return Tag.MatchesTag(InventorySystemGameplayTags::TAG_Inventory_Container);
+	OutData.Reset();
+	FInventorySnapshot::Write(*this, OutData);
 }
 
-void UInventorySystemComponent::PostInventoryEntryAdded(const FInventoryChangeData& Data)
+bool UInventorySystemComponent::LoadSnapshot(const TArray<uint8>& Data)
 {
-	OnInventoryEntryAdded.Broadcast(Data);
+	CancelSnapshotLoad();
+	FInventorySnapshot Snapshot;
+	return Snapshot.Decode(MakeMemoryView(Data)) && ApplySnapshot(Snapshot);
 }
 
-void UInventorySystemComponent::PostInventoryEntryRemoved(const FInventoryChangeData& Data)
+void UInventorySystemComponent::SetJournalChanges(const bool bEnable)
+{
+	bJournalChanges = bEnable;
+	Journal.Reset();
+	PendingCheckpoints.Reset();
+}
+
+void UInventorySystemComponent::SaveCheckpoint(TArray<uint8>& OutSnapshot)
+{
+	SaveSnapshot(OutSnapshot);
+	Journal.Reset();
+	PendingCheckpoints.Reset();
+	bJournalRequiresCheckpoint = false;
+}
+
+bool UInventorySystemComponent::LoadSnapshotWithJournal(const TArray<uint8>& Snapshot, const TArray<uint8>& JournalData)
+{
+	CancelSnapshotLoad();
+
+	// The added entries of the journal point into its data, kept alive until applied
+	FInventorySnapshot Checkpoint;
+	return Checkpoint.Decode(MakeMemoryView(Snapshot)) && FInventoryJournal::Fold(Checkpoint, MakeMemoryView(JournalData)) && ApplySnapshot(Checkpoint);
+}
+
+void UInventorySystemComponent::SaveSnapshotAsync(const bool bCheckpoint, FOnInventorySnapshotSaved OnSaved)
+{
+	// Instances are only read on the game thread, the capture being plain data written by a worker task
+	TSharedPtr<FInventorySnapshot> Snapshot = MakeShared<FInventorySnapshot>();
+	Snapshot->Capture(*this);
+
+	// The journal only restarts once the snapshot is persisted, the changes made meanwhile being journaled twice
+	int32 Serial = INDEX_NONE;
+	if (bCheckpoint)
+	{
+		Serial = ++LastCheckpointSerial;
+		PendingCheckpoints.AddDefaulted_GetRef().Serial = Serial;
+	}
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis = TWeakObjectPtr<UInventorySystemComponent>(this), Serial, Snapshot = MoveTemp(Snapshot), OnSaved = MoveTemp(OnSaved)]() mutable
+	{
+		TArray<uint8> Data;
+		Snapshot->Encode(Data);
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Serial, Data = MoveTemp(Data), OnSaved = MoveTemp(OnSaved)]
+		{
+			const bool bSaved = OnSaved.IsBound() && OnSaved.Execute(Data);
+			if (UInventorySystemComponent* This = WeakThis.Get(); This && Serial != INDEX_NONE)
+			{
+				This->CompleteCheckpoint(Serial, bSaved);
+			}
+		});
+	});
+}
+
+void UInventorySystemComponent::LoadSnapshotAsync(const TArray<uint8>& Data, FOnInventorySnapshotLoaded OnLoaded)
+{
+	CancelSnapshotLoad();
+	if (!GetOwner()->HasAuthority())
+	{
+		OnLoaded.ExecuteIfBound(false);
+		return;
+	}
+
+	TArray<uint8> OwnedData(Data);
+	SnapshotLoader = MakeShared<FInventorySnapshotLoader>(*this, MoveTemp(OwnedData), SnapshotLoadBudget / 1000.0);
+	SnapshotLoader->Start(FInventorySnapshotLoader::FOnCompleted::CreateWeakLambda(this, [this, OnLoaded](const bool bSuccess)
+	{
+		SnapshotLoader.Reset();
+		OnLoaded.ExecuteIfBound(bSuccess);
+	}));
+}
+
+bool UInventorySystemComponent::IsLoadingSnapshot() const
+{
+	return SnapshotLoader.IsValid() && SnapshotLoader->IsRunning();
+}
+
+bool UInventorySystemComponent::CanModifyContent(FGameplayTag& OutFailureReason) const
+{
+	if (IsLoadingSnapshot() && !bRestoringSnapshot)
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Loading;
+		return false;
+	}
+	return true;
+}
+
+void UInventorySystemComponent::CancelSnapshotLoad()
+{
+	if (TSharedPtr<FInventorySnapshotLoader> Loader = MoveTemp(SnapshotLoader))
+	{
+		Loader->Cancel();
+	}
+}
+
+void UInventorySystemComponent::NotifyInstanceStateChanged(UItemInstance* Instance)
+{
+	// Instances being initialized, e.g. by a snapshot load, are not stored yet
+	const TObjectPtr<UInventoryContainer>* Container = InstanceContainers.Find(Instance);
+	if (!Container || !IsValid(*Container) || !ShouldJournalChanges())
+	{
+		return;
+	}
+
+	const FInventoryEntryHandle Handle = (*Container)->FindHandle(Instance);
+	if (Handle.IsHandleValid())
+	{
+		RecordJournal([&Handle](FInventoryJournal& InJournal) { InJournal.RecordEntryState(Handle); });
+	}
+}
+
+FInventoryEntryHandle UInventorySystemComponent::FindHandleFromInstanceIn(const FGameplayTag& ContainerTag, UItemInstance* Instance) const
+{
+	if (const TObjectPtr<UInventoryContainer>* Container = InstanceContainers.Find(Instance))
+	{
+		// Parent tags are accepted to search in a family of containers
+		if (IsValid(*Container) && (*Container)->GetContainerTag().MatchesTag(ContainerTag))
+		{
+			return (*Container)->FindHandle(Instance);
+		}
+	}
+	return FInventoryEntryHandle();
+}
+
+FInventoryEntryHandle UInventorySystemComponent::FindHandleFromInstance(UItemInstance* Instance) const
+{
+	return FindHandleFromInstanceIn(InventorySystemGameplayTags::TAG_Inventory_Container, Instance);
+}
+
+TArray<FInventoryEntryHandle> UInventorySystemComponent::GetAllStacks() const
+{
+	TArray<FInventoryEntryHandle> Handles;
+	for (const auto& Pair : Containers)
+	{
+		if (UInventoryContainer* Container = Pair.Value)
+		{
+			Handles.Append(Container->GetInventoryList().GetAllHandles());
+		}
+	}
+	return Handles;
+}
+
+int32 UInventorySystemComponent::GetStackCountByDefinitionIn(const TSubclassOf<UItemDefinition> DefinitionClass, const FGameplayTag& ContainerTag) const
+{
+	int32 Count = 0;
+	if (const UInventoryContainer* Container = GetContainer(ContainerTag); IsValid(Container))
+	{
+		Count += Container->GetStackCountByDefinition(DefinitionClass);
+	}
+	return Count;
+}
+
+int32 UInventorySystemComponent::GetTotalCountByDefinitionIn(const TSubclassOf<UItemDefinition> DefinitionClass, const FGameplayTag& ContainerTag) const
+{
+	int32 Count = 0;
+	if (const UInventoryContainer* Container = GetContainer(ContainerTag); IsValid(Container))
+	{
+		Count += Container->GetTotalCountByDefinition(DefinitionClass);
+	}
+	return Count;
+}
+
+int32 UInventorySystemComponent::GetStackCountByDefinition(const TSubclassOf<UItemDefinition> DefinitionClass) const
+{
+	int32 Count = 0;
+	for (const auto& Pair : Containers)
+	{
+		Count += GetStackCountByDefinitionIn(DefinitionClass, Pair.Key);
+	}
+	return Count;
+}
+
+int32 UInventorySystemComponent::GetTotalCountByDefinition(const TSubclassOf<UItemDefinition> DefinitionClass) const
+{
+	int32 Count = 0;
+	for (const auto& Pair : Containers)
+	{
+		Count += GetTotalCountByDefinitionIn(DefinitionClass, Pair.Key);
+	}
+	return Count;
+}
+
+bool UInventorySystemComponent::RegisterContainer(const FGameplayTag& Tag, UInventoryContainer* Container)
+{
+	if (!IsValid(Container) || !Tag.IsValid() || !IsValidContainerTag(Tag))
+	{
+		return false;
+	}
+	Container->SetOwnerComponent(this);
+	Container->ContainerTag = Tag;
+	Container->ReplicationRule = GetContainerReplicationRule(Tag);
+
+	Containers.Add(Tag, Container);
+
+	// Containers may be registered already filled
+	for (const FInventoryEntry& Entry : Container->GetInventoryList().Entries)
+	{
+		RegisterInstanceContainer(Entry.Instance, Container);
+	}
+	if (IsUsingRegisteredSubObjectList() && IsReadyForReplication())
+	{
+		if (!IsReplicatedSubObjectRegistered(Container))
+		{
+			AddReplicatedInventorySubObject(Container, Container->GetReplicationRule());
+		}
+	}
+	return true;
+}
+
+bool UInventorySystemComponent::UnregisterContainer(const FGameplayTag& Tag)
+{
+	if (!Tag.IsValid() || !Containers.Contains(Tag))
+	{
+		return false;
+	}
+
+	if (UInventoryContainer* Container = Containers.FindRef(Tag))
+	{
+		const bool bReplicatesSubObjects = IsUsingRegisteredSubObjectList() && IsReadyForReplication();
+		for (const FInventoryEntry& Entry : Container->GetInventoryList().Entries)
+		{
+			UnregisterInstanceContainer(Entry.Instance, Container);
+
+			if (bReplicatesSubObjects && IsValid(Entry.Instance))
+			{
+				RemoveReplicatedInventorySubObject(Entry.Instance, Container->GetReplicationRule());
+			}
+		}
+
+		if (bReplicatesSubObjects)
+		{
+			RemoveReplicatedInventorySubObject(Container, Container->GetReplicationRule());
+		}
+	}
+	Containers.Remove(Tag);
+	return true;
+}
+
+UInventoryContainer* UInventorySystemComponent::GetContainer(const FGameplayTag& ContainerTag) const
+{
+	if (const TObjectPtr<UInventoryContainer>* Container = Containers.Find(ContainerTag))
+	{
+		return *Container;
+	}
+	return nullptr;
+}
+
+TMap<FGameplayTag, UInventoryContainer*> UInventorySystemComponent::GetAllContainers() const
+{
+	TMap<FGameplayTag, UInventoryContainer*> Out;
+	for (const auto& Pair : Containers)
+	{
+		Out.Add(Pair.Key, Pair.Value);
+	}
+	return Out;
+}
+
+
+FInventoryReplicationRule UInventorySystemComponent::GetContainerReplicationRule(const FGameplayTag& ContainerTag) const
+{
+	if (const FInventoryReplicationRule* Rule = FInventoryReplicationRule::FindRule(ContainerReplicationRules, ContainerTag))
+	{
+		return *Rule;
+	}
+	if (const FInventoryReplicationRule* Rule = FInventoryReplicationRule::FindRule(GetDefault<UInventorySystemSettings>()->ContainerReplicationRules, ContainerTag))
+	{
+		return *Rule;
+	}
+	return FInventoryReplicationRule();
+}
+
+UItemDefinition* UInventorySystemComponent::GetCachedDefinition(const TSubclassOf<UItemDefinition>& Class) const
+{
+	return UItemDefinitionRegistry::ResolveDefinition(Class);
+}
+
+bool UInventorySystemComponent::IsValidContainerTag(const FGameplayTag& Tag)
+{
+	return Tag.MatchesTag(InventorySystemGameplayTags::TAG_Inventory_Container);
+}
+
+void UInventorySystemComponent::RegisterInstanceContainer(UItemInstance* Instance, UInventoryContainer* Container)
+{
+	if (!IsValid(Instance) || !IsValid(Container))
+	{
+		return;
+	}
+
+	const TObjectPtr<UInventoryContainer> PreviousContainer = InstanceContainers.FindRef(Instance);
+	InstanceContainers.Add(Instance, Container);
+
+	// An instance moved to a container replicated to other connections follows the condition of its new container
+	if (IsValid(PreviousContainer) && !(PreviousContainer->GetReplicationRule() == Container->GetReplicationRule()) && GetOwnerRole() == ROLE_Authority
+		&& IsUsingRegisteredSubObjectList() && IsReadyForReplication() && IsReplicatedSubObjectRegistered(Instance))
+	{
+		RemoveReplicatedInventorySubObject(Instance, PreviousContainer->GetReplicationRule());
+		AddReplicatedInventorySubObject(Instance, Container->GetReplicationRule());
+	}
+}
+
+void UInventorySystemComponent::UnregisterInstanceContainer(UItemInstance* Instance, const UInventoryContainer* Container)
+{
+	// Only forget the instance if it has not been moved to another container meanwhile
+	if (const TObjectPtr<UInventoryContainer>* Found = InstanceContainers.Find(Instance); Found && *Found == Container)
+	{
+		InstanceContainers.Remove(Instance);
+	}
+}
+
+void UInventorySystemComponent::RegisterReplicatedInstances(const FInventoryResult& Result)
+{
+	if (!IsUsingRegisteredSubObjectList() || !IsReadyForReplication())
+	{
+		return;
+	}
+
+	for (UItemInstance* Instance : Result.Instances)
+	{
+		if (!IsReplicatedSubObjectRegistered(Instance))
+		{
+			const UInventoryContainer* Container = InstanceContainers.FindRef(Instance);
+			AddReplicatedInventorySubObject(Instance, IsValid(Container) ? Container->GetReplicationRule() : FInventoryReplicationRule());
+		}
+	}
+}
+
+void UInventorySystemComponent::WakeDormantOwner() const
+{
+	AActor* Owner = GetOwner();
+	if (Owner && Owner->NetDormancy > DORM_Awake && Owner->HasAuthority())
+	{
+		Owner->FlushNetDormancy();
+	}
+}
+
+void UInventorySystemComponent::AddReplicatedInventorySubObject(UObject* SubObject, const FInventoryReplicationRule& Rule)
+{
+	WakeDormantOwner();
+	AddReplicatedSubObject(SubObject, Rule.Condition);
+	if (Rule.Condition == COND_NetGroup && !Rule.NetGroup.IsNone())
+	{
+		UE::Net::FNetConditionGroupManager::RegisterSubObjectInGroup(SubObject, Rule.NetGroup);
+	}
+}
+
+void UInventorySystemComponent::RemoveReplicatedInventorySubObject(UObject* SubObject, const FInventoryReplicationRule& Rule)
+{
+	WakeDormantOwner();
+	RemoveReplicatedSubObject(SubObject);
+	if (Rule.Condition == COND_NetGroup && !Rule.NetGroup.IsNone())
+	{
+		UE::Net::FNetConditionGroupManager::UnregisterSubObjectFromGroup(SubObject, Rule.NetGroup);
+	}
+}
+
+bool UInventorySystemComponent::ServerConsumeItems_Validate(const int32 PredictionKey, const FInventoryEntryHandle Handle, const int32 Count)
+{
+	// PredictConsumeItems never sends these, the client is not running the game code
+	return PredictionKey > 0 && Count > 0;
+}
+
+void UInventorySystemComponent::ServerConsumeItems_Implementation(const int32 PredictionKey, const FInventoryEntryHandle Handle, const int32 Count)
+{
+	if (!ConsumeServerPredictionKey(PredictionKey))
+	{
+		return;
+	}
+
+	// The handle comes from the client, TryConsumeFromHandle refuses the containers of other components
+	FGameplayTag FailureReason;
+	AcknowledgePrediction(PredictionKey, TryConsumeFromHandle(Handle, Count, FailureReason));
+}
+
+bool UInventorySystemComponent::ServerTransferItems_Validate(const int32 PredictionKey, const FInventoryEntryHandle Handle, UInventoryContainer* TargetContainer, const int32 Count)
+{
+	return PredictionKey > 0 && Count > 0;
+}
+
+void UInventorySystemComponent::ServerTransferItems_Implementation(const int32 PredictionKey, const FInventoryEntryHandle Handle, UInventoryContainer* TargetContainer, const int32 Count)
+{
+	if (!ConsumeServerPredictionKey(PredictionKey))
+	{
+		return;
+	}
+
+	// Both containers come from the client, TryTransferItems refuses the containers of other components
+	AcknowledgePrediction(PredictionKey, TryTransferItems(Handle, TargetContainer, Count).Succeeded());
+}
+
+bool UInventorySystemComponent::ConsumeServerPredictionKey(const int32 PredictionKey)
+{
+	if (PredictionKey <= LastServerPredictionKey)
+	{
+		UE_LOG(LogInventorySystem, Warning, TEXT("%s ignored prediction %d, already answered."), *GetNameSafe(this), PredictionKey);
+		return false;
+	}
+	LastServerPredictionKey = PredictionKey;
+	return true;
+}
+
+void UInventorySystemComponent::ClientAcknowledgePrediction_Implementation(const int32 PredictionKey, const bool bAccepted)
+{
+	FInventoryPredictedChange Change;
+	if (PredictionOverlay.Acknowledge(PredictionKey, bAccepted, Change))
+	{
+		OnInventoryPredictionChanged.Broadcast(Change, bAccepted ? EInventoryPredictionState::Confirmed : EInventoryPredictionState::RolledBack);
+		SchedulePredictionExpiration();
+	}
+}
+
+int32 UInventorySystemComponent::RecordPrediction(FInventoryPredictedChange Change)
+{
+	const UWorld* World = GetWorld();
+	Change.ExpirationTime = (World ? World->GetTimeSeconds() : 0.0) + PredictionTimeout;
+
+	const FInventoryPredictedChange& Recorded = PredictionOverlay.AddPrediction(MoveTemp(Change));
+	const int32 PredictionKey = Recorded.PredictionKey;
+	OnInventoryPredictionChanged.Broadcast(Recorded, EInventoryPredictionState::Predicted);
+
+	SchedulePredictionExpiration();
+	return PredictionKey;
+}
+
+void UInventorySystemComponent::ReconcilePredictions(const UInventoryContainer* Container)
+{
+	if (PredictionOverlay.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<FInventoryPredictedChange> Ended;
+	PredictionOverlay.Reconcile(Container, Ended);
+	for (const FInventoryPredictedChange& Change : Ended)
+	{
+		OnInventoryPredictionChanged.Broadcast(Change, EInventoryPredictionState::Confirmed);
+	}
+	if (Ended.Num() > 0)
+	{
+		SchedulePredictionExpiration();
+	}
+}
+
+void UInventorySystemComponent::ExpirePredictions()
+{
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	TArray<FInventoryPredictedChange> Expired;
+	PredictionOverlay.Expire(World->GetTimeSeconds(), Expired);
+	for (const FInventoryPredictedChange& Change : Expired)
+	{
+		// The server applied accepted changes, their replicated state only came late or was merged with other changes
+		if (Change.bAccepted)
+		{
+			OnInventoryPredictionChanged.Broadcast(Change, EInventoryPredictionState::Confirmed);
+			continue;
+		}
+
+		UE_LOG(LogInventorySystem, Warning, TEXT("Prediction %d of %s was not answered by the server in time and is rolled back."), Change.PredictionKey, *GetNameSafe(this));
+		OnInventoryPredictionChanged.Broadcast(Change, EInventoryPredictionState::RolledBack);
+	}
+	SchedulePredictionExpiration();
+}
+
+void UInventorySystemComponent::SchedulePredictionExpiration()
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	FTimerManager& TimerManager = World->GetTimerManager();
+	TimerManager.ClearTimer(PredictionTimerHandle);
+	if (!PredictionOverlay.IsEmpty())
+	{
+		const float Delay = FMath::Max(UE_KINDA_SMALL_NUMBER, static_cast<float>(PredictionOverlay.GetNextExpirationTime() - World->GetTimeSeconds()));
+		TimerManager.SetTimer(PredictionTimerHandle, this, &ThisClass::ExpirePredictions, Delay, false);
+	}
+}
+
+bool UInventorySystemComponent::ApplySnapshot(const FInventorySnapshot& Snapshot)
+{
+	// Reported once the restore has ended, so that the changes made by the listeners are journaled
+	FInventoryChangeScope ChangeScope(this);
+
+	bool bApplied;
+	{
+		TGuardValue<bool> RestoreGuard(bRestoringSnapshot, true);
+		bJournalRequiresCheckpoint = false;
+		bApplied = Snapshot.Apply(*this);
+	}
+
+	// Entries are back in their saved slots, the journal restarts from the loaded state
+	if (bApplied)
+	{
+		Journal.Reset();
+		PendingCheckpoints.Reset();
+	}
+	return bApplied;
+}
+
+void UInventorySystemComponent::BeginSnapshotRestore()
+{
+	{
+		// Reported once the guard has ended, the listeners being refused changes until the end of the load
+		FInventoryChangeScope ChangeScope(this);
+		TGuardValue<bool> RestoreGuard(bRestoringSnapshot, true);
+		Empty();
+	}
+
+	// Entries are restored in their saved slots, the journal restarts from the loaded state
+	Journal.Reset();
+	PendingCheckpoints.Reset();
+	bJournalRequiresCheckpoint = false;
+}
+
+void UInventorySystemComponent::EndSnapshotRestore(const bool bCompleted)
+{
+	// The journal cannot be folded into a snapshot which was only partly restored
+	if (!bCompleted)
+	{
+		bJournalRequiresCheckpoint = true;
+	}
+}
+
+bool UInventorySystemComponent::ShouldJournalChanges() const
+{
+	return bJournalChanges && !bRestoringSnapshot && (!bJournalRequiresCheckpoint || !PendingCheckpoints.IsEmpty()) && GetOwner()->HasAuthority();
+}
+
+void UInventorySystemComponent::RecordJournal(const TFunctionRef<void(FInventoryJournal&)> Record)
+{
+	if (!ShouldJournalChanges())
+	{
+		return;
+	}
+
+	if (!bJournalRequiresCheckpoint)
+	{
+		Record(Journal);
+	}
+	for (FPendingCheckpoint& Pending : PendingCheckpoints)
+	{
+		Record(Pending.Journal);
+	}
+}
+
+void UInventorySystemComponent::CompleteCheckpoint(const int32 Serial, const bool bSaved)
+{
+	// Dropped if the journal restarted meanwhile, e.g. by a load
+	const int32 Index = PendingCheckpoints.IndexOfByPredicate([Serial](const FPendingCheckpoint& Pending) { return Pending.Serial == Serial; });
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (!bSaved)
+	{
+		PendingCheckpoints.RemoveAt(Index);
+		return;
+	}
+
+	// Older checkpoints are superseded by this one
+	Journal = MoveTemp(PendingCheckpoints[Index].Journal);
+	bJournalRequiresCheckpoint = false;
+	PendingCheckpoints.RemoveAt(0, Index + 1);
+}
+
+void UInventorySystemComponent::ReleaseItemInstance(UItemInstance* Instance)
+{
+	// Clients must destroy their copy before the instance can replicate again under another owner
+	if (IsUsingRegisteredSubObjectList() && IsReadyForReplication())
+	{
+		DestroyReplicatedSubObjectOnRemotePeers(Instance);
+	}
+	UItemInstancePool::ReleaseInstance(Instance);
+}
+
+void UInventorySystemComponent::DispatchInventoryChange(const FInventoryChangeData& Data)
+{
+	// Journaled as it happens, whatever the notification mode
+	RecordJournal([&Data](FInventoryJournal& InJournal) { InJournal.RecordChange(Data); });
+
+	if (ChangeScopeDepth > 0)
+	{
+		JournalInventoryChange(Data);
+		return;
+	}
+
+	if (bDeferChangeNotifications)
+	{
+		JournalInventoryChange(Data);
+
+		const UWorld* World = GetWorld();
+		if (World && !ChangeFlushTimerHandle.IsValid())
+		{
+			ChangeFlushTimerHandle = World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::FlushChangeNotifications);
+		}
+		return;
+	}
+
+	PostInventoryChange(Data);
+}
+
+void UInventorySystemComponent::JournalInventoryChange(const FInventoryChangeData& Data)
+{
+	const bool bHasInstance = Data.Instance != nullptr;
+	const TTuple<TObjectKey<UInventoryContainer>, TObjectKey<UItemInstance>, int32, int32> EntryKey(
+		Data.Container.Get(), Data.Instance.Get(), bHasInstance ? INDEX_NONE : Data.EntryId, bHasInstance ? INDEX_NONE : Data.Generation);
+
+	const int32* JournalIndex = ChangeJournalIndex.Find(EntryKey);
+	if (!JournalIndex)
+	{
+		ChangeJournalIndex.Add(EntryKey, ChangeJournal.Add(Data));
+		return;
+	}
+
+	// The merged change goes from the state before the pending change to the state after the new one
+	FInventoryChangeData& Pending = ChangeJournal[*JournalIndex];
+	const EInventoryChangeType PendingType = Pending.ChangeType;
+	const int32 OldCount = Pending.OldCount;
+
+	Pending = Data;
+	Pending.OldCount = OldCount;
+
+	if (PendingType == EInventoryChangeType::Added && Data.ChangeType == EInventoryChangeType::Removed)
+	{
+		// Added then removed in the same journal, nothing to report
+		Pending.Index = INDEX_NONE;
+		ChangeJournalIndex.Remove(EntryKey);
+	}
+	else if (PendingType == EInventoryChangeType::Added)
+	{
+		Pending.ChangeType = EInventoryChangeType::Added;
+	}
+	else if (PendingType == EInventoryChangeType::Removed && Data.ChangeType == EInventoryChangeType::Added)
+	{
+		Pending.ChangeType = EInventoryChangeType::Modified;
+	}
+}
+
+void UInventorySystemComponent::BeginChangeScope()
+{
+	++ChangeScopeDepth;
+}
+
+void UInventorySystemComponent::EndChangeScope()
+{
+	if (!ensureMsgf(ChangeScopeDepth > 0, TEXT("EndChangeScope called without a matching BeginChangeScope")))
+	{
+		return;
+	}
+
+	if (--ChangeScopeDepth == 0)
+	{
+		FlushChangeNotifications();
+	}
+}
+
+void UInventorySystemComponent::SetDeferChangeNotifications(const bool bDefer)
+{
+	bDeferChangeNotifications = bDefer;
+	if (!bDeferChangeNotifications)
+	{
+		FlushChangeNotifications();
+	}
+}
+
+void UInventorySystemComponent::FlushChangeNotifications()
+{
+	if (const UWorld* World = GetWorld(); World && ChangeFlushTimerHandle.IsValid())
+	{
+		World->GetTimerManager().ClearTimer(ChangeFlushTimerHandle);
+	}
+	ChangeFlushTimerHandle.Invalidate();
+
+	// Reported by the outermost scope
+	if (ChangeScopeDepth > 0)
+	{
+		return;
+	}
+
+	// Moved out first, listeners may modify the inventory again
+	TArray<FInventoryChangeData> Changes = MoveTemp(ChangeJournal);
+	ChangeJournal.Reset();
+	ChangeJournalIndex.Reset();
+
+	Changes.RemoveAll([](const FInventoryChangeData& Change) { return !Change.IsValid(); });
+	if (Changes.IsEmpty())
+	{
+		return;
+	}
+
+	PostInventoryBatchChanged(Changes);
+
+	// Listeners of the per-entry events still get the changes of the scopes in immediate mode
+	if (!bDeferChangeNotifications)
+	{
+		for (const FInventoryChangeData& Change : Changes)
+		{
+			PostInventoryChange(Change);
+		}
+	}
+}
+
+void UInventorySystemComponent::PostInventoryChange(const FInventoryChangeData& Data)
+{
+	switch (Data.ChangeType)
+	{
+	case EInventoryChangeType::Added:
+		PostInventoryEntryAdded(Data);
+		break;
+	case EInventoryChangeType::Removed:
+		PostInventoryEntryRemoved(Data);
+		break;
+	case EInventoryChangeType::Modified:
+		PostInventoryEntryChanged(Data);
+		break;
+	}
+	PostInventoryChanged(Data);
+}
+
+void UInventorySystemComponent::PostInventoryEntryAdded(const FInventoryChangeData& Data)
+{
+	OnInventoryEntryAdded.Broadcast(Data);
+}
+
+void UInventorySystemComponent::PostInventoryEntryRemoved(const FInventoryChangeData& Data)
 {
 	OnInventoryEntryRemoved.Broadcast(Data);
 }
@@ -360,3 +1289,25 @@ void UInventorySystemComponent::PostInventoryChanged(const FInventoryChangeData&
 {
 	OnInventoryChanged.Broadcast(Data);
 }
+
+void UInventorySystemComponent::PostInventoryBatchChanged(const TArray<FInventoryChangeData>& Changes)
+{
+	OnInventoryBatchChanged.Broadcast(Changes);
+}
+
+FInventoryChangeScope::FInventoryChangeScope(UInventorySystemComponent* InComponent)
+	: Component(InComponent)
+{
+	if (Component.IsValid())
+	{
+		Component->BeginChangeScope();
+	}
+}
+
+FInventoryChangeScope::~FInventoryChangeScope()
+{
+	if (Component.IsValid())
+	{
+		Component->EndChangeScope();
+	}
+}
@@ -5,10 +5,14 @@
 
 #include "Containers/Policies/StoragePolicy.h"
 #include "Definitions/ItemDefinition.h"
-#include "Engine/ActorChannel.h"
 #include "GameplayTags/InventoryGameplayTags.h"
 #include "Instances/ItemInstance.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+#if UE_WITH_IRIS
+#include "Iris/ReplicationSystem/ReplicationFragmentUtil.h"
+#endif
 
 UInventoryContainer::UInventoryContainer(const FObjectInitializer& ObjectInitializer)
 {
@@ -19,25 +23,26 @@ void UInventoryContainer::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>&
 {
 	UObject::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(UInventoryContainer, InventoryList);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UInventoryContainer, InventoryList, Params);
 }
 
-bool UInventoryContainer::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
+#if UE_WITH_IRIS
+void UInventoryContainer::RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags)
 {
-	bool bReplicated = true;
-	for (FInventoryEntry& Entry : InventoryList.Entries)
-	{
-		if (UItemInstance* Instance = Entry.Instance; IsValid(Instance))
-		{
-			bReplicated |= Channel->ReplicateSubobject(Instance, *Bunch, *RepFlags);
-		}
-	}
-	return bReplicated;
+	// Builds the replication state descriptors of the replicated properties, fast arrays included
+	UE::Net::FReplicationFragmentUtil::CreateAndRegisterFragmentsForObject(this, Context, RegistrationFlags);
 }
+#endif
 
 FInventoryResult UInventoryContainer::TryAddItemDefinition(const TSubclassOf<UItemDefinition> Definition, const int32 Count)
 {
 	FInventoryResult Result;
+	if (!CanModifyContent(Result.FailureReason))
+	{
+		return Result;
+	}
 	if (!IsValid(Definition))
 	{
 		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidDefinition;
@@ -53,9 +58,30 @@ FInventoryResult UInventoryContainer::TryAddItemDefinition(const TSubclassOf<UIt
 	return Result;
 }
 
+FInventoryBatchResult UInventoryContainer::TryAddItemDefinitions(const TArray<FInventoryAddRequest>& Requests)
+{
+	FInventoryBatchResult BatchResult;
+	if (FGameplayTag FailureReason; !CanModifyContent(FailureReason))
+	{
+		BatchResult.Results.SetNum(Requests.Num());
+		for (FInventoryResult& Result : BatchResult.Results)
+		{
+			Result.FailureReason = FailureReason;
+		}
+		return BatchResult;
+	}
+
+	InventoryList.AddFromDefinitions(Requests, BatchResult.Results);
+	return BatchResult;
+}
+
 FInventoryResult UInventoryContainer::TryAddItemInstance(UItemInstance* Instance, const int32 Count)
 {
 	FInventoryResult Result;
+	if (!CanModifyContent(Result.FailureReason))
+	{
+		return Result;
+	}
 	if (!IsValid(Instance))
 	{
 		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidInstance;
@@ -70,6 +96,11 @@ FInventoryResult UInventoryContainer::TryAddItemInstance(UItemInstance* Instance
 	{
 		return Result;
 	}
+	// An instance always gets its own stack
+	if (!ValidateCapacity(Instance->GetDefinitionClass(), Count, 1, Result.FailureReason))
+	{
+		return Result;
+	}
 
 	Result = InventoryList.AddInstance(Instance, Count);
 	return Result;
@@ -82,12 +113,19 @@ bool UInventoryContainer::TryRemoveItem(FInventoryEntryHandle& Handle, FGameplay
 		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidInstance;
 		return false;
 	}
+	if (!CanModifyContent(OutFailureReason))
+	{
+		return false;
+	}
 
 	if (InventoryList.RemoveFromHandle(Handle, OutFailureReason))
 	{
 		return true;
 	}
-	OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
+	if (!OutFailureReason.IsValid())
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
+	}
 	return false;
 }
 
@@ -95,25 +133,46 @@ FInventoryResult UInventoryContainer::TryMoveItemTo(FInventoryEntryHandle Handle
 {
 	FInventoryResult Result;
 
-	if (!Handle.IsHandleValid())
+	// Checked before adding to the target, a stale handle would duplicate the item
+	const int32 EntryIndex = Handle.IsHandleValid() && Handle.Container == this ? InventoryList.FindEntryIndex(Handle) : INDEX_NONE;
+	if (EntryIndex == INDEX_NONE)
 	{
 		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
 		return Result;
 	}
+	if (InventoryList.IsEntryLocked(Handle.EntryId))
+	{
+		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Locked;
+		return Result;
+	}
 	if (!IsValid(TargetContainer))
 	{
 		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidContainer;
 		return Result;
 	}
-
-	UItemInstance* Instance = Handle.ItemInstance;
-	if (!IsValid(Instance))
+	// Checked before adding to the target, the removal being refused afterwards would duplicate the item
+	if (!CanModifyContent(Result.FailureReason))
 	{
-		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidInstance;
 		return Result;
 	}
 
-	Result = TargetContainer->TryAddItemInstance(Instance, Handle.StackCount);
+	// The count of the handle is a snapshot, a top-up or a partial consume since then keeps the handle valid
+	UItemInstance* Instance = InventoryList.Entries[EntryIndex].Instance;
+	const TSubclassOf<UItemDefinition> DefinitionClass = InventoryList.Entries[EntryIndex].GetDefinitionClass();
+	const int32 StackCount = InventoryList.Entries[EntryIndex].StackCount;
+	if (Instance)
+	{
+		Result = TargetContainer->TryAddItemInstance(Instance, StackCount);
+	}
+	else if (DefinitionClass)
+	{
+		// Commodities are merged into the stacks of the target
+		Result = TargetContainer->TryAddItemDefinition(DefinitionClass, StackCount);
+	}
+	else
+	{
+		Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidInstance;
+	}
 	if (!Result.Succeeded())
 	{
 		return Result;
@@ -132,6 +191,11 @@ FInventoryEntryHandle UInventoryContainer::FindHandle(UItemInstance* Instance) c
 	return InventoryList.FindHandleFromInstance(Instance);
 }
 
+bool UInventoryContainer::IsHandleStale(const FInventoryEntryHandle& Handle) const
+{
+	return Handle.Container != this || InventoryList.FindEntryIndex(Handle) == INDEX_NONE;
+}
+
 void UInventoryContainer::SetOwnerComponent(UInventorySystemComponent* NewOwner)
 {
 	OwnerComponent = NewOwner;
@@ -148,11 +212,33 @@ int32 UInventoryContainer::GetTotalCountByDefinition(const TSubclassOf<UItemDefi
 	return InventoryList.GetTotalCountByDefinition(DefinitionClass);
 }
 
+bool UInventoryContainer::CanModifyContent(FGameplayTag& OutFailureReason) const
+{
+	return !IsValid(OwnerComponent) || OwnerComponent->CanModifyContent(OutFailureReason);
+}
+
 bool UInventoryContainer::ValidateStorage(UItemInstance* Instance, FGameplayTag& OutFailureReason) const
 {
+	// Compiled policies only see the definition tags, instances with their own tags go through CanStoreItem
+	const UItemDefinition* Definition = Instance->GetDefinition();
+	const bool bUseCompiledPredicates = IsValid(Definition) && !Instance->HasInstanceTags();
+
 	for (const TObjectPtr<UStoragePolicy>& Policy : Policies)
 	{
-		if (IsValid(Policy) && !Policy->CanStoreItem(Instance, OutFailureReason))
+		if (!IsValid(Policy))
+		{
+			continue;
+		}
+
+		if (const FStoragePolicyPredicate* Predicate = bUseCompiledPredicates ? Policy->GetCompiledPredicate() : nullptr)
+		{
+			if (!Predicate->Evaluate(*Definition))
+			{
+				OutFailureReason = Predicate->FailureReason;
+				return false;
+			}
+		}
+		else if (!Policy->CanStoreItem(Instance, OutFailureReason))
 		{
 			return false;
 		}
@@ -162,6 +248,65 @@ bool UInventoryContainer::ValidateStorage(UItemInstance* Instance, FGameplayTag&
 	return true;
 }
 
+bool UInventoryContainer::ValidateCapacity(const TSubclassOf<UItemDefinition>& DefinitionClass, const int32 Count, const int32 NewStacks, FGameplayTag& OutFailureReason) const
+{
+	for (const TObjectPtr<UStoragePolicy>& Policy : Policies)
+	{
+		if (IsValid(Policy) && !Policy->CanStoreCount(this, DefinitionClass, Count, NewStacks, OutFailureReason))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool UInventoryContainer::ValidateCapacityBatch(const TConstArrayView<FInventoryCapacityRequest> Requests, FGameplayTag& OutFailureReason) const
+{
+	for (const TObjectPtr<UStoragePolicy>& Policy : Policies)
+	{
+		if (IsValid(Policy) && !Policy->CanStoreBatch(this, Requests, OutFailureReason))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+UInventoryView* UInventoryContainer::CreateView(const FGameplayTag FilterTag, const EInventoryViewSortKey SortKey, const bool bDescending)
+{
+	UInventoryView* View = NewObject<UInventoryView>(this);
+	View->Initialize(this, FilterTag, SortKey, bDescending);
+	Views.Add(View);
+	return View;
+}
+
+void UInventoryContainer::NotifyViewsEntryAdded(const FInventoryEntry& Entry) const
+{
+	Views.RemoveAllSwap([](const TWeakObjectPtr<UInventoryView>& View) { return !View.IsValid(); });
+	for (const TWeakObjectPtr<UInventoryView>& View : Views)
+	{
+		View->HandleEntryAdded(Entry);
+	}
+}
+
+void UInventoryContainer::NotifyViewsEntryRemoved(const FInventoryEntry& Entry) const
+{
+	Views.RemoveAllSwap([](const TWeakObjectPtr<UInventoryView>& View) { return !View.IsValid(); });
+	for (const TWeakObjectPtr<UInventoryView>& View : Views)
+	{
+		View->HandleEntryRemoved(Entry);
+	}
+}
+
+void UInventoryContainer::NotifyViewsEntryChanged(const FInventoryEntry& Entry) const
+{
+	Views.RemoveAllSwap([](const TWeakObjectPtr<UInventoryView>& View) { return !View.IsValid(); });
+	for (const TWeakObjectPtr<UInventoryView>& View : Views)
+	{
+		View->HandleEntryChanged(Entry);
+	}
+}
+
 void UInventoryContainer::AddStoragePolicy(UStoragePolicy* Policy)
 {
 	if (IsValid(Policy))
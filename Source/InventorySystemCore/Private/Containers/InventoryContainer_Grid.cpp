@@ -0,0 +1,418 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+
+#include "Containers/InventoryContainer_Grid.h"
+
+#include "Components/InventorySystemComponent.h"
+#include "Definitions/ItemDefinition.h"
+#include "Definitions/Fragments/ItemFragment_GridStorable.h"
+#include "GameplayTags/InventoryGameplayTags.h"
+#include "Log/InventorySystemLog.h"
+#include "Subsystems/ItemDefinitionRegistry.h"
+
+namespace InventoryGrid
+{
+	/** Mask of the Width lowest bits */
+	uint64 MakeRowMask(const int32 Width)
+	{
+		return Width >= MaxWidth ? ~0ull : (1ull << Width) - 1;
+	}
+}
+
+bool UInventoryContainer_Grid::GetEntryPosition(const FInventoryEntryHandle& Handle, int32& OutX, int32& OutY, bool& bOutRotated) const
+{
+	if (Handle.Container != this)
+	{
+		return false;
+	}
+
+	const int32 Index = InventoryList.FindEntryIndex(Handle);
+	if (Index == INDEX_NONE || InventoryList.Entries[Index].PackedGridPosition == InventoryGrid::InvalidPosition)
+	{
+		return false;
+	}
+
+	InventoryGrid::UnpackPosition(InventoryList.Entries[Index].PackedGridPosition, OutX, OutY, bOutRotated);
+	return true;
+}
+
+bool UInventoryContainer_Grid::TryMoveEntryTo(const FInventoryEntryHandle& Handle, const int32 X, const int32 Y, const bool bRotated, FGameplayTag& OutFailureReason)
+{
+	if (!IsValid(OwnerComponent) || !OwnerComponent->GetOwner()->HasAuthority())
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_NotAuthority;
+		return false;
+	}
+	if (!CanModifyContent(OutFailureReason))
+	{
+		return false;
+	}
+
+	const int32 Index = Handle.Container == this ? InventoryList.FindEntryIndex(Handle) : INDEX_NONE;
+	if (Index == INDEX_NONE)
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
+		return false;
+	}
+
+	FInventoryEntry& Entry = InventoryList.Entries[Index];
+
+	int32 Width, Height;
+	bool bCanRotate = false;
+	if (!GetFootprint(Entry.GetDefinitionClass(), bRotated, Width, Height, &bCanRotate) || (bRotated && !bCanRotate))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_NoSpace;
+		return false;
+	}
+
+	ConditionalRebuildOccupancy();
+
+	// The entry may overlap its own previous area
+	FRowMasks Rows = OccupiedRows;
+	MarkEntry(Rows, Entry, false);
+	if (!IsAreaFree(Rows, X, Y, Width, Height))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_NoSpace;
+		return false;
+	}
+
+	MarkArea(Rows, X, Y, Width, Height, true);
+	OccupiedRows = MoveTemp(Rows);
+
+	Entry.PackedGridPosition = InventoryGrid::PackPosition(X, Y, bRotated);
+	InventoryList.MarkEntryDirty(Entry);
+
+	OnGridLayoutChanged.Broadcast(this);
+	OutFailureReason = FGameplayTag::EmptyTag;
+	return true;
+}
+
+bool UInventoryContainer_Grid::SortAndCompact()
+{
+	FGameplayTag FailureReason;
+	if (!IsValid(OwnerComponent) || !OwnerComponent->GetOwner()->HasAuthority() || !CanModifyContent(FailureReason))
+	{
+		return false;
+	}
+
+	struct FPlacement
+	{
+		int32 Index;
+		int32 Area;
+		FName DefinitionName;
+		uint16 PackedPosition;
+	};
+
+	TArray<FPlacement> Placements;
+	Placements.Reserve(InventoryList.Entries.Num());
+	for (int32 Index = 0; Index < InventoryList.Entries.Num(); ++Index)
+	{
+		const TSubclassOf<UItemDefinition> DefinitionClass = InventoryList.Entries[Index].GetDefinitionClass();
+
+		int32 Width, Height;
+		if (!GetFootprint(DefinitionClass, false, Width, Height))
+		{
+			return false;
+		}
+		Placements.Add({Index, Width * Height, DefinitionClass->GetFName(), InventoryGrid::InvalidPosition});
+	}
+
+	// Largest footprints first, items of a same definition side by side
+	Placements.Sort([this](const FPlacement& A, const FPlacement& B)
+	{
+		if (A.Area != B.Area)
+		{
+			return A.Area > B.Area;
+		}
+		if (A.DefinitionName != B.DefinitionName)
+		{
+			return A.DefinitionName.LexicalLess(B.DefinitionName);
+		}
+		return InventoryList.Entries[A.Index].EntryId < InventoryList.Entries[B.Index].EntryId;
+	});
+
+	FRowMasks Rows;
+	Rows.SetNumZeroed(GridHeight);
+	for (FPlacement& Placement : Placements)
+	{
+		if (!PlaceFootprint(Rows, InventoryList.Entries[Placement.Index].GetDefinitionClass(), Placement.PackedPosition))
+		{
+			return false;
+		}
+	}
+
+	// Only the moved entries are replicated
+	for (const FPlacement& Placement : Placements)
+	{
+		if (FInventoryEntry& Entry = InventoryList.Entries[Placement.Index]; Entry.PackedGridPosition != Placement.PackedPosition)
+		{
+			Entry.PackedGridPosition = Placement.PackedPosition;
+			InventoryList.MarkEntryDirty(Entry);
+		}
+	}
+	OccupiedRows = MoveTemp(Rows);
+	bOccupancyDirty = false;
+
+	OnGridLayoutChanged.Broadcast(this);
+	return true;
+}
+
+bool UInventoryContainer_Grid::FindFreeArea(const int32 Width, const int32 Height, int32& OutX, int32& OutY) const
+{
+	ConditionalRebuildOccupancy();
+	return FindFit(OccupiedRows, Width, Height, OutX, OutY);
+}
+
+bool UInventoryContainer_Grid::IsCellOccupied(const int32 X, const int32 Y) const
+{
+	ConditionalRebuildOccupancy();
+	return OccupiedRows.IsValidIndex(Y) && X >= 0 && X < GridWidth && (OccupiedRows[Y] >> X & 1ull) != 0;
+}
+
+bool UInventoryContainer_Grid::ValidateCapacity(const TSubclassOf<UItemDefinition>& DefinitionClass, const int32 Count, const int32 NewStacks, FGameplayTag& OutFailureReason) const
+{
+	if (!Super::ValidateCapacity(DefinitionClass, Count, NewStacks, OutFailureReason))
+	{
+		return false;
+	}
+	if (NewStacks <= 0)
+	{
+		return true;
+	}
+
+	ConditionalRebuildOccupancy();
+
+	// Every new stack must find its own room
+	FRowMasks Rows = OccupiedRows;
+	for (int32 Stack = 0; Stack < NewStacks; ++Stack)
+	{
+		uint16 PackedPosition;
+		if (!PlaceFootprint(Rows, DefinitionClass, PackedPosition))
+		{
+			OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_NoSpace;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool UInventoryContainer_Grid::ValidateCapacityBatch(const TConstArrayView<FInventoryCapacityRequest> Requests, FGameplayTag& OutFailureReason) const
+{
+	if (!Super::ValidateCapacityBatch(Requests, OutFailureReason))
+	{
+		return false;
+	}
+
+	ConditionalRebuildOccupancy();
+
+	// Every new stack of every addition must find its own room, in the order they are placed
+	FRowMasks Rows = OccupiedRows;
+	for (const FInventoryCapacityRequest& Request : Requests)
+	{
+		for (int32 Stack = 0; Stack < Request.NewStacks; ++Stack)
+		{
+			uint16 PackedPosition;
+			if (!PlaceFootprint(Rows, Request.DefinitionClass, PackedPosition))
+			{
+				OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_NoSpace;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void UInventoryContainer_Grid::PostEntryAdded(FInventoryEntry& Entry)
+{
+	Super::PostEntryAdded(Entry);
+
+	ConditionalRebuildOccupancy();
+
+	if (Entry.PackedGridPosition != InventoryGrid::InvalidPosition)
+	{
+		// Replicated entries come with their position
+		if (!MarkEntry(OccupiedRows, Entry, true))
+		{
+			bOccupancyDirty = true;
+		}
+	}
+	else if (IsValid(OwnerComponent) && OwnerComponent->GetOwner()->HasAuthority())
+	{
+		if (!PlaceFootprint(OccupiedRows, Entry.GetDefinitionClass(), Entry.PackedGridPosition))
+		{
+			UE_LOG(LogInventorySystem, Warning, TEXT("%s: no room left for %s, the entry is not placed."), *GetNameSafe(this), *Entry.GetDebugString());
+		}
+	}
+
+	OnGridLayoutChanged.Broadcast(this);
+}
+
+void UInventoryContainer_Grid::PreEntryRemoved(const FInventoryEntry& Entry)
+{
+	Super::PreEntryRemoved(Entry);
+
+	if (!bOccupancyDirty && !MarkEntry(OccupiedRows, Entry, false))
+	{
+		bOccupancyDirty = true;
+	}
+
+	OnGridLayoutChanged.Broadcast(this);
+}
+
+void UInventoryContainer_Grid::PostEntryReplicatedChange(const FInventoryEntry& Entry)
+{
+	Super::PostEntryReplicatedChange(Entry);
+
+	// The position or the resolved footprint may have changed
+	bOccupancyDirty = true;
+
+	OnGridLayoutChanged.Broadcast(this);
+}
+
+bool UInventoryContainer_Grid::GetFootprint(const TSubclassOf<UItemDefinition>& DefinitionClass, const bool bRotated, int32& OutWidth, int32& OutHeight, bool* bOutCanRotate)
+{
+	const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(DefinitionClass);
+	if (!Definition)
+	{
+		return false;
+	}
+
+	OutWidth = 1;
+	OutHeight = 1;
+	if (const UItemFragment_GridStorable* GridFragment = Definition->FindFragmentByClass<UItemFragment_GridStorable>())
+	{
+		OutWidth = bRotated ? GridFragment->Height : GridFragment->Width;
+		OutHeight = bRotated ? GridFragment->Width : GridFragment->Height;
+		if (bOutCanRotate)
+		{
+			*bOutCanRotate = GridFragment->bCanRotate;
+		}
+	}
+	return true;
+}
+
+bool UInventoryContainer_Grid::FindFit(const FRowMasks& Rows, const int32 Width, const int32 Height, int32& OutX, int32& OutY) const
+{
+	if (Width <= 0 || Height <= 0 || Width > GridWidth || Height > GridHeight || Rows.Num() < GridHeight)
+	{
+		return false;
+	}
+
+	const uint64 GridMask = InventoryGrid::MakeRowMask(GridWidth);
+	for (int32 Y = 0; Y + Height <= GridHeight; ++Y)
+	{
+		uint64 Occupied = 0;
+		for (int32 Row = Y; Row < Y + Height; ++Row)
+		{
+			Occupied |= Rows[Row];
+		}
+
+		// Bit X of Candidates stays set only if the Width cells starting at column X are all free
+		const uint64 Free = ~Occupied & GridMask;
+		uint64 Candidates = Free;
+		for (int32 Shift = 1; Shift < Width && Candidates; ++Shift)
+		{
+			Candidates &= Free >> Shift;
+		}
+
+		if (Candidates)
+		{
+			OutX = FMath::CountTrailingZeros64(Candidates);
+			OutY = Y;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool UInventoryContainer_Grid::IsAreaFree(const FRowMasks& Rows, const int32 X, const int32 Y, const int32 Width, const int32 Height) const
+{
+	if (X < 0 || Y < 0 || X + Width > GridWidth || Y + Height > GridHeight || Rows.Num() < GridHeight)
+	{
+		return false;
+	}
+
+	const uint64 AreaMask = InventoryGrid::MakeRowMask(Width) << X;
+	for (int32 Row = Y; Row < Y + Height; ++Row)
+	{
+		if (Rows[Row] & AreaMask)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool UInventoryContainer_Grid::PlaceFootprint(FRowMasks& Rows, const TSubclassOf<UItemDefinition>& DefinitionClass, uint16& OutPackedPosition) const
+{
+	int32 Width, Height, X, Y;
+	bool bCanRotate = false;
+	if (!GetFootprint(DefinitionClass, false, Width, Height, &bCanRotate))
+	{
+		return false;
+	}
+
+	bool bRotated = false;
+	if (!FindFit(Rows, Width, Height, X, Y))
+	{
+		if (!bCanRotate || Width == Height || !FindFit(Rows, Height, Width, X, Y))
+		{
+			return false;
+		}
+		Swap(Width, Height);
+		bRotated = true;
+	}
+
+	MarkArea(Rows, X, Y, Width, Height, true);
+	OutPackedPosition = InventoryGrid::PackPosition(X, Y, bRotated);
+	return true;
+}
+
+void UInventoryContainer_Grid::MarkArea(FRowMasks& Rows, const int32 X, const int32 Y, const int32 Width, const int32 Height, const bool bOccupied)
+{
+	const uint64 AreaMask = InventoryGrid::MakeRowMask(Width) << X;
+	for (int32 Row = Y; Row < Y + Height && Row < Rows.Num(); ++Row)
+	{
+		Rows[Row] = bOccupied ? Rows[Row] | AreaMask : Rows[Row] & ~AreaMask;
+	}
+}
+
+bool UInventoryContainer_Grid::MarkEntry(FRowMasks& Rows, const FInventoryEntry& Entry, const bool bOccupied)
+{
+	if (Entry.PackedGridPosition == InventoryGrid::InvalidPosition)
+	{
+		return true;
+	}
+
+	int32 X, Y, Width, Height;
+	bool bRotated;
+	InventoryGrid::UnpackPosition(Entry.PackedGridPosition, X, Y, bRotated);
+	if (!GetFootprint(Entry.GetDefinitionClass(), bRotated, Width, Height))
+	{
+		return false;
+	}
+
+	MarkArea(Rows, X, Y, Width, Height, bOccupied);
+	return true;
+}
+
+void UInventoryContainer_Grid::ConditionalRebuildOccupancy() const
+{
+	if (!bOccupancyDirty && OccupiedRows.Num() == GridHeight)
+	{
+		return;
+	}
+
+	OccupiedRows.Reset();
+	OccupiedRows.SetNumZeroed(GridHeight);
+	bOccupancyDirty = false;
+
+	for (const FInventoryEntry& Entry : InventoryList.Entries)
+	{
+		// Keep the occupancy dirty while some replicated definitions are still unresolved
+		if (!MarkEntry(OccupiedRows, Entry, true))
+		{
+			bOccupancyDirty = true;
+		}
+	}
+}
@@ -0,0 +1,297 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+
+#include "Containers/InventoryView.h"
+
+#include "Algo/BinarySearch.h"
+#include "Containers/InventoryContainer.h"
+#include "Definitions/ItemDefinition.h"
+#include "Definitions/Fragments/ItemFragment_Storable.h"
+#include "Engine/World.h"
+#include "Subsystems/ItemDefinitionRegistry.h"
+#include "TimerManager.h"
+
+namespace InventoryView
+{
+	bool IsSameEntry(const FInventoryEntryHandle& Handle, const FInventoryEntry& Entry)
+	{
+		return Handle.EntryId == Entry.EntryId && Handle.Generation == Entry.Generation;
+	}
+}
+
+TArray<FInventoryEntryHandle> UInventoryView::GetHandles() const
+{
+	TArray<FInventoryEntryHandle> Handles;
+	Handles.Reserve(Items.Num());
+	for (const FInventoryViewItem& Item : Items)
+	{
+		Handles.Add(Item.Handle);
+	}
+	return Handles;
+}
+
+void UInventoryView::Refresh()
+{
+	UInventoryContainer* OwningContainer = Container.Get();
+	if (!OwningContainer)
+	{
+		return;
+	}
+
+	const TArray<FInventoryViewItem> PreviousItems = MoveTemp(Items);
+	Items.Reset();
+
+	const FInventoryList& InventoryList = OwningContainer->GetInventoryList();
+	const TArray<FInventoryEntryHandle> Handles = FilterTag.IsValid() ? InventoryList.GetHandlesByTag(FilterTag) : InventoryList.GetAllHandles();
+
+	Items.Reserve(Handles.Num());
+	for (const FInventoryEntryHandle& Handle : Handles)
+	{
+		if (const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(Handle.DefinitionClass); Matches(Definition))
+		{
+			Items.Add(MakeItem(Handle, Definition));
+		}
+	}
+
+	// The tag index is unordered, entry identifiers keep the insertion order stable between refreshes
+	Items.Sort([this](const FInventoryViewItem& A, const FInventoryViewItem& B) { return IsSortedBefore(A, B); });
+
+	// Pending changes are superseded by the difference with the previous content
+	PendingAdded.Reset();
+	PendingRemoved.Reset();
+	PendingChanged.Reset();
+
+	TSet<TPair<int32, int32>> PreviousEntries;
+	PreviousEntries.Reserve(PreviousItems.Num());
+	for (const FInventoryViewItem& Previous : PreviousItems)
+	{
+		PreviousEntries.Add({Previous.Handle.EntryId, Previous.Handle.Generation});
+	}
+
+	PositionByEntryId.Reset();
+	UpdatePositionsFrom(0);
+	for (const FInventoryViewItem& Item : Items)
+	{
+		if (!PreviousEntries.Contains({Item.Handle.EntryId, Item.Handle.Generation}))
+		{
+			PendingAdded.Add(Item.Handle);
+		}
+	}
+	for (const FInventoryViewItem& Previous : PreviousItems)
+	{
+		if (FindPosition(Previous.Handle.EntryId, Previous.Handle.Generation) == INDEX_NONE)
+		{
+			PendingRemoved.Add(Previous.Handle);
+		}
+	}
+
+	FlushChanges();
+}
+
+void UInventoryView::FlushChanges()
+{
+	bFlushScheduled = false;
+
+	if (PendingAdded.IsEmpty() && PendingRemoved.IsEmpty() && PendingChanged.IsEmpty())
+	{
+		return;
+	}
+
+	// Moved out first, listeners may modify the container and accumulate new changes
+	const TArray<FInventoryEntryHandle> Added = MoveTemp(PendingAdded);
+	const TArray<FInventoryEntryHandle> Removed = MoveTemp(PendingRemoved);
+	const TArray<FInventoryEntryHandle> Changed = MoveTemp(PendingChanged);
+	PendingAdded.Reset();
+	PendingRemoved.Reset();
+	PendingChanged.Reset();
+
+	OnViewChanged.Broadcast(this, Added, Removed, Changed);
+}
+
+void UInventoryView::Initialize(UInventoryContainer* InContainer, const FGameplayTag& InFilterTag, const EInventoryViewSortKey InSortKey, const bool bInDescending)
+{
+	Container = InContainer;
+	FilterTag = InFilterTag;
+	SortKey = InSortKey;
+	bDescending = bInDescending;
+
+	Refresh();
+}
+
+void UInventoryView::HandleEntryAdded(const FInventoryEntry& Entry)
+{
+	const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(Entry.AggregatedDefinition);
+	if (!Matches(Definition))
+	{
+		return;
+	}
+
+	const FInventoryEntryHandle Handle(Entry, Container.Get());
+	InsertSorted(MakeItem(Handle, Definition));
+
+	PendingAdded.Add(Handle);
+	ScheduleFlush();
+}
+
+void UInventoryView::HandleEntryRemoved(const FInventoryEntry& Entry)
+{
+	const int32 Position = FindPosition(Entry.EntryId, Entry.Generation);
+	if (Position == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FInventoryEntryHandle Handle = Items[Position].Handle;
+	RemoveAt(Position);
+
+	// An entry added and removed between two broadcasts is never reported
+	PendingChanged.RemoveAll([&Entry](const FInventoryEntryHandle& Pending) { return InventoryView::IsSameEntry(Pending, Entry); });
+	if (PendingAdded.RemoveAll([&Entry](const FInventoryEntryHandle& Pending) { return InventoryView::IsSameEntry(Pending, Entry); }) == 0)
+	{
+		PendingRemoved.Add(Handle);
+	}
+	ScheduleFlush();
+}
+
+void UInventoryView::HandleEntryChanged(const FInventoryEntry& Entry)
+{
+	const int32 Position = FindPosition(Entry.EntryId, Entry.Generation);
+	if (Position == INDEX_NONE)
+	{
+		return;
+	}
+
+	const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(Entry.AggregatedDefinition);
+	const FInventoryEntryHandle Handle(Entry, Container.Get());
+	FInventoryViewItem Item = MakeItem(Handle, Definition);
+
+	// Only the numeric sort keys depend on the stack count
+	if (SortKey == EInventoryViewSortKey::StackCount || SortKey == EInventoryViewSortKey::Weight)
+	{
+		RemoveAt(Position);
+		InsertSorted(MoveTemp(Item));
+	}
+	else
+	{
+		Items[Position] = MoveTemp(Item);
+	}
+
+	// Entries added since the last broadcast are reported as added, with their current count
+	if (FInventoryEntryHandle* Added = PendingAdded.FindByPredicate([&Entry](const FInventoryEntryHandle& Pending) { return InventoryView::IsSameEntry(Pending, Entry); }))
+	{
+		*Added = Handle;
+	}
+	else if (FInventoryEntryHandle* Changed = PendingChanged.FindByPredicate([&Entry](const FInventoryEntryHandle& Pending) { return InventoryView::IsSameEntry(Pending, Entry); }))
+	{
+		*Changed = Handle;
+	}
+	else
+	{
+		PendingChanged.Add(Handle);
+	}
+	ScheduleFlush();
+}
+
+bool UInventoryView::Matches(const UItemDefinition* Definition) const
+{
+	if (!Definition)
+	{
+		return false;
+	}
+	// Parent tags are expanded on the definition, so that filtering on Item.Weapon matches Item.Weapon.Sword
+	return !FilterTag.IsValid() || Definition->GetTagsWithParents().HasTagExact(FilterTag);
+}
+
+FInventoryViewItem UInventoryView::MakeItem(const FInventoryEntryHandle& Handle, const UItemDefinition* Definition) const
+{
+	FInventoryViewItem Item;
+	Item.Handle = Handle;
+
+	switch (SortKey)
+	{
+	case EInventoryViewSortKey::DisplayName:
+		Item.NameKey = Definition ? Definition->DisplayName : FText::GetEmpty();
+		break;
+	case EInventoryViewSortKey::StackCount:
+		Item.NumericKey = Handle.StackCount;
+		break;
+	case EInventoryViewSortKey::Weight:
+		if (const UItemFragment_Storable* StorableFragment = Definition ? Definition->FindFragmentByClass<UItemFragment_Storable>() : nullptr)
+		{
+			Item.NumericKey = StorableFragment->Weight * Handle.StackCount;
+		}
+		break;
+	default:
+		break;
+	}
+	return Item;
+}
+
+bool UInventoryView::IsSortedBefore(const FInventoryViewItem& A, const FInventoryViewItem& B) const
+{
+	int32 Comparison = 0;
+	switch (SortKey)
+	{
+	case EInventoryViewSortKey::DisplayName:
+		Comparison = A.NameKey.CompareTo(B.NameKey);
+		break;
+	case EInventoryViewSortKey::StackCount:
+	case EInventoryViewSortKey::Weight:
+		Comparison = A.NumericKey < B.NumericKey ? -1 : (A.NumericKey > B.NumericKey ? 1 : 0);
+		break;
+	default:
+		break;
+	}
+
+	if (Comparison != 0)
+	{
+		return bDescending ? Comparison > 0 : Comparison < 0;
+	}
+	return A.Handle.EntryId < B.Handle.EntryId;
+}
+
+void UInventoryView::InsertSorted(FInventoryViewItem&& Item)
+{
+	// Without sort key, entries are appended in the order they entered the view
+	const int32 Position = SortKey == EInventoryViewSortKey::None
+		                       ? Items.Num()
+		                       : Algo::UpperBound(Items, Item, [this](const FInventoryViewItem& A, const FInventoryViewItem& B) { return IsSortedBefore(A, B); });
+	Items.Insert(MoveTemp(Item), Position);
+	UpdatePositionsFrom(Position);
+}
+
+void UInventoryView::RemoveAt(const int32 Position)
+{
+	PositionByEntryId.Remove(Items[Position].Handle.EntryId);
+	Items.RemoveAt(Position);
+	UpdatePositionsFrom(Position);
+}
+
+void UInventoryView::UpdatePositionsFrom(const int32 Position)
+{
+	// Only the shifted items, appending without sort key updates a single one
+	for (int32 Index = Position; Index < Items.Num(); ++Index)
+	{
+		PositionByEntryId.Add(Items[Index].Handle.EntryId, Index);
+	}
+}
+
+int32 UInventoryView::FindPosition(const int32 EntryId, const int32 Generation) const
+{
+	const int32* Position = PositionByEntryId.Find(EntryId);
+	return Position && Items[*Position].Handle.Generation == Generation ? *Position : INDEX_NONE;
+}
+
+void UInventoryView::ScheduleFlush()
+{
+	if (bFlushScheduled)
+	{
+		return;
+	}
+
+	if (const UWorld* World = GetWorld())
+	{
+		bFlushScheduled = true;
+		World->GetTimerManager().SetTimerForNextTick(this, &UInventoryView::FlushChanges);
+	}
+}
@@ -3,7 +3,59 @@
 
 #include "Containers/Policies/StoragePolicy.h"
 
+#include "Definitions/ItemDefinition.h"
+
+bool FStoragePolicyPredicate::Evaluate(const UItemDefinition& Definition) const
+{
+	const FInventoryTagBitset& Tags = bMatchParentTags ? Definition.GetTagBitsWithParents() : Definition.GetTagBits();
+	if (bRequireAll ? !Tags.HasAll(RequiredTags) : !Tags.HasAny(RequiredTags))
+	{
+		return false;
+	}
+	return !Tags.HasAny(ForbiddenTags);
+}
+
 bool UStoragePolicy::CanStoreItem_Implementation(UItemInstance* Instance, FGameplayTag& OutFailureReason) const
 {
 	return true;
 }
+
+bool UStoragePolicy::CanStoreCount_Implementation(const UInventoryContainer* Container, TSubclassOf<UItemDefinition> DefinitionClass, int32 Count, int32 NewStacks, FGameplayTag& OutFailureReason) const
+{
+	return true;
+}
+
+bool UStoragePolicy::CanStoreBatch(const UInventoryContainer* Container, const TConstArrayView<FInventoryCapacityRequest> Requests, FGameplayTag& OutFailureReason) const
+{
+	for (const FInventoryCapacityRequest& Request : Requests)
+	{
+		if (!CanStoreCount(Container, Request.DefinitionClass, Request.Count, Request.NewStacks, OutFailureReason))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+const FStoragePolicyPredicate* UStoragePolicy::GetCompiledPredicate() const
+{
+	if (!bPredicateCompiled)
+	{
+		CompiledPredicate = FStoragePolicyPredicate();
+
+		// A Blueprint override may check anything, it cannot be replaced by the native predicate
+		const bool bOverriddenInScript = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UStoragePolicy, CanStoreItem));
+		bPredicateValid = !bOverriddenInScript && CompilePredicate(CompiledPredicate);
+		bPredicateCompiled = true;
+	}
+	return bPredicateValid ? &CompiledPredicate : nullptr;
+}
+
+#if WITH_EDITOR
+void UStoragePolicy::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	InvalidateCompiledPredicate();
+}
+#endif
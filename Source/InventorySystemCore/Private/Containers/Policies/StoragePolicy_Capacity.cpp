@@ -0,0 +1,67 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+
+#include "Containers/Policies/StoragePolicy_Capacity.h"
+
+#include "Containers/InventoryContainer.h"
+#include "Definitions/ItemDefinition.h"
+#include "Definitions/Fragments/ItemFragment_Storable.h"
+#include "GameplayTags/InventoryGameplayTags.h"
+#include "Subsystems/ItemDefinitionRegistry.h"
+
+bool UStoragePolicy_Capacity::CanStoreCount_Implementation(const UInventoryContainer* Container, const TSubclassOf<UItemDefinition> DefinitionClass, const int32 Count, const int32 NewStacks, FGameplayTag& OutFailureReason) const
+{
+	if (!Super::CanStoreCount_Implementation(Container, DefinitionClass, Count, NewStacks, OutFailureReason))
+	{
+		return false;
+	}
+	return CheckLimits(Container, NewStacks, MaxWeight > 0.f ? GetWeight(DefinitionClass, Count) : 0.f, OutFailureReason);
+}
+
+bool UStoragePolicy_Capacity::CanStoreBatch(const UInventoryContainer* Container, const TConstArrayView<FInventoryCapacityRequest> Requests, FGameplayTag& OutFailureReason) const
+{
+	// The limits apply to the sum of the additions, not to each one
+	int32 NewStacks = 0;
+	float AddedWeight = 0.f;
+	for (const FInventoryCapacityRequest& Request : Requests)
+	{
+		if (!Super::CanStoreCount_Implementation(Container, Request.DefinitionClass, Request.Count, Request.NewStacks, OutFailureReason))
+		{
+			return false;
+		}
+		NewStacks += Request.NewStacks;
+		AddedWeight += MaxWeight > 0.f ? GetWeight(Request.DefinitionClass, Request.Count) : 0.f;
+	}
+	return CheckLimits(Container, NewStacks, AddedWeight, OutFailureReason);
+}
+
+bool UStoragePolicy_Capacity::CheckLimits(const UInventoryContainer* Container, const int32 NewStacks, const float AddedWeight, FGameplayTag& OutFailureReason) const
+{
+	if (!IsValid(Container))
+	{
+		return true;
+	}
+
+	const FInventoryAggregates& Aggregates = Container->GetAggregates();
+
+	if (MaxStacks > 0 && Aggregates.OccupiedStacks + NewStacks > MaxStacks)
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Capacity;
+		return false;
+	}
+
+	if (MaxWeight > 0.f && Aggregates.TotalWeight + AddedWeight > MaxWeight)
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Capacity;
+		return false;
+	}
+
+	return true;
+}
+
+float UStoragePolicy_Capacity::GetWeight(const TSubclassOf<UItemDefinition> DefinitionClass, const int32 Count)
+{
+	const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(DefinitionClass);
+	const UItemFragment_Storable* StorableFragment = Definition ? Definition->FindFragmentByClass<UItemFragment_Storable>() : nullptr;
+	return StorableFragment ? StorableFragment->Weight * Count : 0.f;
+}
@@ -26,3 +26,13 @@ bool UStoragePolicy_TagRequirement::CanStoreItem_Implementation(UItemInstance* I
 
 	return false;
 }
+
+bool UStoragePolicy_TagRequirement::CompilePredicate(FStoragePolicyPredicate& OutPredicate) const
+{
+	// Same semantics as CanStoreItem: exact tags must all be present, otherwise any tag matches its children
+	OutPredicate.RequiredTags = FInventoryTagBitset::FromTags(RequiredTags);
+	OutPredicate.ForbiddenTags = FInventoryTagBitset::FromTags(ForbiddenTags);
+	OutPredicate.bRequireAll = bExactMatch;
+	OutPredicate.bMatchParentTags = !bExactMatch;
+	return true;
+}
@@ -0,0 +1,262 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Data/DefinitionNetIdTable.h"
+
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/PackageMapClient.h"
+#include "Log/InventorySystemLog.h"
+#include "Misc/NetworkVersion.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/GCObject.h"
+
+/** Tables of the process, with the classes they keep loaded */
+class FDefinitionNetIdTableRegistry final : public FGCObject
+{
+public:
+	static FDefinitionNetIdTableRegistry& Get()
+	{
+		static FDefinitionNetIdTableRegistry Registry;
+		return Registry;
+	}
+
+	const FDefinitionNetIdTable* FindTable(const UClass* BaseClass) const
+	{
+		FReadScopeLock ReadLock(TablesLock);
+		const TUniquePtr<FDefinitionNetIdTable>* Table = Tables.Find(BaseClass);
+		return Table ? Table->Get() : nullptr;
+	}
+
+	const FDefinitionNetIdTable& FindOrBuildTable(const UClass* BaseClass)
+	{
+		check(IsInGameThread());
+
+		if (const FDefinitionNetIdTable* Table = FindTable(BaseClass))
+		{
+			return *Table;
+		}
+
+		UE_CLOG(bHashUsed, LogInventorySystem, Warning, TEXT("Net id table of %s built after the network version was computed, mismatched content will not be refused at the handshake. Register it at module startup."), *GetNameSafe(BaseClass));
+
+		// Built outside of the lock, loading the classes may run game thread code reading other tables
+		TUniquePtr<FDefinitionNetIdTable> NewTable(new FDefinitionNetIdTable(BaseClass));
+		const FDefinitionNetIdTable& Table = *NewTable;
+		FWriteScopeLock WriteLock(TablesLock);
+		Tables.Add(BaseClass, MoveTemp(NewTable));
+		return Table;
+	}
+
+	uint32 GetCombinedHash()
+	{
+		check(IsInGameThread());
+
+		uint32 CombinedHash = 0;
+		for (const UClass* BaseClass : BaseClasses)
+		{
+			const uint32 TableHash = FindOrBuildTable(BaseClass).GetHash();
+			CombinedHash = FCrc::MemCrc32(&TableHash, sizeof(TableHash), CombinedHash);
+		}
+		bHashUsed = true;
+		return CombinedHash;
+	}
+
+	void Reset()
+	{
+		FWriteScopeLock WriteLock(TablesLock);
+		Tables.Empty();
+		BaseClasses.Empty();
+		bHashUsed = false;
+	}
+
+	//~ Begin FGCObject Interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override
+	{
+		// Game thread, the only thread adding tables
+		for (TPair<const UClass*, TUniquePtr<FDefinitionNetIdTable>>& Pair : Tables)
+		{
+			Collector.AddReferencedObjects(Pair.Value->Classes);
+		}
+	}
+
+	virtual FString GetReferencerName() const override
+	{
+		return TEXT("FDefinitionNetIdTableRegistry");
+	}
+	//~ End FGCObject Interface
+
+	/** Base classes whose tables are part of the network version, in registration order */
+	TArray<const UClass*> BaseClasses;
+
+	/** Whether the network version includes the hash of the tables built so far */
+	bool bHashUsed = false;
+
+	/** Whether the network version override was bound by this module */
+	bool bBoundNetworkVersion = false;
+
+private:
+	/** Guards Tables, written on the game thread and read by the serializers of any thread */
+	mutable FRWLock TablesLock;
+
+	/** Table of each base class. Tables never change once added */
+	TMap<const UClass*, TUniquePtr<FDefinitionNetIdTable>> Tables;
+};
+
+void FDefinitionNetIdTable::RegisterBaseClass(const UClass* BaseClass)
+{
+	check(IsInGameThread() && BaseClass);
+
+	FDefinitionNetIdTableRegistry& Registry = FDefinitionNetIdTableRegistry::Get();
+	UE_CLOG(Registry.bHashUsed, LogInventorySystem, Warning, TEXT("%s registered after the network version was computed, its net ids are not checked at the handshake."), *BaseClass->GetName());
+	Registry.BaseClasses.AddUnique(BaseClass);
+}
+
+void FDefinitionNetIdTable::BindNetworkVersion()
+{
+	FDefinitionNetIdTableRegistry& Registry = FDefinitionNetIdTableRegistry::Get();
+	if (FNetworkVersion::GetLocalNetworkVersionOverride.IsBound())
+	{
+		UE_LOG(LogInventorySystem, Log, TEXT("Network version is overridden, mix FDefinitionNetIdTable::GetCombinedHash into it to refuse clients with other definitions."));
+		return;
+	}
+
+	// The engine caches the result, the default version computed inside is overwritten by the mixed one
+	FNetworkVersion::GetLocalNetworkVersionOverride.BindLambda([]
+	{
+		const uint32 DefaultVersion = FNetworkVersion::GetLocalNetworkVersion(false);
+		const uint32 TablesHash = GetCombinedHash();
+		return FCrc::MemCrc32(&TablesHash, sizeof(TablesHash), DefaultVersion);
+	});
+	Registry.bBoundNetworkVersion = true;
+}
+
+void FDefinitionNetIdTable::Shutdown()
+{
+	FDefinitionNetIdTableRegistry& Registry = FDefinitionNetIdTableRegistry::Get();
+	if (Registry.bBoundNetworkVersion)
+	{
+		FNetworkVersion::GetLocalNetworkVersionOverride.Unbind();
+		Registry.bBoundNetworkVersion = false;
+	}
+	Registry.Reset();
+}
+
+const FDefinitionNetIdTable& FDefinitionNetIdTable::Get(const UClass* BaseClass)
+{
+	FDefinitionNetIdTableRegistry& Registry = FDefinitionNetIdTableRegistry::Get();
+	if (const FDefinitionNetIdTable* Table = Registry.FindTable(BaseClass))
+	{
+		return *Table;
+	}
+
+	if (IsInGameThread())
+	{
+		return Registry.FindOrBuildTable(BaseClass);
+	}
+
+	// Every class is then sent through the package map, still correct but larger
+	ensureMsgf(false, TEXT("Net id table of %s read off the game thread before it was built."), *GetNameSafe(BaseClass));
+	static const FDefinitionNetIdTable EmptyTable;
+	return EmptyTable;
+}
+
+uint32 FDefinitionNetIdTable::GetCombinedHash()
+{
+	return FDefinitionNetIdTableRegistry::Get().GetCombinedHash();
+}
+
+bool FDefinitionNetIdTable::NetSerializeClass(FArchive& Ar, UPackageMap* Map, const UClass* BaseClass, UClass*& InOutClass)
+{
+	const FDefinitionNetIdTable& Table = Get(BaseClass);
+
+	uint32 Code = Ar.IsSaving() ? Table.GetNetCode(InOutClass) : NullClass;
+	Ar.SerializeIntPacked(Code);
+
+	switch (Code)
+	{
+	case NullClass:
+		InOutClass = nullptr;
+		return true;
+	case UnlistedClass:
+		{
+			UObject* Object = InOutClass;
+			const bool bMapped = Map && Map->SerializeObject(Ar, UClass::StaticClass(), Object);
+			if (Ar.IsLoading())
+			{
+				InOutClass = Cast<UClass>(Object);
+			}
+			return bMapped;
+		}
+	default:
+		if (Ar.IsLoading())
+		{
+			InOutClass = Table.ResolveNetCode(Code);
+			UE_CLOG(!InOutClass, LogInventorySystem, Warning, TEXT("Received unknown %s net id %u, server and client content may differ."), *GetNameSafe(BaseClass), Code - FirstNetId);
+			return InOutClass != nullptr;
+		}
+		return true;
+	}
+}
+
+uint32 FDefinitionNetIdTable::GetNetCode(const UClass* Class) const
+{
+	if (!Class)
+	{
+		return NullClass;
+	}
+
+	const int32 NetId = GetNetId(Class);
+	return NetId != INDEX_NONE ? FirstNetId + NetId : UnlistedClass;
+}
+
+int32 FDefinitionNetIdTable::GetNetId(const UClass* Class) const
+{
+	const int32* NetId = Class ? NetIds.Find(Class->GetClassPathName()) : nullptr;
+	return NetId ? *NetId : INDEX_NONE;
+}
+
+UClass* FDefinitionNetIdTable::FindClass(const FTopLevelAssetPath& ClassPath) const
+{
+	const int32* NetId = NetIds.Find(ClassPath);
+	return NetId ? ResolveNetId(*NetId) : nullptr;
+}
+
+FDefinitionNetIdTable::FDefinitionNetIdTable(const UClass* InBaseClass)
+{
+	check(InBaseClass);
+
+	TSet<FTopLevelAssetPath> DerivedClassPaths;
+	IAssetRegistry::GetChecked().GetDerivedClassNames({InBaseClass->GetClassPathName()}, {}, DerivedClassPaths);
+
+	// Skeleton and reinstanced classes only exist in the editor, they would shift the identifiers of the other classes
+	TArray<FString> SortedPaths;
+	SortedPaths.Reserve(DerivedClassPaths.Num());
+	for (const FTopLevelAssetPath& ClassPath : DerivedClassPaths)
+	{
+		const FString AssetName = ClassPath.GetAssetName().ToString();
+		if (!AssetName.StartsWith(TEXT("SKEL_")) && !AssetName.StartsWith(TEXT("REINST_")))
+		{
+			SortedPaths.Add(ClassPath.ToString());
+		}
+	}
+
+	// Names compare by index, only the strings give the same order in every process
+	SortedPaths.Sort([](const FString& A, const FString& B) { return A.Compare(B, ESearchCase::CaseSensitive) < 0; });
+	for (const FString& ClassPath : SortedPaths)
+	{
+		ClassPaths.Emplace(ClassPath);
+	}
+
+	NetIds.Reserve(ClassPaths.Num());
+	Classes.Reserve(ClassPaths.Num());
+	for (int32 NetId = 0; NetId < ClassPaths.Num(); ++NetId)
+	{
+		NetIds.Add(ClassPaths[NetId], NetId);
+		Hash = FCrc::StrCrc32(*SortedPaths[NetId], Hash);
+
+		// Loaded now so that receiving an identifier never blocks on a load
+		UClass* Class = LoadObject<UClass>(nullptr, *SortedPaths[NetId]);
+		UE_CLOG(!Class, LogInventorySystem, Warning, TEXT("Failed to load %s definition %s, its net id will not resolve."), *InBaseClass->GetName(), *SortedPaths[NetId]);
+		Classes.Add(Class);
+	}
+
+	UE_LOG(LogInventorySystem, Verbose, TEXT("Built net id table of %d %s classes."), ClassPaths.Num(), *InBaseClass->GetName());
+}
@@ -3,6 +3,7 @@
 #include "Data/InventoryCache.h"
 
 #include "Definitions/ItemDefinition.h"
+#include "Misc/ScopeRWLock.h"
 
 UInventoryCache::UInventoryCache()
 {
@@ -23,9 +24,21 @@ UItemDefinition* UInventoryCache::GetCachedDefinition(const TSubclassOf<UItemDef
 		return nullptr;
 	}
 
-	// Lock the critical section to ensure thread-safe access to the cache
-	FScopeLock Lock(&CacheLock);
+	// Hits only share the read lock
+	{
+		FReadScopeLock ReadLock(CacheLock);
+		if (const TWeakObjectPtr<UItemDefinition>* FoundDefinition = CachedDefinitionMap.Find(ItemDefinitionClass))
+		{
+			if (UItemDefinition* Definition = FoundDefinition->Get(); IsValid(Definition))
+			{
+				return Definition;
+			}
+		}
+	}
+
+	FWriteScopeLock WriteLock(CacheLock);
 
+	// May have been added by another thread between the locks
 	if (const TWeakObjectPtr<UItemDefinition>* FoundDefinition = CachedDefinitionMap.Find(ItemDefinitionClass))
 	{
 		if (UItemDefinition* Definition = FoundDefinition->Get(); IsValid(Definition))
@@ -34,28 +47,31 @@ UItemDefinition* UInventoryCache::GetCachedDefinition(const TSubclassOf<UItemDef
 		}
 	}
 
-	// If the definition is not cached, create a new instance
-	UItemDefinition* NewDefinition = NewObject<UItemDefinition>(this, ItemDefinitionClass);
-	CachedDefinitionMap.Add(ItemDefinitionClass, NewDefinition);
+	// Definitions are immutable at runtime, the default object is shared instead of creating a copy
+	UItemDefinition* Definition = ItemDefinitionClass->GetDefaultObject<UItemDefinition>();
+	CachedDefinitionMap.Add(ItemDefinitionClass, Definition);
 
-	return NewDefinition;
+	return Definition;
 }
 
 bool UInventoryCache::IsCachedDefinition(const TSubclassOf<UItemDefinition>& ItemDefinitionClass) const
 {
-	return CachedDefinitionMap.Contains(ItemDefinitionClass);
+	FReadScopeLock ReadLock(CacheLock);
+
+	const TWeakObjectPtr<UItemDefinition>* FoundDefinition = CachedDefinitionMap.Find(ItemDefinitionClass);
+	return FoundDefinition && FoundDefinition->IsValid();
 }
 
 void UInventoryCache::Clear()
 {
-	// Lock the critical section to ensure thread-safe access to the cache
-	FScopeLock Lock(&CacheLock);
+	FWriteScopeLock WriteLock(CacheLock);
 
-	for (auto& Pair : CachedDefinitionMap)
+	// Removing through the iterator, the map must not be modified by a range-based loop
+	for (auto It = CachedDefinitionMap.CreateIterator(); It; ++It)
 	{
-		if (Pair.Value != nullptr && !Pair.Value->IsRooted())
+		if (!IsValid(It.Key()) || !It.Value().IsValid())
 		{
-			CachedDefinitionMap.Remove(Pair.Key);
+			It.RemoveCurrent();
 		}
 	}
 }
@@ -8,6 +8,9 @@ FInventoryChangeData::FInventoryChangeData(const int32 InIndex, const FInventory
 {
 	Index = InIndex;
 	Instance = Entry.Instance;
+	DefinitionClass = Entry.GetDefinitionClass();
+	EntryId = Entry.EntryId;
+	Generation = Entry.Generation;
 	OldCount = Entry.LastStackCount;
 	NewCount = Entry.StackCount;
 	ChangeType = InChangeType;
@@ -3,6 +3,7 @@
 #include "Data/InventoryEntry.h"
 
 #include "Components/InventorySystemComponent.h"
+#include "Data/DefinitionNetIdTable.h"
 #include "Data/InventoryList.h"
 #include "Instances/ItemInstance.h"
 #include "Log/InventorySystemLog.h"
@@ -33,5 +34,75 @@ void FInventoryEntry::PostReplicatedChange(const FInventoryList& InArraySerializ
 
 FString FInventoryEntry::GetDebugString() const
 {
-	return FString::Printf(TEXT("(%s)"), *GetNameSafe(Instance));
+	return FString::Printf(TEXT("(%s)"), Instance ? *GetNameSafe(Instance) : *GetNameSafe(CommodityDefinition));
+}
+
+bool FInventoryEntry::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	enum EEntryFlags : uint8
+	{
+		HasInstance = 1 << 0,
+		HasCommodity = 1 << 1,
+		IsPlaced = 1 << 2
+	};
+
+	uint8 Flags = 0;
+	if (Ar.IsSaving())
+	{
+		Flags |= Instance ? HasInstance : 0;
+		Flags |= CommodityDefinition ? HasCommodity : 0;
+		Flags |= PackedGridPosition != MAX_uint16 ? IsPlaced : 0;
+	}
+	Ar.SerializeBits(&Flags, 3);
+
+	bOutSuccess = true;
+	if (Flags & HasInstance)
+	{
+		UObject* Object = Instance;
+		bOutSuccess &= Map->SerializeObject(Ar, UItemInstance::StaticClass(), Object);
+		Instance = Cast<UItemInstance>(Object);
+	}
+	else
+	{
+		Instance = nullptr;
+	}
+
+	if (Flags & HasCommodity)
+	{
+		bOutSuccess &= FDefinitionNetIdTable::NetSerializeClass(Ar, Map, CommodityDefinition);
+	}
+	else
+	{
+		CommodityDefinition = nullptr;
+	}
+
+	// Counts and slots are small, usually a single byte each. Identifiers are offset to send INDEX_NONE as zero
+	uint32 PackedStackCount = FMath::Max(StackCount, 0);
+	uint32 PackedEntryId = EntryId + 1;
+	uint32 PackedGeneration = Generation;
+	Ar.SerializeIntPacked(PackedStackCount);
+	Ar.SerializeIntPacked(PackedEntryId);
+	Ar.SerializeIntPacked(PackedGeneration);
+
+	if (Flags & IsPlaced)
+	{
+		Ar << PackedGridPosition;
+	}
+
+	if (Ar.IsLoading())
+	{
+		StackCount = static_cast<int32>(PackedStackCount);
+		EntryId = static_cast<int32>(PackedEntryId) - 1;
+		Generation = static_cast<int32>(PackedGeneration);
+		if (!(Flags & IsPlaced))
+		{
+			PackedGridPosition = MAX_uint16;
+		}
+	}
+	return true;
+}
+
+TSubclassOf<UItemDefinition> FInventoryEntry::GetDefinitionClass() const
+{
+	return IsValid(Instance) ? Instance->GetDefinitionClass() : CommodityDefinition;
 }
@@ -8,5 +8,5 @@
 
 bool FInventoryEntryHandle::IsHandleValid() const
 {
-	return EntryIndex != INDEX_NONE && IsValid(Container);
+	return EntryId != INDEX_NONE && IsValid(Container);
 }
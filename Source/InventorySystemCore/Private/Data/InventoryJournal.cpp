@@ -0,0 +1,352 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Data/InventoryJournal.h"
+
+#include "Containers/InventoryContainer_Grid.h"
+#include "Data/InventoryChangeData.h"
+#include "Data/InventorySnapshotCodec.h"
+#include "Log/InventorySystemLog.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+void FInventoryJournal::RecordChange(const FInventoryChangeData& Change)
+{
+	using namespace InventorySnapshot;
+
+	UInventoryContainer* Container = Change.Container;
+	if (!IsValid(Container))
+	{
+		return;
+	}
+
+	// Writers are opened after the table records, which are appended by their own writer
+	const int32 ContainerIndex = AddContainerName(*Container);
+
+	switch (Change.ChangeType)
+	{
+	case EInventoryChangeType::Added:
+		{
+			const int32 Index = Container->GetInventoryList().FindEntryIndex(FInventoryEntryHandle(Change.EntryId, Change.Instance, Change.NewCount, Container, Change.Generation));
+			if (Index != INDEX_NONE)
+			{
+				WriteEntryRecord(EInventoryJournalRecord::Added, *Container, Index);
+			}
+			break;
+		}
+	case EInventoryChangeType::Modified:
+		{
+			int32 X, Y;
+			bool bRotated;
+			const UInventoryContainer_Grid* Grid = Cast<UInventoryContainer_Grid>(Container);
+			const FInventoryEntryHandle Handle(Change.EntryId, Change.Instance, Change.NewCount, Container, Change.Generation);
+			uint16 PackedPosition = Grid && Grid->GetEntryPosition(Handle, X, Y, bRotated) ? InventoryGrid::PackPosition(X, Y, bRotated) : InventoryGrid::InvalidPosition;
+
+			FMemoryWriter Writer(Data, true, true);
+			BeginRecord(Writer, EInventoryJournalRecord::Changed);
+			WriteCount(Writer, ContainerIndex);
+			WriteCount(Writer, Change.EntryId + 1);
+			WriteCount(Writer, Change.Generation);
+			WriteCount(Writer, Change.NewCount);
+			Writer << PackedPosition;
+			break;
+		}
+	case EInventoryChangeType::Removed:
+		{
+			FMemoryWriter Writer(Data, true, true);
+			BeginRecord(Writer, EInventoryJournalRecord::Removed);
+			WriteCount(Writer, ContainerIndex);
+			WriteCount(Writer, Change.EntryId + 1);
+			WriteCount(Writer, Change.Generation);
+			break;
+		}
+	}
+}
+
+void FInventoryJournal::RecordEntryState(const FInventoryEntryHandle& Handle)
+{
+	UInventoryContainer* Container = Handle.Container;
+	if (!IsValid(Container))
+	{
+		return;
+	}
+
+	const int32 Index = Container->GetInventoryList().FindEntryIndex(Handle);
+	if (Index != INDEX_NONE)
+	{
+		WriteEntryRecord(EInventoryJournalRecord::Captured, *Container, Index);
+	}
+}
+
+void FInventoryJournal::RecordCleared(const UInventoryContainer& Container)
+{
+	using namespace InventorySnapshot;
+
+	const int32 ContainerIndex = AddContainerName(Container);
+	FMemoryWriter Writer(Data, true, true);
+	BeginRecord(Writer, EInventoryJournalRecord::Cleared);
+	WriteCount(Writer, ContainerIndex);
+}
+
+void FInventoryJournal::Reset()
+{
+	Data.Reset();
+	Tables.Reset();
+	CapturedStates.Reset();
+	NumRecords = 0;
+}
+
+void FInventoryJournal::WriteEntryRecord(const EInventoryJournalRecord Type, UInventoryContainer& Container, const int32 Index)
+{
+	using namespace InventorySnapshot;
+
+	const int32 ContainerIndex = AddContainerName(Container);
+
+	// The tables are extended before the record using them
+	const int32 NumDefinitionPaths = Tables.DefinitionPaths.Num();
+	const int32 NumNames = Tables.Names.Num();
+	const int32 NumComponentClassPaths = Tables.ComponentClassPaths.Num();
+	FInventorySnapshotEntry Entry;
+	CapturedStates.Reset();
+	FInventorySnapshot::CaptureEntry(Container.GetInventoryList().MakeHandle(Index), Cast<UInventoryContainer_Grid>(&Container), Tables, CapturedStates, Entry);
+	WriteTableAdditions(NumDefinitionPaths, NumNames, NumComponentClassPaths);
+
+	FMemoryWriter Writer(Data, true, true);
+	BeginRecord(Writer, Type);
+	WriteCount(Writer, ContainerIndex);
+	FInventorySnapshot::WriteEntry(Writer, Entry);
+}
+
+FArchive& FInventoryJournal::BeginRecord(FMemoryWriter& Writer, EInventoryJournalRecord Type)
+{
+	if (Data.IsEmpty())
+	{
+		uint32 JournalMagic = Magic;
+		uint16 JournalVersion = Version;
+		uint16 EntryVersion = static_cast<uint16>(EInventorySnapshotVersion::Latest);
+		Writer << JournalMagic;
+		Writer << JournalVersion;
+		Writer << EntryVersion;
+	}
+
+	uint8 RecordType = static_cast<uint8>(Type);
+	Writer << RecordType;
+	++NumRecords;
+	return Writer;
+}
+
+void FInventoryJournal::WriteTableAdditions(const int32 NumDefinitionPaths, const int32 NumNames, const int32 NumComponentClassPaths)
+{
+	FMemoryWriter Writer(Data, true, true);
+	for (int32 Index = NumDefinitionPaths; Index < Tables.DefinitionPaths.Num(); ++Index)
+	{
+		BeginRecord(Writer, EInventoryJournalRecord::DefinitionPath) << Tables.DefinitionPaths[Index];
+	}
+	for (int32 Index = NumNames; Index < Tables.Names.Num(); ++Index)
+	{
+		BeginRecord(Writer, EInventoryJournalRecord::Name) << Tables.Names[Index];
+	}
+	for (int32 Index = NumComponentClassPaths; Index < Tables.ComponentClassPaths.Num(); ++Index)
+	{
+		BeginRecord(Writer, EInventoryJournalRecord::ComponentClassPath) << Tables.ComponentClassPaths[Index];
+	}
+}
+
+int32 FInventoryJournal::AddContainerName(const UInventoryContainer& Container)
+{
+	const int32 NumNames = Tables.Names.Num();
+	const int32 Index = Tables.AddName(Container.GetContainerTag().GetTagName());
+	WriteTableAdditions(Tables.DefinitionPaths.Num(), NumNames, Tables.ComponentClassPaths.Num());
+	return Index;
+}
+
+bool FInventoryJournal::Fold(FInventorySnapshot& InOutSnapshot, const FMemoryView JournalData)
+{
+	using namespace InventorySnapshot;
+
+	// An empty journal has no header, nothing changed since the checkpoint
+	if (JournalData.IsEmpty())
+	{
+		return true;
+	}
+
+	FMemoryReaderView Reader(JournalData);
+	uint32 JournalMagic = 0;
+	uint16 JournalVersion = 0;
+	uint16 EntryVersion = 0;
+	Reader << JournalMagic;
+	Reader << JournalVersion;
+	Reader << EntryVersion;
+	if (Reader.IsError() || JournalMagic != Magic || JournalVersion > Version
+		|| EntryVersion < static_cast<uint16>(EInventorySnapshotVersion::EntryIds) || EntryVersion > static_cast<uint16>(EInventorySnapshotVersion::Latest))
+	{
+		UE_LOG(LogInventorySystem, Warning, TEXT("Tried to fold data which is not a supported inventory journal."));
+		return false;
+	}
+
+	FInventorySnapshotTables JournalTables;
+	FInventorySnapshotTables& SnapshotTables = InOutSnapshot.Tables;
+	auto FindContainer = [&InOutSnapshot, &JournalTables, &SnapshotTables](const int32 NameIndex) -> FInventorySnapshotContainer&
+	{
+		const int32 TagIndex = SnapshotTables.AddName(JournalTables.Names[NameIndex]);
+		FInventorySnapshotContainer* Container = InOutSnapshot.Containers.FindByPredicate([TagIndex](const FInventorySnapshotContainer& Candidate)
+		{
+			return Candidate.TagIndex == TagIndex;
+		});
+		if (!Container)
+		{
+			Container = &InOutSnapshot.Containers.AddDefaulted_GetRef();
+			Container->TagIndex = TagIndex;
+		}
+		return *Container;
+	};
+	auto FindEntry = [](FInventorySnapshotContainer& Container, const int32 EntryId, const int32 Generation)
+	{
+		return Container.Entries.IndexOfByPredicate([EntryId, Generation](const FInventorySnapshotEntry& Entry)
+		{
+			return Entry.EntryId == EntryId && Entry.Generation == Generation;
+		});
+	};
+
+	int32 NumMissing = 0;
+	while (Reader.Tell() < Reader.TotalSize())
+	{
+		const int64 RecordStart = Reader.Tell();
+		uint8 RecordType = 0;
+		Reader << RecordType;
+
+		int32 ContainerIndex = INDEX_NONE;
+		int32 EncodedEntryId = 0;
+		int32 Generation = 0;
+		switch (static_cast<EInventoryJournalRecord>(RecordType))
+		{
+		case EInventoryJournalRecord::DefinitionPath:
+			{
+				FString Path;
+				Reader << Path;
+				JournalTables.AddDefinitionPath(Path);
+				break;
+			}
+		case EInventoryJournalRecord::Name:
+			{
+				FName Name;
+				Reader << Name;
+				JournalTables.AddName(Name);
+				break;
+			}
+		case EInventoryJournalRecord::ComponentClassPath:
+			{
+				FString Path;
+				Reader << Path;
+				JournalTables.AddComponentClassPath(Path);
+				break;
+			}
+		case EInventoryJournalRecord::Added:
+		case EInventoryJournalRecord::Captured:
+			{
+				FInventorySnapshotEntry Entry;
+				if (!ReadIndex(Reader, JournalTables.Names.Num(), ContainerIndex)
+					|| !FInventorySnapshot::ReadEntry(Reader, JournalData, static_cast<EInventorySnapshotVersion>(EntryVersion), JournalTables, Entry))
+				{
+					break;
+				}
+
+				// Indices of the journal tables are mapped to the ones of the snapshot
+				Entry.DefinitionIndex = SnapshotTables.AddDefinitionPath(JournalTables.DefinitionPaths[Entry.DefinitionIndex]);
+				for (int32& TagIndex : Entry.TagIndices)
+				{
+					TagIndex = SnapshotTables.AddName(JournalTables.Names[TagIndex]);
+				}
+				for (FInventorySnapshotComponent& Component : Entry.Components)
+				{
+					Component.ClassIndex = SnapshotTables.AddComponentClassPath(JournalTables.ComponentClassPaths[Component.ClassIndex]);
+				}
+
+				FInventorySnapshotContainer& Container = FindContainer(ContainerIndex);
+				if (static_cast<EInventoryJournalRecord>(RecordType) == EInventoryJournalRecord::Added)
+				{
+					Container.Entries.Add(MoveTemp(Entry));
+					break;
+				}
+
+				// A captured entry replaces its previous state, in place so that grid positions keep their order
+				const int32 Index = FindEntry(Container, Entry.EntryId, Entry.Generation);
+				if (Index == INDEX_NONE)
+				{
+					++NumMissing;
+					break;
+				}
+				Container.Entries[Index] = MoveTemp(Entry);
+				break;
+			}
+		case EInventoryJournalRecord::Changed:
+			{
+				int32 StackCount = 0;
+				uint16 PackedPosition = InventoryGrid::InvalidPosition;
+				if (!ReadIndex(Reader, JournalTables.Names.Num(), ContainerIndex) || !ReadValue(Reader, EncodedEntryId)
+					|| !ReadValue(Reader, Generation) || !ReadValue(Reader, StackCount))
+				{
+					break;
+				}
+				Reader << PackedPosition;
+
+				FInventorySnapshotContainer& Container = FindContainer(ContainerIndex);
+				const int32 Index = FindEntry(Container, EncodedEntryId - 1, Generation);
+				if (Index == INDEX_NONE || Reader.IsError())
+				{
+					++NumMissing;
+					break;
+				}
+				Container.Entries[Index].StackCount = StackCount;
+				Container.Entries[Index].PackedGridPosition = PackedPosition;
+				break;
+			}
+		case EInventoryJournalRecord::Removed:
+			{
+				if (!ReadIndex(Reader, JournalTables.Names.Num(), ContainerIndex) || !ReadValue(Reader, EncodedEntryId) || !ReadValue(Reader, Generation))
+				{
+					break;
+				}
+
+				FInventorySnapshotContainer& Container = FindContainer(ContainerIndex);
+				const int32 Index = FindEntry(Container, EncodedEntryId - 1, Generation);
+				if (Index == INDEX_NONE)
+				{
+					++NumMissing;
+					break;
+				}
+				Container.Entries.RemoveAt(Index);
+				break;
+			}
+		case EInventoryJournalRecord::Cleared:
+			if (ReadIndex(Reader, JournalTables.Names.Num(), ContainerIndex))
+			{
+				FindContainer(ContainerIndex).Entries.Reset();
+			}
+			break;
+		default:
+			Reader.SetError();
+			break;
+		}
+
+		if (Reader.IsError())
+		{
+			// A crash while appending leaves an incomplete last record, every complete one is kept
+			UE_LOG(LogInventorySystem, Warning, TEXT("Inventory journal is corrupted or truncated at offset %lld, the following records are ignored."), RecordStart);
+			break;
+		}
+	}
+
+	UE_CLOG(NumMissing > 0, LogInventorySystem, Warning, TEXT("%d records of the inventory journal refer to entries missing from the snapshot. Was it started after this checkpoint?"), NumMissing);
+	return true;
+}
+
+bool FInventoryJournal::Compact(const FMemoryView SnapshotData, const FMemoryView JournalData, TArray<uint8>& OutSnapshot)
+{
+	FInventorySnapshot Snapshot;
+	if (!Snapshot.Decode(SnapshotData) || !Fold(Snapshot, JournalData))
+	{
+		return false;
+	}
+	Snapshot.Encode(OutSnapshot);
+	return true;
+}
@@ -3,12 +3,16 @@
 #include "Data/InventoryList.h"
 
 #include "Components/InventorySystemComponent.h"
+#include "Containers/InventoryContainer.h"
 #include "Data/InventoryEntry.h"
 #include "Definitions/Fragments/ItemFragment.h"
 #include "Definitions/Fragments/ItemFragment_Storable.h"
 #include "GameplayTags/InventoryGameplayTags.h"
 #include "Instances/ItemInstance.h"
 #include "Log/InventorySystemLog.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Subsystems/ItemDefinitionRegistry.h"
+#include "Subsystems/ItemInstancePool.h"
 
 FInventoryList::FInventoryList()
 {
@@ -28,9 +32,25 @@ void FInventoryList::PreReplicatedRemove(const TArrayView<int32> RemovedIndices,
 			FInventoryEntry& Entry = Entries[Index];
 			Entry.LastStackCount = 0;
 
+			if (IsValid(OwningComponent))
+			{
+				OwningComponent->UnregisterInstanceContainer(Entry.Instance, OwningContainer);
+			}
+			UnaggregateEntry(Entry);
+			if (OwningContainer)
+			{
+				OwningContainer->PreEntryRemoved(Entry);
+			}
+
 			Internal_OnEntryRemoved(Index, Entry);
 		}
 	}
+
+	// Removed entries are swapped out of the array after this call, invalidating indexed positions
+	if (RemovedIndices.Num() > 0)
+	{
+		bIndexDirty = true;
+	}
 }
 
 void FInventoryList::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize)
@@ -42,6 +62,8 @@ void FInventoryList::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int
 			FInventoryEntry& Entry = Entries[Index];
 			Entry.LastStackCount = Entry.StackCount;
 
+			Internal_TrackEntry(Index);
+
 			Internal_OnEntryAdded(Index, Entry);
 		}
 	}
@@ -56,12 +78,37 @@ void FInventoryList::PostReplicatedChange(const TArrayView<int32> ChangedIndices
 			FInventoryEntry& Entry = Entries[Index];
 			ensureMsgf(Entry.LastStackCount != INDEX_NONE, TEXT("LastStackCount is invalid (INDEX_NONE) for entry at index %d. Should replicate this change" ), Index);
 
+			if (!bIndexDirty)
+			{
+				ReindexEntryCount(Index, Entry.LastStackCount);
+			}
+			ReaggregateEntryCount(Entry);
+			if (OwningContainer)
+			{
+				OwningContainer->PostEntryReplicatedChange(Entry);
+			}
+
+			// The instance may only have been resolved with this change
+			if (IsValid(OwningComponent) && IsValid(Entry.Instance))
+			{
+				OwningComponent->RegisterInstanceContainer(Entry.Instance, OwningContainer);
+			}
+
 			Internal_OnEntryChanged(Index, Entry);
 			Entry.LastStackCount = Entry.StackCount;
 		}
 	}
 }
 
+void FInventoryList::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	// The received state contains the accepted predictions of the client
+	if (IsValid(OwningComponent))
+	{
+		OwningComponent->ReconcilePredictions(OwningContainer);
+	}
+}
+
 FInventoryResult FInventoryList::AddFromDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass, const int32 Count)
 {
 	FInventoryResult Result;
@@ -81,43 +128,76 @@ FInventoryResult FInventoryList::AddFromDefinition(const TSubclassOf<UItemDefini
 	}
 
 	// Check validity of the definition instance, and storable fragments
-	if (!CanAdd(DefinitionClass, Result.FailureReason, Count))
+	if (!CanAddDefinition(DefinitionClass, Result.FailureReason))
 	{
 		return Result;
 	}
 
+	Internal_AddFromDefinition(DefinitionClass, Count, Result);
+	return Result;
+}
+
+void FInventoryList::Internal_AddFromDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass, const int32 Count, FInventoryResult& OutResult)
+{
+	if (!CanAddCount(DefinitionClass, OutResult.FailureReason, Count))
+	{
+		return;
+	}
+	if (OwningContainer && !OwningContainer->ValidateCapacity(DefinitionClass, Count, GetNewStackCount(DefinitionClass, Count), OutResult.FailureReason))
+	{
+		return;
+	}
+
+	const int32 RemainingCount = TopUpStacks(DefinitionClass, Count, OutResult);
+	CreateStacks(DefinitionClass, RemainingCount, OutResult);
+}
+
+int32 FInventoryList::TopUpStacks(const TSubclassOf<UItemDefinition>& DefinitionClass, const int32 Count, FInventoryResult& OutResult)
+{
 	int32 RemainingCount = Count;
 
 	const UItemDefinition* CachedDefinition = OwningComponent->GetCachedDefinition(DefinitionClass);
 	const UItemFragment_Storable* StorableFragment = CachedDefinition->FindFragmentByClass<UItemFragment_Storable>();
 
 	// Handles stacking if the object is stackable
-	if (StorableFragment->CanStack())
+	if (StorableFragment->CanStack() && RemainingCount > 0)
 	{
-		for (int32 Index = 0; Index < Entries.Num() && RemainingCount > 0; ++Index)
+		ConditionalRebuildIndex();
+
+		// Only visit the stacks of this definition. Copied since the index is updated while iterating.
+		TArray<int32, TInlineAllocator<4>> StackIndices;
+		if (const FInventoryDefinitionIndex* Indexed = DefinitionIndex.Find(DefinitionClass))
 		{
-			FInventoryEntry& Entry = Entries[Index];
-			if (Entry.Instance->DefinitionClass != DefinitionClass)
-			{
-				continue;
-			}
+			StackIndices = Indexed->EntryIndices;
+		}
+
+		for (int32 StackIndex = 0; StackIndex < StackIndices.Num() && RemainingCount > 0; ++StackIndex)
+		{
+			const int32 Index = StackIndices[StackIndex];
+			const FInventoryEntry& Entry = Entries[Index];
 
 			const int32 FreeCount = StorableFragment->MaxStackCount - Entry.StackCount;
 			const int32 ToAdd = FMath::Min(RemainingCount, FreeCount);
 
 			if (ToAdd > 0)
 			{
-				Entry.StackCount += ToAdd;
+				SetEntryStackCount(Index, Entry.StackCount + ToAdd);
 				RemainingCount -= ToAdd;
 
-				Internal_OnEntryChanged(Index, Entry);
-				Entry.LastStackCount = Entry.StackCount;
-				MarkItemDirty(Entry);
-
-				Result.Instances.Add(Entry.Instance);
+				if (Entry.Instance)
+				{
+					OutResult.Instances.Add(Entry.Instance);
+				}
 			}
 		}
 	}
+	return RemainingCount;
+}
+
+void FInventoryList::CreateStacks(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 RemainingCount, FInventoryResult& OutResult)
+{
+	const UItemDefinition* CachedDefinition = OwningComponent->GetCachedDefinition(DefinitionClass);
+	const UItemFragment_Storable* StorableFragment = CachedDefinition->FindFragmentByClass<UItemFragment_Storable>();
 
 	// Calculate the number of new stacks required
 	const int32 MaxStackCount = StorableFragment->CanStack() ? StorableFragment->MaxStackCount : 1;
@@ -126,20 +206,115 @@ FInventoryResult FInventoryList::AddFromDefinition(const TSubclassOf<UItemDefini
 	// Create new stacks for the rest
 	for (int32 i = 0; i < NeededStacks && RemainingCount > 0; ++i)
 	{
-		if (!CanAdd(DefinitionClass, Result.FailureReason, RemainingCount))
+		if (!CanAddCount(DefinitionClass, OutResult.FailureReason, RemainingCount))
 		{
 			break;
 		}
 
 		int32 CurrentCount = RemainingCount;
-		if (UItemInstance* NewInstance = CreateItemInstance(DefinitionClass, CurrentCount))
+		if (StorableFragment->IsCommodity())
+		{
+			if (CreateCommodityEntry(DefinitionClass, CurrentCount))
+			{
+				RemainingCount = CurrentCount;
+			}
+		}
+		else if (UItemInstance* NewInstance = CreateItemInstance(DefinitionClass, CurrentCount))
 		{
-			Result.Instances.Add(NewInstance);
+			OutResult.Instances.Add(NewInstance);
 			RemainingCount = CurrentCount;
 		}
 	}
+}
 
-	return Result;
+void FInventoryList::AddFromDefinitions(const TConstArrayView<FInventoryAddRequest> Requests, TArray<FInventoryResult>& OutResults)
+{
+	OutResults.Reset(Requests.Num());
+	OutResults.SetNum(Requests.Num());
+
+	if (!OwningComponent || !OwningComponent->GetOwner()->HasAuthority())
+	{
+		UE_LOG(LogInventorySystem, Warning, TEXT("Tried to add a batch of items without authority."));
+		for (FInventoryResult& Result : OutResults)
+		{
+			Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_NotAuthority;
+		}
+		return;
+	}
+
+	// Failure reason of each distinct definition, empty if valid
+	TMap<TSubclassOf<UItemDefinition>, FGameplayTag, TInlineSetAllocator<8>> ValidatedDefinitions;
+
+	// Requests are planned in the order they are applied, each one topping up the stacks of the previous ones
+	TMap<TSubclassOf<UItemDefinition>, int32> PlannedFreeRoom;
+	TMap<TSubclassOf<UItemDefinition>, int32, TInlineSetAllocator<8>> PlannedNewStacks;
+	TArray<int32, TInlineAllocator<8>> AcceptedIndices;
+	TArray<FInventoryCapacityRequest, TInlineAllocator<8>> CapacityRequests;
+
+	for (int32 RequestIndex = 0; RequestIndex < Requests.Num(); ++RequestIndex)
+	{
+		const FInventoryAddRequest& Request = Requests[RequestIndex];
+		FInventoryResult& Result = OutResults[RequestIndex];
+
+		if (!IsValid(Request.ItemDefinition))
+		{
+			Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidDefinition;
+			continue;
+		}
+		if (Request.Count <= 0)
+		{
+			Result.FailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidCount;
+			continue;
+		}
+
+		const FGameplayTag* DefinitionFailure = ValidatedDefinitions.Find(Request.ItemDefinition);
+		if (!DefinitionFailure)
+		{
+			FGameplayTag FailureReason;
+			CanAddDefinition(Request.ItemDefinition, FailureReason);
+			DefinitionFailure = &ValidatedDefinitions.Add(Request.ItemDefinition, FailureReason);
+		}
+		if (DefinitionFailure->IsValid())
+		{
+			Result.FailureReason = *DefinitionFailure;
+			continue;
+		}
+
+		const int32 NewStacks = PlanNewStacks(Request.ItemDefinition, Request.Count, false, PlannedFreeRoom);
+		PlannedNewStacks.FindOrAdd(Request.ItemDefinition) += NewStacks;
+		AcceptedIndices.Add(RequestIndex);
+		CapacityRequests.Add({Request.ItemDefinition, Request.Count, NewStacks});
+	}
+
+	// Unique definitions are refused along with every request creating one of their stacks
+	for (int32 Accepted = AcceptedIndices.Num() - 1; Accepted >= 0; --Accepted)
+	{
+		const FInventoryAddRequest& Request = Requests[AcceptedIndices[Accepted]];
+		FInventoryResult& Result = OutResults[AcceptedIndices[Accepted]];
+		if (!CanAddStacks(Request.ItemDefinition, PlannedNewStacks[Request.ItemDefinition], Result.FailureReason))
+		{
+			AcceptedIndices.RemoveAt(Accepted);
+			CapacityRequests.RemoveAt(Accepted);
+		}
+	}
+
+	// The remaining requests are stored together or not at all
+	FGameplayTag CapacityFailure;
+	if (OwningContainer && !OwningContainer->ValidateCapacityBatch(CapacityRequests, CapacityFailure))
+	{
+		for (const int32 RequestIndex : AcceptedIndices)
+		{
+			OutResults[RequestIndex].FailureReason = CapacityFailure;
+		}
+		return;
+	}
+
+	for (const int32 RequestIndex : AcceptedIndices)
+	{
+		const FInventoryAddRequest& Request = Requests[RequestIndex];
+		const int32 RemainingCount = TopUpStacks(Request.ItemDefinition, Request.Count, OutResults[RequestIndex]);
+		CreateStacks(Request.ItemDefinition, RemainingCount, OutResults[RequestIndex]);
+	}
 }
 
 FInventoryResult FInventoryList::AddInstance(UItemInstance* ItemInstance, const int32 Count)
@@ -161,33 +336,39 @@ FInventoryResult FInventoryList::AddInstance(UItemInstance* ItemInstance, const
 		}
 	}
 
+	InsertInstance(ItemInstance, Count);
+	Result.Instances.Add(ItemInstance);
+	return Result;
+}
+
+void FInventoryList::InsertInstance(UItemInstance* ItemInstance, const int32 Count)
+{
 	// Creating and configuring the new input
 	FInventoryEntry& NewEntry = Entries.AddDefaulted_GetRef();
 	const int32 NewIndex = Entries.Num() - 1;
 
 	NewEntry.Instance = ItemInstance;
+	NewEntry.OwningContainer = OwningContainer;
 	NewEntry.StackCount = Count;
 	NewEntry.LastStackCount = Count;
 
-	Result.Instances.Add(ItemInstance);
+	Internal_TrackEntry(NewIndex);
 
 	// Notification du changement
 	Internal_OnEntryAdded(NewIndex, NewEntry);
-	MarkItemDirty(NewEntry);
-
-	return Result;
+	MarkEntryDirty(NewEntry);
 }
 
 void FInventoryList::RemoveInstance(UItemInstance* Instance)
 {
-	for (auto EntryIterator = Entries.CreateIterator(); EntryIterator; ++EntryIterator)
+	ConditionalRebuildIndex();
+
+	// Entries locked by a transaction are kept, like the other removal paths
+	if (const int32* Index = InstanceIndex.Find(Instance); Index && !IsEntryLocked(Entries[*Index].EntryId))
 	{
-		if (FInventoryEntry Entry = *EntryIterator; Entry.Instance == Instance)
-		{
-			Internal_OnEntryRemoved(EntryIterator.GetIndex(), Entry);
-			EntryIterator.RemoveCurrent();
-			MarkArrayDirty();
-		}
+		const int32 EntryIndex = *Index;
+		Internal_OnEntryRemoved(EntryIndex, Entries[EntryIndex]);
+		Internal_RemoveEntryAt(EntryIndex);
 	}
 }
 
@@ -199,22 +380,34 @@ bool FInventoryList::RemoveFromHandle(const FInventoryEntryHandle& Handle, FGame
 		return false;
 	}
 
-	if (!Entries.IsValidIndex(Handle.EntryIndex))
+	if (Handle.Container != OwningContainer)
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_HandleMismatch;
+		return false;
+	}
+
+	// Stale handles are detected by the slot table
+	const int32 Index = FindEntryIndex(Handle);
+	if (Index == INDEX_NONE)
 	{
 		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
 		return false;
 	}
 
-	const FInventoryEntry& Entry = Entries[Handle.EntryIndex];
+	const FInventoryEntry& Entry = Entries[Index];
 	if (Entry.Instance != Handle.ItemInstance)
 	{
 		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_HandleMismatch;
 		return false;
 	}
+	if (IsEntryLocked(Entry.EntryId))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Locked;
+		return false;
+	}
 
-	Internal_OnEntryRemoved(Handle.EntryIndex, Entry);
-	Entries.RemoveAt(Handle.EntryIndex);
-	MarkArrayDirty();
+	Internal_OnEntryRemoved(Index, Entry);
+	Internal_RemoveEntryAt(Index);
 
 	OutFailureReason = FGameplayTag::EmptyTag;
 	return true;
@@ -227,10 +420,14 @@ bool FInventoryList::RemoveFromIndex(const int32 Index, FGameplayTag& OutFailure
 		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidIndex;
 		return false;
 	}
+	if (IsEntryLocked(Entries[Index].EntryId))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Locked;
+		return false;
+	}
 
 	Internal_OnEntryRemoved(Index, Entries[Index]);
-	Entries.RemoveAt(Index);
-	MarkArrayDirty();
+	Internal_RemoveEntryAt(Index);
 	return true;
 }
 
@@ -240,8 +437,29 @@ FInventoryEntryHandle FInventoryList::MakeHandle(const int32 Index) const
 	{
 		return FInventoryEntryHandle();
 	}
-	const FInventoryEntry& Entry = Entries[Index];
-	return FInventoryEntryHandle(Index, Entry.Instance, Entry.StackCount, OwningContainer);
+	return FInventoryEntryHandle(Entries[Index], OwningContainer);
+}
+
+int32 FInventoryList::FindEntryIndex(const FInventoryEntryHandle& Handle) const
+{
+	if (Handle.EntryId == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	ConditionalRebuildIndex();
+
+	if (!Slots.IsValidIndex(Handle.EntryId))
+	{
+		return INDEX_NONE;
+	}
+
+	const FInventoryEntrySlot& Slot = Slots[Handle.EntryId];
+	if (Slot.Generation != Handle.Generation || !Entries.IsValidIndex(Slot.EntryIndex))
+	{
+		return INDEX_NONE;
+	}
+	return Slot.EntryIndex;
 }
 
 FInventoryEntryHandle FInventoryList::FindHandleFromInstance(UItemInstance* Instance) const
@@ -249,13 +467,11 @@ FInventoryEntryHandle FInventoryList::FindHandleFromInstance(UItemInstance* Inst
 	FInventoryEntryHandle Handle;
 	if (IsValid(Instance))
 	{
-		for (int32 Index = 0; Index < Entries.Num(); ++Index)
+		ConditionalRebuildIndex();
+
+		if (const int32* Index = InstanceIndex.Find(Instance))
 		{
-			if (const FInventoryEntry& Entry = Entries[Index]; Entry.Instance == Instance)
-			{
-				Handle = FInventoryEntryHandle(Index, Entry);
-				break;
-			}
+			Handle = FInventoryEntryHandle(Entries[*Index], OwningContainer);
 		}
 	}
 	return Handle;
@@ -263,12 +479,11 @@ FInventoryEntryHandle FInventoryList::FindHandleFromInstance(UItemInstance* Inst
 
 FInventoryEntryHandle FInventoryList::FindHandleOfType(const TSubclassOf<UItemDefinition>& ItemDefinition)
 {
-	for (int Index = 0; Index < Entries.Num(); ++Index)
+	ConditionalRebuildIndex();
+
+	if (const FInventoryDefinitionIndex* Indexed = DefinitionIndex.Find(ItemDefinition); Indexed && Indexed->EntryIndices.Num() > 0)
 	{
-		if (const FInventoryEntry& Entry = Entries[Index]; IsValid(Entry.Instance) && Entry.Instance->GetDefinitionClass() == ItemDefinition)
-		{
-			return FInventoryEntryHandle(Index, Entry);
-		}
+		return FInventoryEntryHandle(Entries[Indexed->EntryIndices[0]], OwningContainer);
 	}
 	return {};
 }
@@ -282,9 +497,9 @@ TArray<FInventoryEntryHandle> FInventoryList::GetAllHandles() const
 
 	for (int32 Index = 0; Index < Entries.Num(); ++Index)
 	{
-		if (const FInventoryEntry& Entry = Entries[Index]; IsValid(Entry.Instance))
+		if (const FInventoryEntry& Entry = Entries[Index]; IsValid(Entry.Instance) || Entry.IsCommodity())
 		{
-			FInventoryEntryHandle Handle = FInventoryEntryHandle(Index, Entry);
+			FInventoryEntryHandle Handle = FInventoryEntryHandle(Entry, OwningContainer);
 			Handles.Add(Handle);
 		}
 	}
@@ -300,12 +515,45 @@ TArray<FInventoryEntryHandle> FInventoryList::GetHandlesOfType(const TSubclassOf
 		return Handles;
 	}
 
-	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	ConditionalRebuildIndex();
+
+	// Only visits the distinct stored definitions, then the entries of the matching ones
+	TArray<int32> Indices;
+	for (const TPair<TSubclassOf<UItemDefinition>, FInventoryDefinitionIndex>& Pair : DefinitionIndex)
 	{
-		if (const FInventoryEntry& Entry = Entries[Index]; IsValid(Entry.Instance) && Entry.Instance->GetDefinitionClass()->IsInA(ItemDefinition))
+		if (Pair.Key && Pair.Key->IsChildOf(ItemDefinition))
 		{
-			FInventoryEntryHandle Handle = FInventoryEntryHandle(Index, Entry);
-			Handles.Add(Handle);
+			Indices.Append(Pair.Value.EntryIndices);
+		}
+	}
+
+	// The index is unordered, callers get the entries in list order as before it existed
+	Indices.Sort();
+	Handles.Reserve(Indices.Num());
+	for (const int32 Index : Indices)
+	{
+		Handles.Emplace(Entries[Index], OwningContainer);
+	}
+	return Handles;
+}
+
+TArray<FInventoryEntryHandle> FInventoryList::GetHandlesByTag(const FGameplayTag& Tag) const
+{
+	TArray<FInventoryEntryHandle> Handles = {};
+
+	// The tag index is maintained along with the aggregates, including their pending entries
+	GetAggregates();
+	ConditionalRebuildIndex();
+
+	if (const TSet<int32>* EntryIds = TagIndex.Find(Tag))
+	{
+		Handles.Reserve(EntryIds->Num());
+		for (const int32 EntryId : *EntryIds)
+		{
+			if (Slots.IsValidIndex(EntryId) && Entries.IsValidIndex(Slots[EntryId].EntryIndex))
+			{
+				Handles.Emplace(Entries[Slots[EntryId].EntryIndex], OwningContainer);
+			}
 		}
 	}
 	return Handles;
@@ -334,7 +582,8 @@ FInventoryEntry* FInventoryList::FindEntryOfType(const TSubclassOf<UItemDefiniti
 
 	return Entries.FindByPredicate([ItemDefinition](const FInventoryEntry& Entry)
 	{
-		return Entry.Instance->GetDefinitionClass()->IsInA(ItemDefinition);
+		const TSubclassOf<UItemDefinition> EntryDefinition = Entry.GetDefinitionClass();
+		return EntryDefinition && EntryDefinition->IsChildOf(ItemDefinition);
 	});
 }
 
@@ -347,11 +596,16 @@ TArray<FInventoryEntry*> FInventoryList::GetEntriesOfType(const TSubclassOf<UIte
 		return InventoryEntries;
 	}
 
-	for (FInventoryEntry& Entry : Entries)
+	ConditionalRebuildIndex();
+
+	for (const TPair<TSubclassOf<UItemDefinition>, FInventoryDefinitionIndex>& Pair : DefinitionIndex)
 	{
-		if (IsValid(Entry.Instance) && Entry.Instance->GetDefinitionClass()->IsInA(ItemDefinition))
+		if (Pair.Key && Pair.Key->IsChildOf(ItemDefinition))
 		{
-			InventoryEntries.Add(&Entry);
+			for (const int32 Index : Pair.Value.EntryIndices)
+			{
+				InventoryEntries.Add(&Entries[Index]);
+			}
 		}
 	}
 	return InventoryEntries;
@@ -359,28 +613,135 @@ TArray<FInventoryEntry*> FInventoryList::GetEntriesOfType(const TSubclassOf<UIte
 
 int32 FInventoryList::GetStackCountByDefinition(const TSubclassOf<UItemDefinition>& ItemDefinitionClass) const
 {
-	int32 Count = 0;
-	for (const FInventoryEntry& Entry : Entries)
+	ConditionalRebuildIndex();
+
+	const FInventoryDefinitionIndex* Indexed = DefinitionIndex.Find(ItemDefinitionClass);
+	return Indexed ? Indexed->EntryIndices.Num() : 0;
+}
+
+int32 FInventoryList::GetTotalCountByDefinition(const TSubclassOf<UItemDefinition>& ItemDefinitionClass) const
+{
+	ConditionalRebuildIndex();
+
+	const FInventoryDefinitionIndex* Indexed = DefinitionIndex.Find(ItemDefinitionClass);
+	return Indexed ? Indexed->TotalCount : 0;
+}
+
+const FInventoryAggregates& FInventoryList::GetAggregates() const
+{
+	// Picks up the replicated entries whose definition has been resolved since they were received
+	if (bAggregatesPending)
 	{
-		if (Entry.Instance && Entry.Instance->GetDefinitionClass() == ItemDefinitionClass)
+		bAggregatesPending = false;
+		for (const FInventoryEntry& Entry : Entries)
 		{
-			++Count;
+			AggregateEntry(Entry);
 		}
 	}
-	return Count;
+	return Aggregates;
 }
 
-int32 FInventoryList::GetTotalCountByDefinition(const TSubclassOf<UItemDefinition>& ItemDefinitionClass) const
+int32 FInventoryList::GetNewStackCount(const TSubclassOf<UItemDefinition>& DefinitionClass, const int32 Count) const
+{
+	const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(DefinitionClass);
+	const UItemFragment_Storable* StorableFragment = Definition ? Definition->FindFragmentByClass<UItemFragment_Storable>() : nullptr;
+	if (!IsValid(StorableFragment) || Count <= 0)
+	{
+		return 0;
+	}
+	if (!StorableFragment->CanStack())
+	{
+		return Count;
+	}
+	return FMath::DivideAndRoundUp(FMath::Max(Count - GetFreeStackRoom(DefinitionClass), 0), StorableFragment->MaxStackCount);
+}
+
+int32 FInventoryList::GetFreeStackRoom(const TSubclassOf<UItemDefinition>& DefinitionClass) const
+{
+	const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(DefinitionClass);
+	const UItemFragment_Storable* StorableFragment = Definition ? Definition->FindFragmentByClass<UItemFragment_Storable>() : nullptr;
+	if (!IsValid(StorableFragment) || !StorableFragment->CanStack())
+	{
+		return 0;
+	}
+
+	ConditionalRebuildIndex();
+
+	const FInventoryDefinitionIndex* Indexed = DefinitionIndex.Find(DefinitionClass);
+	return Indexed ? FMath::Max(Indexed->EntryIndices.Num() * StorableFragment->MaxStackCount - Indexed->TotalCount, 0) : 0;
+}
+
+int32 FInventoryList::PlanNewStacks(const TSubclassOf<UItemDefinition>& DefinitionClass, const int32 Count, const bool bOwnStack, TMap<TSubclassOf<UItemDefinition>, int32>& PlannedFreeRoom) const
+{
+	const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(DefinitionClass);
+	const UItemFragment_Storable* StorableFragment = Definition ? Definition->FindFragmentByClass<UItemFragment_Storable>() : nullptr;
+	if (!IsValid(StorableFragment) || Count <= 0)
+	{
+		return 0;
+	}
+	if (!StorableFragment->CanStack())
+	{
+		return bOwnStack ? 1 : Count;
+	}
+
+	int32* FreeRoom = PlannedFreeRoom.Find(DefinitionClass);
+	if (!FreeRoom)
+	{
+		FreeRoom = &PlannedFreeRoom.Add(DefinitionClass, GetFreeStackRoom(DefinitionClass));
+	}
+
+	// A stack kept whole can still be topped up by the next additions
+	if (bOwnStack)
+	{
+		*FreeRoom += FMath::Max(StorableFragment->MaxStackCount - Count, 0);
+		return 1;
+	}
+
+	const int32 ToppedUp = FMath::Min(Count, *FreeRoom);
+	const int32 RemainingCount = Count - ToppedUp;
+	const int32 NewStacks = FMath::DivideAndRoundUp(RemainingCount, StorableFragment->MaxStackCount);
+	*FreeRoom += NewStacks * StorableFragment->MaxStackCount - RemainingCount - ToppedUp;
+	return NewStacks;
+}
+
+bool FInventoryList::CanAddStacks(const TSubclassOf<UItemDefinition>& DefinitionClass, const int32 NewStacks, FGameplayTag& OutFailureReason) const
+{
+	const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(DefinitionClass);
+	const UItemFragment_Storable* StorableFragment = Definition ? Definition->FindFragmentByClass<UItemFragment_Storable>() : nullptr;
+	if (IsValid(StorableFragment) && StorableFragment->IsUnique() && NewStacks > 0 && GetStackCountByDefinition(DefinitionClass) + NewStacks > 1)
+	{
+		UE_LOG(LogInventorySystem, Warning, TEXT("Tried to store several stacks of the unique item %s."), *GetNameSafe(Definition));
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Uniqueness;
+		return false;
+	}
+	return true;
+}
+
+void FInventoryList::Empty()
 {
-	int32 Total = 0;
-	for (const FInventoryEntry& Entry : Entries)
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
 	{
-		if (Entry.Instance && Entry.Instance->GetDefinitionClass() == ItemDefinitionClass)
+		if (IsValid(OwningComponent))
 		{
-			Total += Entry.StackCount;
+			OwningComponent->UnregisterInstanceContainer(Entries[Index].Instance, OwningContainer);
 		}
+		UnaggregateEntry(Entries[Index]);
+		if (OwningContainer)
+		{
+			OwningContainer->PreEntryRemoved(Entries[Index]);
+		}
+		ReleaseEntrySlot(Index);
 	}
-	return Total;
+
+	Entries.Empty();
+	DefinitionIndex.Empty();
+	InstanceIndex.Empty();
+	bIndexDirty = false;
+	Aggregates = FInventoryAggregates();
+	bAggregatesPending = false;
+	TagIndex.Empty();
+	LockedEntries.Empty();
+	MarkListDirty();
 }
 
 void FInventoryList::SetOwningComponent(UInventorySystemComponent* Component)
@@ -411,29 +772,66 @@ UItemInstance* FInventoryList::CreateItemInstance(const TSubclassOf<UItemDefinit
 
 	// Create a new entry
 	FInventoryEntry& Entry = Entries.AddDefaulted_GetRef();
-	const int32 Index = Entries.Num();
+	const int32 Index = Entries.Num() - 1;
 
-	Entry.Instance = NewObject<UItemInstance>(OwnerActor);
-	Entry.Instance->SetDefinition(CachedDefinition);
+	Entry.Instance = UItemInstancePool::AcquireInstance(OwnerActor, UItemInstance::StaticClass());
+	Entry.Instance->Initialize(CachedDefinition);
 	Entry.OwningContainer = OwningContainer;
 	Entry.StackCount = StorableFragment->CanStack() ? FMath::Min(Count, StorableFragment->MaxStackCount) : 1;
 	Count -= Entry.StackCount;
 
-	for (auto Fragment : CachedDefinition->Fragments)
-	{
-		if (IsValid(Fragment))
-		{
-			Fragment->OnInstanceCreated(Entry.Instance);
-		}
-	}
+	Internal_TrackEntry(Index);
 
 	Internal_OnEntryAdded(Index, Entry);
-	MarkItemDirty(Entry);
+	MarkEntryDirty(Entry);
 
 	return Entry.Instance;
 }
 
+bool FInventoryList::CreateCommodityEntry(const TSubclassOf<UItemDefinition>& DefinitionClass, int32& Count)
+{
+	if (!OwningComponent->GetOwner()->HasAuthority())
+	{
+		return false;
+	}
+
+	const UItemDefinition* CachedDefinition = OwningComponent->GetCachedDefinition(DefinitionClass);
+	const UItemFragment_Storable* StorableFragment = CachedDefinition->FindFragmentByClass<UItemFragment_Storable>();
+	if (!IsValid(StorableFragment))
+	{
+		return false;
+	}
+
+	const int32 StackCount = FMath::Min(Count, StorableFragment->MaxStackCount);
+	InsertCommodity(DefinitionClass, StackCount);
+	Count -= StackCount;
+	return true;
+}
+
+int32 FInventoryList::InsertCommodity(const TSubclassOf<UItemDefinition>& DefinitionClass, const int32 Count)
+{
+	// The entry only holds the definition and the count, no item instance nor subobject to replicate
+	FInventoryEntry& Entry = Entries.AddDefaulted_GetRef();
+	const int32 Index = Entries.Num() - 1;
+
+	Entry.CommodityDefinition = DefinitionClass;
+	Entry.OwningContainer = OwningContainer;
+	Entry.StackCount = Count;
+	Entry.LastStackCount = Count;
+
+	Internal_TrackEntry(Index);
+
+	Internal_OnEntryAdded(Index, Entry);
+	MarkEntryDirty(Entry);
+	return Index;
+}
+
 bool FInventoryList::CanAdd(const TSubclassOf<UItemDefinition>& DefinitionClass, FGameplayTag& OutFailureReason, const int32 InCount)
+{
+	return CanAddDefinition(DefinitionClass, OutFailureReason) && CanAddCount(DefinitionClass, OutFailureReason, InCount);
+}
+
+bool FInventoryList::CanAddDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass, FGameplayTag& OutFailureReason)
 {
 	UItemDefinition* CachedDefinition = OwningComponent->GetCachedDefinition(DefinitionClass);
 	if (!IsValid(CachedDefinition))
@@ -461,6 +859,13 @@ bool FInventoryList::CanAdd(const TSubclassOf<UItemDefinition>& DefinitionClass,
 		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_NotStorable;
 		return false;
 	}
+	return true;
+}
+
+bool FInventoryList::CanAddCount(const TSubclassOf<UItemDefinition>& DefinitionClass, FGameplayTag& OutFailureReason, const int32 InCount)
+{
+	const UItemDefinition* CachedDefinition = OwningComponent->GetCachedDefinition(DefinitionClass);
+	const UItemFragment_Storable* StorableFragment = CachedDefinition->FindFragmentByClass<UItemFragment_Storable>();
 
 	// Check if the object is unique
 	if (StorableFragment->IsUnique())
@@ -481,17 +886,33 @@ bool FInventoryList::CanAdd(const TSubclassOf<UItemDefinition>& DefinitionClass,
 	return true;
 }
 
+void FInventoryList::SetEntryStackCount(const int32 Index, const int32 NewCount)
+{
+	FInventoryEntry& Entry = Entries[Index];
+	const int32 OldCount = Entry.StackCount;
+	Entry.StackCount = NewCount;
+	ReindexEntryCount(Index, OldCount);
+	ReaggregateEntryCount(Entry);
+
+	Internal_OnEntryChanged(Index, Entry);
+	Entry.LastStackCount = Entry.StackCount;
+	MarkEntryDirty(Entry);
+}
+
 void FInventoryList::Internal_OnEntryChanged(const int32 Index, const FInventoryEntry& Entry) const
 {
 	FInventoryChangeData Data;
 	Data.Index = Index;
 	Data.Instance = Entry.Instance;
+	Data.DefinitionClass = Entry.GetDefinitionClass();
+	Data.EntryId = Entry.EntryId;
+	Data.Generation = Entry.Generation;
+	Data.Container = OwningContainer;
 	Data.ChangeType = EInventoryChangeType::Modified;
 	Data.OldCount = Entry.LastStackCount;
 	Data.NewCount = Entry.StackCount;
 
-	OwningComponent->PostInventoryEntryChanged(Data);
-	OwningComponent->PostInventoryChanged(Data);
+	OwningComponent->DispatchInventoryChange(Data);
 }
 
 void FInventoryList::Internal_OnEntryAdded(const int32 Index, const FInventoryEntry& Entry) const
@@ -499,12 +920,15 @@ void FInventoryList::Internal_OnEntryAdded(const int32 Index, const FInventoryEn
 	FInventoryChangeData Data;
 	Data.Index = Index;
 	Data.Instance = Entry.Instance;
+	Data.DefinitionClass = Entry.GetDefinitionClass();
+	Data.EntryId = Entry.EntryId;
+	Data.Generation = Entry.Generation;
+	Data.Container = OwningContainer;
 	Data.ChangeType = EInventoryChangeType::Added;
 	Data.OldCount = Entry.LastStackCount;
 	Data.NewCount = Entry.StackCount;
 
-	OwningComponent->PostInventoryEntryAdded(Data);
-	OwningComponent->PostInventoryChanged(Data);
+	OwningComponent->DispatchInventoryChange(Data);
 }
 
 void FInventoryList::Internal_OnEntryRemoved(const int32 Index, const FInventoryEntry& Entry) const
@@ -512,10 +936,393 @@ void FInventoryList::Internal_OnEntryRemoved(const int32 Index, const FInventory
 	FInventoryChangeData Data;
 	Data.Index = Index;
 	Data.Instance = Entry.Instance;
+	Data.DefinitionClass = Entry.GetDefinitionClass();
+	Data.EntryId = Entry.EntryId;
+	Data.Generation = Entry.Generation;
+	Data.Container = OwningContainer;
 	Data.ChangeType = EInventoryChangeType::Removed;
 	Data.OldCount = Entry.LastStackCount;
 	Data.NewCount = Entry.StackCount;
 
-	OwningComponent->PostInventoryEntryRemoved(Data);
-	OwningComponent->PostInventoryChanged(Data);
+	OwningComponent->DispatchInventoryChange(Data);
+}
+
+void FInventoryList::Internal_TrackEntry(const int32 Index)
+{
+	// Entries added on authority get their slot here, replicated entries already carry it
+	if (Entries[Index].EntryId == INDEX_NONE)
+	{
+		AllocateEntrySlot(Index);
+	}
+
+	// A dirty index is rebuilt from the entries on the next query, no need to maintain it
+	if (!bIndexDirty && !IndexEntry(Index))
+	{
+		bIndexDirty = true;
+	}
+	AggregateEntry(Entries[Index]);
+
+	if (OwningContainer)
+	{
+		OwningContainer->PostEntryAdded(Entries[Index]);
+	}
+
+	if (const FInventoryEntry& Entry = Entries[Index]; IsValid(OwningComponent) && IsValid(Entry.Instance))
+	{
+		OwningComponent->RegisterInstanceContainer(Entry.Instance, OwningContainer);
+	}
+}
+
+void FInventoryList::MarkEntryDirty(FInventoryEntry& Entry)
+{
+	MarkItemDirty(Entry);
+	MarkOwnerDirty();
+}
+
+void FInventoryList::MarkListDirty()
+{
+	MarkArrayDirty();
+	MarkOwnerDirty();
+}
+
+void FInventoryList::MarkOwnerDirty() const
+{
+	// The list is only compared for replication once its owner has been dirtied
+	if (OwningContainer)
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(UInventoryContainer, InventoryList, OwningContainer);
+	}
+	if (IsValid(OwningComponent))
+	{
+		OwningComponent->WakeDormantOwner();
+	}
+}
+
+void FInventoryList::Internal_RemoveEntryAt(const int32 Index)
+{
+	if (IsValid(OwningComponent))
+	{
+		OwningComponent->UnregisterInstanceContainer(Entries[Index].Instance, OwningContainer);
+	}
+
+	ReleaseEntrySlot(Index);
+	UnaggregateEntry(Entries[Index]);
+	if (OwningContainer)
+	{
+		OwningContainer->PreEntryRemoved(Entries[Index]);
+	}
+
+	// A dirty index is rebuilt from the entries on the next query, no need to maintain it
+	if (!bIndexDirty)
+	{
+		UnindexEntry(Index);
+
+		// The last entry takes the place of the removed one
+		if (const int32 LastIndex = Entries.Num() - 1; LastIndex != Index)
+		{
+			RelocateEntryIndex(LastIndex, Index);
+		}
+	}
+
+	Entries.RemoveAtSwap(Index);
+	MarkListDirty();
+}
+
+bool FInventoryList::ReserveEntrySlot(const int32 EntryId, const int32 Generation)
+{
+	ConditionalRebuildIndex();
+
+	ReservedEntryId = INDEX_NONE;
+	if (EntryId < 0 || Generation < 0 || (Slots.IsValidIndex(EntryId) && Slots[EntryId].EntryIndex != INDEX_NONE))
+	{
+		return false;
+	}
+
+	ReservedEntryId = EntryId;
+	ReservedGeneration = Generation;
+	return true;
+}
+
+void FInventoryList::AllocateEntrySlot(const int32 Index)
+{
+	int32 EntryId;
+	if (ReservedEntryId != INDEX_NONE)
+	{
+		EntryId = ReservedEntryId;
+		ReservedEntryId = INDEX_NONE;
+
+		// Slots skipped up to the reserved one are free
+		for (int32 SkippedId = Slots.Num(); SkippedId < EntryId; ++SkippedId)
+		{
+			FreeSlots.Add(SkippedId);
+		}
+		if (Slots.IsValidIndex(EntryId))
+		{
+			FreeSlots.RemoveSingle(EntryId);
+		}
+		else
+		{
+			Slots.SetNum(EntryId + 1);
+		}
+		Slots[EntryId].Generation = ReservedGeneration;
+	}
+	else
+	{
+		EntryId = FreeSlots.Num() > 0 ? FreeSlots.Pop(EAllowShrinking::No) : Slots.AddDefaulted();
+	}
+
+	FInventoryEntrySlot& Slot = Slots[EntryId];
+	Slot.EntryIndex = Index;
+
+	FInventoryEntry& Entry = Entries[Index];
+	Entry.EntryId = EntryId;
+	Entry.Generation = Slot.Generation;
+}
+
+void FInventoryList::ReleaseEntrySlot(const int32 Index)
+{
+	const int32 EntryId = Entries[Index].EntryId;
+	if (!Slots.IsValidIndex(EntryId))
+	{
+		return;
+	}
+
+	FInventoryEntrySlot& Slot = Slots[EntryId];
+	Slot.EntryIndex = INDEX_NONE;
+	++Slot.Generation;
+	FreeSlots.Add(EntryId);
+}
+
+bool FInventoryList::IndexEntry(const int32 Index) const
+{
+	const FInventoryEntry& Entry = Entries[Index];
+
+	// The slot does not depend on the instance, so it is resolved even for entries replicated before their instance
+	if (Entry.EntryId != INDEX_NONE)
+	{
+		if (!Slots.IsValidIndex(Entry.EntryId))
+		{
+			Slots.SetNum(Entry.EntryId + 1);
+		}
+		Slots[Entry.EntryId].EntryIndex = Index;
+		Slots[Entry.EntryId].Generation = Entry.Generation;
+	}
+
+	const TSubclassOf<UItemDefinition> DefinitionClass = Entry.GetDefinitionClass();
+	if (!DefinitionClass)
+	{
+		return false;
+	}
+
+	FInventoryDefinitionIndex& Indexed = DefinitionIndex.FindOrAdd(DefinitionClass);
+	Indexed.EntryIndices.Add(Index);
+	Indexed.TotalCount += Entry.StackCount;
+
+	if (Entry.Instance)
+	{
+		InstanceIndex.Add(Entry.Instance.Get(), Index);
+	}
+	return true;
+}
+
+void FInventoryList::UnindexEntry(const int32 Index) const
+{
+	const FInventoryEntry& Entry = Entries[Index];
+	InstanceIndex.Remove(Entry.Instance.Get());
+
+	if (Slots.IsValidIndex(Entry.EntryId) && Slots[Entry.EntryId].EntryIndex == Index)
+	{
+		Slots[Entry.EntryId].EntryIndex = INDEX_NONE;
+	}
+
+	const TSubclassOf<UItemDefinition> DefinitionClass = Entry.GetDefinitionClass();
+	if (FInventoryDefinitionIndex* Indexed = DefinitionIndex.Find(DefinitionClass))
+	{
+		if (Indexed->EntryIndices.Remove(Index) > 0)
+		{
+			Indexed->TotalCount -= Entry.StackCount;
+		}
+		if (Indexed->EntryIndices.IsEmpty())
+		{
+			DefinitionIndex.Remove(DefinitionClass);
+		}
+	}
+}
+
+void FInventoryList::ReindexEntryCount(const int32 Index, const int32 OldCount) const
+{
+	const FInventoryEntry& Entry = Entries[Index];
+	if (FInventoryDefinitionIndex* Indexed = DefinitionIndex.Find(Entry.GetDefinitionClass()))
+	{
+		Indexed->TotalCount += Entry.StackCount - FMath::Max(OldCount, 0);
+	}
+}
+
+void FInventoryList::RelocateEntryIndex(const int32 FromIndex, const int32 ToIndex) const
+{
+	const FInventoryEntry& Entry = Entries[FromIndex];
+
+	if (FInventoryDefinitionIndex* Indexed = DefinitionIndex.Find(Entry.GetDefinitionClass()))
+	{
+		if (const int32 Position = Indexed->EntryIndices.Find(FromIndex); Position != INDEX_NONE)
+		{
+			Indexed->EntryIndices[Position] = ToIndex;
+		}
+	}
+	if (int32* InstanceEntryIndex = InstanceIndex.Find(Entry.Instance.Get()))
+	{
+		*InstanceEntryIndex = ToIndex;
+	}
+	if (Slots.IsValidIndex(Entry.EntryId))
+	{
+		Slots[Entry.EntryId].EntryIndex = ToIndex;
+	}
+}
+
+void FInventoryList::AggregateEntry(const FInventoryEntry& Entry) const
+{
+	if (Entry.AggregatedCount != INDEX_NONE)
+	{
+		return;
+	}
+
+	const TSubclassOf<UItemDefinition> DefinitionClass = Entry.GetDefinitionClass();
+	if (!DefinitionClass)
+	{
+		bAggregatesPending = true;
+		return;
+	}
+
+	Entry.AggregatedCount = Entry.StackCount;
+	Entry.AggregatedDefinition = DefinitionClass;
+	ApplyAggregateDelta(DefinitionClass, 1, Entry.StackCount);
+	UpdateTagIndex(Entry.EntryId, DefinitionClass, true);
+
+	if (OwningContainer)
+	{
+		OwningContainer->NotifyViewsEntryAdded(Entry);
+	}
+}
+
+void FInventoryList::UnaggregateEntry(const FInventoryEntry& Entry) const
+{
+	if (Entry.AggregatedCount == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (OwningContainer)
+	{
+		OwningContainer->NotifyViewsEntryRemoved(Entry);
+	}
+
+	// The accounted definition is kept, the instance may already be gone on clients
+	ApplyAggregateDelta(Entry.AggregatedDefinition, -1, -Entry.AggregatedCount);
+	UpdateTagIndex(Entry.EntryId, Entry.AggregatedDefinition, false);
+	Entry.AggregatedCount = INDEX_NONE;
+	Entry.AggregatedDefinition = nullptr;
+}
+
+void FInventoryList::ReaggregateEntryCount(const FInventoryEntry& Entry) const
+{
+	if (Entry.AggregatedCount == INDEX_NONE)
+	{
+		AggregateEntry(Entry);
+		return;
+	}
+
+	if (const int32 CountDelta = Entry.StackCount - Entry.AggregatedCount; CountDelta != 0)
+	{
+		ApplyAggregateDelta(Entry.AggregatedDefinition, 0, CountDelta);
+		Entry.AggregatedCount = Entry.StackCount;
+
+		if (OwningContainer)
+		{
+			OwningContainer->NotifyViewsEntryChanged(Entry);
+		}
+	}
+}
+
+void FInventoryList::UpdateTagIndex(const int32 EntryId, const TSubclassOf<UItemDefinition>& DefinitionClass, const bool bAdd) const
+{
+	const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(DefinitionClass);
+	if (!Definition || EntryId == INDEX_NONE)
+	{
+		return;
+	}
+
+	for (const FGameplayTag& Tag : Definition->GetTagsWithParents())
+	{
+		if (bAdd)
+		{
+			TagIndex.FindOrAdd(Tag).Add(EntryId);
+		}
+		else if (TSet<int32>* EntryIds = TagIndex.Find(Tag))
+		{
+			EntryIds->Remove(EntryId);
+			if (EntryIds->IsEmpty())
+			{
+				TagIndex.Remove(Tag);
+			}
+		}
+	}
+}
+
+void FInventoryList::ApplyAggregateDelta(const TSubclassOf<UItemDefinition>& DefinitionClass, const int32 StackDelta, const int32 CountDelta) const
+{
+	Aggregates.OccupiedStacks += StackDelta;
+
+	if (const UItemDefinition* Definition = UItemDefinitionRegistry::ResolveDefinition(DefinitionClass))
+	{
+		if (const UItemFragment_Storable* StorableFragment = Definition->FindFragmentByClass<UItemFragment_Storable>())
+		{
+			Aggregates.TotalWeight += StorableFragment->Weight * CountDelta;
+		}
+
+		for (const FGameplayTag& Tag : Definition->GetTagsWithParents())
+		{
+			int32& TagCount = Aggregates.TagCounts.FindOrAdd(Tag);
+			TagCount += CountDelta;
+			if (TagCount <= 0)
+			{
+				Aggregates.TagCounts.Remove(Tag);
+			}
+		}
+	}
+
+	// Avoids accumulating floating point drift over long sessions
+	if (Aggregates.OccupiedStacks <= 0)
+	{
+		Aggregates.TotalWeight = 0.f;
+	}
+}
+
+void FInventoryList::ConditionalRebuildIndex() const
+{
+	if (bIndexDirty)
+	{
+		RebuildIndex();
+	}
+}
+
+void FInventoryList::RebuildIndex() const
+{
+	DefinitionIndex.Reset();
+	InstanceIndex.Reset();
+	bIndexDirty = false;
+
+	// Generations are kept, so that handles to removed entries stay stale
+	for (FInventoryEntrySlot& Slot : Slots)
+	{
+		Slot.EntryIndex = INDEX_NONE;
+	}
+
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		// Keep the index dirty while some replicated instances are still unresolved, so they get picked up later
+		if (!IndexEntry(Index))
+		{
+			bIndexDirty = true;
+		}
+	}
 }
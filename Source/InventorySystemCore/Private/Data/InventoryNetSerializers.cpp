@@ -0,0 +1,405 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Data/InventoryNetSerializers.h"
+
+#if UE_WITH_IRIS
+
+#include "Data/DefinitionNetIdTable.h"
+#include "Data/InventoryEntry.h"
+#include "Definitions/ItemDefinition.h"
+#include "Instances/ItemInstance.h"
+#include "Instances/ItemInstanceHeader.h"
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+#include "Iris/Serialization/BitPacking.h"
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+#include "Iris/Serialization/ObjectNetSerializer.h"
+#include "Log/InventorySystemLog.h"
+
+/**
+ * Iris counterparts of FItemInstanceHeader::NetSerialize and FInventoryEntry::NetSerialize. Iris does not call the
+ * NetSerialize functions of structs, these serializers are registered for the struct names instead so that definition
+ * classes are sent as their FDefinitionNetIdTable codes on both replication systems. FEquipmentEntry has its own in
+ * EquipmentNetSerializers.cpp, built on the same helpers.
+ */
+namespace UE::Net
+{
+	namespace InventoryNetSerializers
+	{
+		static const FNetSerializer& GetObjectSerializer()
+		{
+			return UE_NET_GET_SERIALIZER(FObjectNetSerializer);
+		}
+
+		static NetSerializerConfigParam GetObjectSerializerConfig()
+		{
+			return NetSerializerConfigParam(&UE_NET_GET_SERIALIZER_DEFAULT_CONFIG(FObjectNetSerializer));
+		}
+
+		void QuantizeObject(FNetSerializationContext& Context, UObject* Object, FNetObjectReference& Target)
+		{
+			FNetQuantizeArgs Args;
+			Args.NetSerializerConfig = GetObjectSerializerConfig();
+			Args.Source = NetSerializerValuePointer(&Object);
+			Args.Target = NetSerializerValuePointer(&Target);
+			GetObjectSerializer().Quantize(Context, Args);
+		}
+
+		UObject* DequantizeObject(FNetSerializationContext& Context, const FNetObjectReference& Source)
+		{
+			UObject* Object = nullptr;
+			FNetDequantizeArgs Args;
+			Args.NetSerializerConfig = GetObjectSerializerConfig();
+			Args.Source = NetSerializerValuePointer(&Source);
+			Args.Target = NetSerializerValuePointer(&Object);
+			GetObjectSerializer().Dequantize(Context, Args);
+			return Object;
+		}
+
+		void SerializeObject(FNetSerializationContext& Context, const FNetObjectReference& Source)
+		{
+			FNetSerializeArgs Args;
+			Args.NetSerializerConfig = GetObjectSerializerConfig();
+			Args.Source = NetSerializerValuePointer(&Source);
+			GetObjectSerializer().Serialize(Context, Args);
+		}
+
+		void DeserializeObject(FNetSerializationContext& Context, FNetObjectReference& Target)
+		{
+			FNetDeserializeArgs Args;
+			Args.NetSerializerConfig = GetObjectSerializerConfig();
+			Args.Target = NetSerializerValuePointer(&Target);
+			GetObjectSerializer().Deserialize(Context, Args);
+		}
+
+		void CollectObjectReference(FNetSerializationContext& Context, const FNetCollectReferencesArgs& OuterArgs, const FNetObjectReference& Source)
+		{
+			FNetCollectReferencesArgs Args = OuterArgs;
+			Args.NetSerializerConfig = GetObjectSerializerConfig();
+			Args.Source = NetSerializerValuePointer(&Source);
+			GetObjectSerializer().CollectNetReferences(Context, Args);
+		}
+
+		void QuantizeDefinitionClass(FNetSerializationContext& Context, const UClass* BaseClass, UClass* Class, FQuantizedDefinitionClass& Target)
+		{
+			Target.NetCode = FDefinitionNetIdTable::Get(BaseClass).GetNetCode(Class);
+			Target.UnlistedClass = FNetObjectReference();
+			if (Target.NetCode == FDefinitionNetIdTable::UnlistedClass)
+			{
+				QuantizeObject(Context, Class, Target.UnlistedClass);
+			}
+		}
+
+		UClass* DequantizeDefinitionClass(FNetSerializationContext& Context, const UClass* BaseClass, const FQuantizedDefinitionClass& Source)
+		{
+			if (Source.NetCode == FDefinitionNetIdTable::UnlistedClass)
+			{
+				return Cast<UClass>(DequantizeObject(Context, Source.UnlistedClass));
+			}
+
+			UClass* Class = FDefinitionNetIdTable::Get(BaseClass).ResolveNetCode(Source.NetCode);
+			UE_CLOG(!Class && Source.NetCode != FDefinitionNetIdTable::NullClass, LogInventorySystem, Warning, TEXT("Received unknown %s net id %u, server and client content may differ."), *GetNameSafe(BaseClass), Source.NetCode - FDefinitionNetIdTable::FirstNetId);
+			return Class;
+		}
+
+		void SerializeDefinitionClass(FNetSerializationContext& Context, const FQuantizedDefinitionClass& Source)
+		{
+			WritePackedUint32(Context.GetBitStreamWriter(), Source.NetCode);
+			if (Source.NetCode == FDefinitionNetIdTable::UnlistedClass)
+			{
+				SerializeObject(Context, Source.UnlistedClass);
+			}
+		}
+
+		void DeserializeDefinitionClass(FNetSerializationContext& Context, FQuantizedDefinitionClass& Target)
+		{
+			Target.NetCode = ReadPackedUint32(Context.GetBitStreamReader());
+			Target.UnlistedClass = FNetObjectReference();
+			if (Target.NetCode == FDefinitionNetIdTable::UnlistedClass)
+			{
+				DeserializeObject(Context, Target.UnlistedClass);
+			}
+		}
+
+		void CollectDefinitionClassReference(FNetSerializationContext& Context, const FNetCollectReferencesArgs& OuterArgs, const FQuantizedDefinitionClass& Source)
+		{
+			if (Source.NetCode == FDefinitionNetIdTable::UnlistedClass)
+			{
+				CollectObjectReference(Context, OuterArgs, Source.UnlistedClass);
+			}
+		}
+	}
+
+	struct FItemInstanceHeaderNetSerializerConfig : public FNetSerializerConfig
+	{
+	};
+
+	/**
+	 * @struct FItemInstanceHeaderNetSerializer
+	 * @see FItemInstanceHeader::NetSerialize
+	 * @brief Sends the definition class of an item instance as its net code
+	 */
+	struct FItemInstanceHeaderNetSerializer
+	{
+		static constexpr uint32 Version = 0;
+		static constexpr bool bHasCustomNetReference = true;
+
+		typedef FItemInstanceHeader SourceType;
+		typedef InventoryNetSerializers::FQuantizedDefinitionClass QuantizedType;
+		typedef FItemInstanceHeaderNetSerializerConfig ConfigType;
+		static const ConfigType DefaultConfig;
+
+		static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+		{
+			InventoryNetSerializers::SerializeDefinitionClass(Context, *reinterpret_cast<const QuantizedType*>(Args.Source));
+		}
+
+		static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+		{
+			InventoryNetSerializers::DeserializeDefinitionClass(Context, *reinterpret_cast<QuantizedType*>(Args.Target));
+		}
+
+		static void Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+		{
+			const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+			InventoryNetSerializers::QuantizeDefinitionClass(Context, UItemDefinition::StaticClass(), Source.DefinitionClass, *reinterpret_cast<QuantizedType*>(Args.Target));
+		}
+
+		static void Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+		{
+			SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+			Target.DefinitionClass = InventoryNetSerializers::DequantizeDefinitionClass(Context, UItemDefinition::StaticClass(), *reinterpret_cast<const QuantizedType*>(Args.Source));
+		}
+
+		static bool IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+		{
+			if (Args.bStateIsQuantized)
+			{
+				return *reinterpret_cast<const QuantizedType*>(Args.Source0) == *reinterpret_cast<const QuantizedType*>(Args.Source1);
+			}
+			return *reinterpret_cast<const SourceType*>(Args.Source0) == *reinterpret_cast<const SourceType*>(Args.Source1);
+		}
+
+		static bool Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args)
+		{
+			return true;
+		}
+
+		static void CollectNetReferences(FNetSerializationContext& Context, const FNetCollectReferencesArgs& Args)
+		{
+			InventoryNetSerializers::CollectDefinitionClassReference(Context, Args, *reinterpret_cast<const QuantizedType*>(Args.Source));
+		}
+
+	private:
+		class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+		{
+		public:
+			virtual ~FNetSerializerRegistryDelegates() override;
+
+		private:
+			virtual void OnPreFreezeNetSerializerRegistry() override;
+		};
+
+		static FItemInstanceHeaderNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+	};
+
+	struct FInventoryEntryNetSerializerConfig : public FNetSerializerConfig
+	{
+	};
+
+	/**
+	 * @struct FInventoryEntryNetSerializer
+	 * @see FInventoryEntry::NetSerialize
+	 * @brief Sends the replicated fields of an inventory entry with the layout of the legacy serializer: presence flags,
+	 * the commodity definition as its net code, and variable length counts and identifiers
+	 */
+	struct FInventoryEntryNetSerializer
+	{
+		static constexpr uint32 Version = 0;
+		static constexpr bool bHasCustomNetReference = true;
+
+		struct FQuantizedType
+		{
+			FNetObjectReference Instance;
+			InventoryNetSerializers::FQuantizedDefinitionClass CommodityDefinition;
+			int32 StackCount;
+			int32 EntryId;
+			int32 Generation;
+			uint16 PackedGridPosition;
+		};
+
+		typedef FInventoryEntry SourceType;
+		typedef FQuantizedType QuantizedType;
+		typedef FInventoryEntryNetSerializerConfig ConfigType;
+		static const ConfigType DefaultConfig;
+
+		enum EEntryFlags : uint32
+		{
+			HasInstance = 1 << 0,
+			HasCommodity = 1 << 1,
+			IsPlaced = 1 << 2
+		};
+
+		static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+		{
+			const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			FNetBitStreamWriter* Writer = Context.GetBitStreamWriter();
+
+			uint32 Flags = 0;
+			Flags |= Source.Instance.IsValid() ? HasInstance : 0;
+			Flags |= Source.CommodityDefinition.NetCode != FDefinitionNetIdTable::NullClass ? HasCommodity : 0;
+			Flags |= Source.PackedGridPosition != MAX_uint16 ? IsPlaced : 0;
+			Writer->WriteBits(Flags, 3);
+
+			if (Flags & HasInstance)
+			{
+				InventoryNetSerializers::SerializeObject(Context, Source.Instance);
+			}
+			if (Flags & HasCommodity)
+			{
+				InventoryNetSerializers::SerializeDefinitionClass(Context, Source.CommodityDefinition);
+			}
+
+			// Identifiers are offset to send INDEX_NONE as zero
+			WritePackedUint32(Writer, static_cast<uint32>(FMath::Max(Source.StackCount, 0)));
+			WritePackedUint32(Writer, static_cast<uint32>(Source.EntryId + 1));
+			WritePackedUint32(Writer, static_cast<uint32>(Source.Generation));
+
+			if (Flags & IsPlaced)
+			{
+				Writer->WriteBits(Source.PackedGridPosition, 16);
+			}
+		}
+
+		static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+		{
+			QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+			FNetBitStreamReader* Reader = Context.GetBitStreamReader();
+
+			const uint32 Flags = Reader->ReadBits(3);
+
+			Target.Instance = FNetObjectReference();
+			if (Flags & HasInstance)
+			{
+				InventoryNetSerializers::DeserializeObject(Context, Target.Instance);
+			}
+
+			Target.CommodityDefinition = InventoryNetSerializers::FQuantizedDefinitionClass{FDefinitionNetIdTable::NullClass, FNetObjectReference()};
+			if (Flags & HasCommodity)
+			{
+				InventoryNetSerializers::DeserializeDefinitionClass(Context, Target.CommodityDefinition);
+			}
+
+			Target.StackCount = static_cast<int32>(ReadPackedUint32(Reader));
+			Target.EntryId = static_cast<int32>(ReadPackedUint32(Reader)) - 1;
+			Target.Generation = static_cast<int32>(ReadPackedUint32(Reader));
+			Target.PackedGridPosition = (Flags & IsPlaced) ? static_cast<uint16>(Reader->ReadBits(16)) : MAX_uint16;
+		}
+
+		static void Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+		{
+			const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+			QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+
+			InventoryNetSerializers::QuantizeObject(Context, Source.Instance, Target.Instance);
+			InventoryNetSerializers::QuantizeDefinitionClass(Context, UItemDefinition::StaticClass(), Source.CommodityDefinition, Target.CommodityDefinition);
+			Target.StackCount = Source.StackCount;
+			Target.EntryId = Source.EntryId;
+			Target.Generation = Source.Generation;
+			Target.PackedGridPosition = Source.PackedGridPosition;
+		}
+
+		static void Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+		{
+			const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+
+			// Only the replicated fields are written, the local state of the entry is kept
+			Target.Instance = Cast<UItemInstance>(InventoryNetSerializers::DequantizeObject(Context, Source.Instance));
+			Target.CommodityDefinition = InventoryNetSerializers::DequantizeDefinitionClass(Context, UItemDefinition::StaticClass(), Source.CommodityDefinition);
+			Target.StackCount = Source.StackCount;
+			Target.EntryId = Source.EntryId;
+			Target.Generation = Source.Generation;
+			Target.PackedGridPosition = Source.PackedGridPosition;
+		}
+
+		static bool IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+		{
+			if (Args.bStateIsQuantized)
+			{
+				const QuantizedType& A = *reinterpret_cast<const QuantizedType*>(Args.Source0);
+				const QuantizedType& B = *reinterpret_cast<const QuantizedType*>(Args.Source1);
+				return A.Instance == B.Instance && A.CommodityDefinition == B.CommodityDefinition && A.StackCount == B.StackCount
+					&& A.EntryId == B.EntryId && A.Generation == B.Generation && A.PackedGridPosition == B.PackedGridPosition;
+			}
+
+			const SourceType& A = *reinterpret_cast<const SourceType*>(Args.Source0);
+			const SourceType& B = *reinterpret_cast<const SourceType*>(Args.Source1);
+			return A.Instance == B.Instance && A.CommodityDefinition == B.CommodityDefinition && A.StackCount == B.StackCount
+				&& A.EntryId == B.EntryId && A.Generation == B.Generation && A.PackedGridPosition == B.PackedGridPosition;
+		}
+
+		static bool Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args)
+		{
+			const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+			return Source.StackCount >= 0 && Source.EntryId >= INDEX_NONE && Source.Generation >= 0;
+		}
+
+		static void CollectNetReferences(FNetSerializationContext& Context, const FNetCollectReferencesArgs& Args)
+		{
+			const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			InventoryNetSerializers::CollectObjectReference(Context, Args, Source.Instance);
+			InventoryNetSerializers::CollectDefinitionClassReference(Context, Args, Source.CommodityDefinition);
+		}
+
+	private:
+		class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+		{
+		public:
+			virtual ~FNetSerializerRegistryDelegates() override;
+
+		private:
+			virtual void OnPreFreezeNetSerializerRegistry() override;
+		};
+
+		static FInventoryEntryNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+	};
+
+	UE_NET_IMPLEMENT_SERIALIZER(FItemInstanceHeaderNetSerializer);
+	UE_NET_IMPLEMENT_SERIALIZER(FInventoryEntryNetSerializer);
+
+	const FItemInstanceHeaderNetSerializer::ConfigType FItemInstanceHeaderNetSerializer::DefaultConfig;
+	const FInventoryEntryNetSerializer::ConfigType FInventoryEntryNetSerializer::DefaultConfig;
+
+	// Used by Iris for every property of these struct types, in place of the reflection of their members
+	static const FName PropertyNetSerializerRegistry_NAME_ItemInstanceHeader("ItemInstanceHeader");
+	static const FName PropertyNetSerializerRegistry_NAME_InventoryEntry("InventoryEntry");
+	UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_ItemInstanceHeader, FItemInstanceHeaderNetSerializer);
+	UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_InventoryEntry, FInventoryEntryNetSerializer);
+
+	FItemInstanceHeaderNetSerializer::FNetSerializerRegistryDelegates FItemInstanceHeaderNetSerializer::NetSerializerRegistryDelegates;
+	FInventoryEntryNetSerializer::FNetSerializerRegistryDelegates FInventoryEntryNetSerializer::NetSerializerRegistryDelegates;
+
+	FItemInstanceHeaderNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+	{
+		UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_ItemInstanceHeader);
+	}
+
+	void FItemInstanceHeaderNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+	{
+		UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_ItemInstanceHeader);
+	}
+
+	FInventoryEntryNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+	{
+		UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_InventoryEntry);
+	}
+
+	void FInventoryEntryNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+	{
+		UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_InventoryEntry);
+	}
+}
+
+#endif
@@ -0,0 +1,176 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Data/InventoryPrediction.h"
+
+#include "Containers/InventoryContainer.h"
+#include "Data/InventoryList.h"
+#include "Definitions/ItemDefinition.h"
+
+namespace
+{
+	/** Gets the replicated stack count of an entry, or INDEX_NONE if the entry is no longer stored */
+	int32 GetReplicatedStackCount(UInventoryContainer* Container, const int32 EntryId, const int32 Generation)
+	{
+		if (!IsValid(Container))
+		{
+			return INDEX_NONE;
+		}
+
+		const FInventoryList& List = Container->GetInventoryList();
+		const int32 Index = List.FindEntryIndex(FInventoryEntryHandle(EntryId, nullptr, 0, Container, Generation));
+		return Index != INDEX_NONE ? List.MakeHandle(Index).StackCount : INDEX_NONE;
+	}
+}
+
+int32 FInventoryPredictedChange::GetCountDelta(const UInventoryContainer* InContainer, const TSubclassOf<UItemDefinition>& InDefinitionClass) const
+{
+	if (DefinitionClass != InDefinitionClass)
+	{
+		return 0;
+	}
+
+	int32 Delta = 0;
+	if (Container == InContainer)
+	{
+		Delta -= Count;
+	}
+	if (Operation == EInventoryPredictedOperation::Move && TargetContainer == InContainer)
+	{
+		Delta += Count;
+	}
+	return Delta;
+}
+
+bool FInventoryPredictedChange::Affects(const UInventoryContainer* InContainer) const
+{
+	return Container == InContainer || (Operation == EInventoryPredictedOperation::Move && TargetContainer == InContainer);
+}
+
+void FInventoryPredictedChange::CaptureReplicatedState()
+{
+	SourceStackCount = GetReplicatedStackCount(Container, EntryId, Generation);
+	ReceivingCount = Operation == EInventoryPredictedOperation::Move && IsValid(TargetContainer) ? TargetContainer->GetTotalCountByDefinition(DefinitionClass) : 0;
+}
+
+bool FInventoryPredictedChange::IsReplicated() const
+{
+	// The source stack lost the predicted items, or was removed: INDEX_NONE is below any predicted count
+	if (GetReplicatedStackCount(Container, EntryId, Generation) > SourceStackCount - Count)
+	{
+		return false;
+	}
+
+	// Both containers of a move replicate separately, the items must have reached the target too
+	if (Operation == EInventoryPredictedOperation::Move && IsValid(TargetContainer)
+		&& TargetContainer->GetTotalCountByDefinition(DefinitionClass) < ReceivingCount + Count)
+	{
+		return false;
+	}
+	return true;
+}
+
+const FInventoryPredictedChange& FInventoryPredictionOverlay::AddPrediction(FInventoryPredictedChange Change)
+{
+	Change.PredictionKey = ++LastPredictionKey;
+	Change.bAccepted = false;
+	Change.bReplicated = false;
+	Change.CaptureReplicatedState();
+	return Predictions.Add_GetRef(MoveTemp(Change));
+}
+
+bool FInventoryPredictionOverlay::Acknowledge(const int32 PredictionKey, const bool bAccepted, FInventoryPredictedChange& OutChange)
+{
+	const int32 Index = Predictions.IndexOfByPredicate([PredictionKey](const FInventoryPredictedChange& Change)
+	{
+		return Change.PredictionKey == PredictionKey;
+	});
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FInventoryPredictedChange& Change = Predictions[Index];
+	Change.bAccepted = bAccepted;
+
+	// The replicated state may have shown the change before the acknowledgement
+	if (!bAccepted || Change.bReplicated)
+	{
+		OutChange = MoveTemp(Change);
+		Predictions.RemoveAt(Index);
+		return true;
+	}
+	return false;
+}
+
+void FInventoryPredictionOverlay::Reconcile(const UInventoryContainer* Container, TArray<FInventoryPredictedChange>& OutEnded)
+{
+	for (int32 Index = 0; Index < Predictions.Num(); )
+	{
+		FInventoryPredictedChange& Change = Predictions[Index];
+		if (!Change.Affects(Container) || !Change.IsReplicated())
+		{
+			++Index;
+			continue;
+		}
+
+		if (Change.bAccepted)
+		{
+			OutEnded.Add(MoveTemp(Change));
+			Predictions.RemoveAt(Index);
+			continue;
+		}
+
+		Change.bReplicated = true;
+		++Index;
+	}
+}
+
+void FInventoryPredictionOverlay::Expire(const double Now, TArray<FInventoryPredictedChange>& OutExpired)
+{
+	for (int32 Index = 0; Index < Predictions.Num(); )
+	{
+		if (Predictions[Index].ExpirationTime <= Now)
+		{
+			OutExpired.Add(MoveTemp(Predictions[Index]));
+			Predictions.RemoveAt(Index);
+			continue;
+		}
+		++Index;
+	}
+}
+
+int32 FInventoryPredictionOverlay::GetCountDelta(const UInventoryContainer* Container, const TSubclassOf<UItemDefinition>& DefinitionClass) const
+{
+	int32 Delta = 0;
+	for (const FInventoryPredictedChange& Change : Predictions)
+	{
+		Delta += Change.GetCountDelta(Container, DefinitionClass);
+	}
+	return Delta;
+}
+
+int32 FInventoryPredictionOverlay::GetEntryDelta(const UInventoryContainer* Container, const int32 EntryId, const int32 Generation) const
+{
+	int32 Delta = 0;
+	for (const FInventoryPredictedChange& Change : Predictions)
+	{
+		if (Change.Container == Container && Change.EntryId == EntryId && Change.Generation == Generation)
+		{
+			Delta -= Change.Count;
+		}
+	}
+	return Delta;
+}
+
+double FInventoryPredictionOverlay::GetNextExpirationTime() const
+{
+	double NextTime = 0.0;
+	for (const FInventoryPredictedChange& Change : Predictions)
+	{
+		if (NextTime == 0.0 || Change.ExpirationTime < NextTime)
+		{
+			NextTime = Change.ExpirationTime;
+		}
+	}
+	return NextTime;
+}
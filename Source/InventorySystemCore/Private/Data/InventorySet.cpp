@@ -18,6 +18,9 @@ FInventoryResult UInventorySet::GiveToInventorySystem(UInventorySystemComponent*
 		return Result;
 	}
 
+	TArray<FInventoryAddRequest> Requests;
+	Requests.Reserve(Items.Num());
+
 	for (auto& [ItemDefinition, Quantity] : Items)
 	{
 		if (!IsValid(ItemDefinition) || Quantity <= 0)
@@ -27,7 +30,17 @@ FInventoryResult UInventorySet::GiveToInventorySystem(UInventorySystemComponent*
 			continue;
 		}
 
-		return InventorySystemComp->TryAddItemDefinitionIn(TargetContainer, ItemDefinition, Quantity);
+		Requests.Emplace(ItemDefinition, Quantity, TargetContainer);
+	}
+
+	// Whole set granted in a single pass, the first failure being reported
+	for (FInventoryResult& ItemResult : InventorySystemComp->TryAddItemDefinitions(Requests).Results)
+	{
+		Result.Instances.Append(ItemResult.Instances);
+		if (!Result.FailureReason.IsValid())
+		{
+			Result.FailureReason = ItemResult.FailureReason;
+		}
 	}
 	return Result;
 }
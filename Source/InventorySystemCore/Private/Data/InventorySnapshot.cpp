@@ -0,0 +1,561 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Data/InventorySnapshot.h"
+
+#include "Components/InventorySystemComponent.h"
+#include "Containers/InventoryContainer_Grid.h"
+#include "Definitions/ItemDefinition.h"
+#include "Data/DefinitionNetIdTable.h"
+#include "Data/InventorySnapshotCodec.h"
+#include "Instances/ItemInstance.h"
+#include "Instances/Components/ItemComponent.h"
+#include "Log/InventorySystemLog.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Subsystems/ItemInstancePool.h"
+#include "UObject/SoftObjectPath.h"
+
+namespace InventorySnapshot
+{
+	enum EEntryFlags : uint8
+	{
+		Flag_HasInstance = 1 << 0,
+		Flag_Placed = 1 << 1
+	};
+
+	template <typename T>
+	void WriteTable(FArchive& Ar, const TArray<T>& Values)
+	{
+		WriteCount(Ar, Values.Num());
+		for (T Value : Values)
+		{
+			Ar << Value;
+		}
+	}
+
+	template <typename T>
+	bool ReadTable(FArchive& Ar, TArray<T>& OutValues)
+	{
+		int32 Num = 0;
+		if (!ReadCount(Ar, Num))
+		{
+			return false;
+		}
+		OutValues.SetNum(Num);
+		for (T& Value : OutValues)
+		{
+			Ar << Value;
+		}
+		return !Ar.IsError();
+	}
+}
+
+int32 FInventorySnapshotTables::AddDefinitionPath(const FString& Path)
+{
+	if (const int32* Index = DefinitionIndices.Find(Path))
+	{
+		return *Index;
+	}
+	return DefinitionIndices.Add(Path, DefinitionPaths.Add(Path));
+}
+
+int32 FInventorySnapshotTables::AddName(const FName Name)
+{
+	if (const int32* Index = NameIndices.Find(Name))
+	{
+		return *Index;
+	}
+	return NameIndices.Add(Name, Names.Add(Name));
+}
+
+int32 FInventorySnapshotTables::AddComponentClassPath(const FString& Path)
+{
+	if (const int32* Index = ComponentClassIndices.Find(Path))
+	{
+		return *Index;
+	}
+	return ComponentClassIndices.Add(Path, ComponentClassPaths.Add(Path));
+}
+
+void FInventorySnapshotTables::Reset()
+{
+	DefinitionPaths.Reset();
+	Names.Reset();
+	ComponentClassPaths.Reset();
+	DefinitionIndices.Reset();
+	NameIndices.Reset();
+	ComponentClassIndices.Reset();
+}
+
+void FInventorySnapshot::Write(UInventorySystemComponent& Inventory, TArray<uint8>& OutData)
+{
+	FInventorySnapshot Snapshot;
+	Snapshot.Capture(Inventory);
+	Snapshot.Encode(OutData);
+}
+
+void FInventorySnapshot::Capture(UInventorySystemComponent& Inventory)
+{
+	Version = EInventorySnapshotVersion::Latest;
+	Tables.Reset();
+	Containers.Reset();
+	OwnedStates.Reset();
+
+	for (const auto& Pair : Inventory.GetAllContainers())
+	{
+		UInventoryContainer* Container = Pair.Value;
+		if (!IsValid(Container))
+		{
+			continue;
+		}
+
+		FInventorySnapshotContainer& SnapshotContainer = Containers.AddDefaulted_GetRef();
+		SnapshotContainer.TagIndex = Tables.AddName(Pair.Key.GetTagName());
+
+		const UInventoryContainer_Grid* Grid = Cast<UInventoryContainer_Grid>(Container);
+		const TArray<FInventoryEntryHandle> Handles = Container->GetInventoryList().GetAllHandles();
+		SnapshotContainer.Entries.SetNum(Handles.Num());
+		for (int32 Index = 0; Index < Handles.Num(); ++Index)
+		{
+			CaptureEntry(Handles[Index], Grid, Tables, OwnedStates, SnapshotContainer.Entries[Index]);
+		}
+	}
+}
+
+void FInventorySnapshot::Encode(TArray<uint8>& OutData) const
+{
+	using namespace InventorySnapshot;
+
+	FMemoryWriter Writer(OutData, true, true);
+	uint32 SnapshotMagic = Magic;
+	uint16 SnapshotVersion = static_cast<uint16>(EInventorySnapshotVersion::Latest);
+	Writer << SnapshotMagic;
+	Writer << SnapshotVersion;
+	WriteTable(Writer, Tables.DefinitionPaths);
+	WriteTable(Writer, Tables.Names);
+	WriteTable(Writer, Tables.ComponentClassPaths);
+
+	WriteCount(Writer, Containers.Num());
+	for (const FInventorySnapshotContainer& Container : Containers)
+	{
+		WriteCount(Writer, Container.TagIndex);
+		WriteCount(Writer, Container.Entries.Num());
+		for (const FInventorySnapshotEntry& Entry : Container.Entries)
+		{
+			WriteEntry(Writer, Entry);
+		}
+	}
+}
+
+bool FInventorySnapshot::Decode(const FMemoryView Data)
+{
+	using namespace InventorySnapshot;
+
+	Tables.Reset();
+	Containers.Reset();
+	OwnedStates.Reset();
+	FMemoryReaderView Reader(Data);
+
+	uint32 SnapshotMagic = 0;
+	uint16 SnapshotVersion = 0;
+	Reader << SnapshotMagic;
+	Reader << SnapshotVersion;
+	if (Reader.IsError() || SnapshotMagic != Magic)
+	{
+		UE_LOG(LogInventorySystem, Warning, TEXT("Tried to decode data which is not an inventory snapshot."));
+		return false;
+	}
+	if (SnapshotVersion == 0 || SnapshotVersion > static_cast<uint16>(EInventorySnapshotVersion::Latest))
+	{
+		UE_LOG(LogInventorySystem, Warning, TEXT("Inventory snapshot version %d is not supported, latest is %d."), SnapshotVersion, static_cast<int32>(EInventorySnapshotVersion::Latest));
+		return false;
+	}
+	Version = static_cast<EInventorySnapshotVersion>(SnapshotVersion);
+
+	// Read through the tables directly, their lookup maps are only needed to fold journals
+	TArray<FString> DefinitionPaths, ComponentClassPaths;
+	TArray<FName> Names;
+	if (!ReadTable(Reader, DefinitionPaths) || !ReadTable(Reader, Names) || !ReadTable(Reader, ComponentClassPaths))
+	{
+		UE_LOG(LogInventorySystem, Warning, TEXT("Inventory snapshot tables are corrupted."));
+		return false;
+	}
+	for (const FString& Path : DefinitionPaths)
+	{
+		Tables.AddDefinitionPath(Path);
+	}
+	for (const FName& Name : Names)
+	{
+		Tables.AddName(Name);
+	}
+	for (const FString& Path : ComponentClassPaths)
+	{
+		Tables.AddComponentClassPath(Path);
+	}
+
+	int32 NumContainers = 0;
+	ReadCount(Reader, NumContainers);
+	Containers.Reserve(NumContainers);
+	for (int32 ContainerIndex = 0; ContainerIndex < NumContainers && !Reader.IsError(); ++ContainerIndex)
+	{
+		FInventorySnapshotContainer& Container = Containers.AddDefaulted_GetRef();
+		int32 NumEntries = 0;
+		if (!ReadIndex(Reader, Tables.Names.Num(), Container.TagIndex) || !ReadCount(Reader, NumEntries))
+		{
+			break;
+		}
+
+		Container.Entries.SetNum(NumEntries);
+		for (FInventorySnapshotEntry& Entry : Container.Entries)
+		{
+			if (!ReadEntry(Reader, Data, Version, Tables, Entry))
+			{
+				break;
+			}
+		}
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogInventorySystem, Warning, TEXT("Inventory snapshot is truncated or corrupted."));
+		Containers.Reset();
+		return false;
+	}
+	return true;
+}
+
+bool FInventorySnapshot::Apply(UInventorySystemComponent& Inventory) const
+{
+	const AActor* Owner = Inventory.GetOwner();
+	if (!Owner || !Owner->HasAuthority())
+	{
+		return false;
+	}
+
+	FInventorySnapshotResolvedTables Resolved;
+	Resolve(Resolved);
+
+	FInventoryChangeScope ChangeScope(&Inventory);
+	Inventory.Empty();
+
+	int32 NumSkipped = 0;
+	for (int32 ContainerIndex = 0; ContainerIndex < Containers.Num(); ++ContainerIndex)
+	{
+		for (int32 EntryIndex = 0; EntryIndex < Containers[ContainerIndex].Entries.Num(); ++EntryIndex)
+		{
+			NumSkipped += ApplyEntry(Inventory, Resolved, ContainerIndex, EntryIndex) ? 0 : 1;
+		}
+	}
+
+	UE_CLOG(NumSkipped > 0, LogInventorySystem, Warning, TEXT("%d entries of the inventory snapshot could not be restored in %s."), NumSkipped, *GetNameSafe(Owner));
+	return true;
+}
+
+void FInventorySnapshotResolvedTables::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (const TSubclassOf<UItemDefinition>& Definition : Definitions)
+	{
+		UClass* DefinitionClass = Definition;
+		Collector.AddReferencedObject(DefinitionClass);
+	}
+	Collector.AddReferencedObjects(ComponentClasses);
+}
+
+void FInventorySnapshot::GetUnloadedPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	auto AddIfUnloaded = [&OutPaths](const FString& Path)
+	{
+		const FSoftClassPath ClassPath(Path);
+		if (ClassPath.IsValid() && !ClassPath.ResolveClass())
+		{
+			OutPaths.AddUnique(ClassPath);
+		}
+	};
+
+	// Definitions listed by the net id table are loaded with it
+	const FDefinitionNetIdTable& DefinitionTable = FDefinitionNetIdTable::Get(UItemDefinition::StaticClass());
+	for (const FString& Path : Tables.DefinitionPaths)
+	{
+		if (!DefinitionTable.FindClass(FTopLevelAssetPath(Path)))
+		{
+			AddIfUnloaded(Path);
+		}
+	}
+	for (const FString& Path : Tables.ComponentClassPaths)
+	{
+		AddIfUnloaded(Path);
+	}
+}
+
+void FInventorySnapshot::Resolve(FInventorySnapshotResolvedTables& OutResolved) const
+{
+	// Definitions are never loaded here: the net id table keeps every listed one loaded, and the others were streamed
+	// in from GetUnloadedPaths by the asynchronous loads
+	const FDefinitionNetIdTable& DefinitionTable = FDefinitionNetIdTable::Get(UItemDefinition::StaticClass());
+	OutResolved.Definitions.Reset(Tables.DefinitionPaths.Num());
+	for (const FString& Path : Tables.DefinitionPaths)
+	{
+		UClass* DefinitionClass = DefinitionTable.FindClass(FTopLevelAssetPath(Path));
+		if (!DefinitionClass)
+		{
+			DefinitionClass = FSoftClassPath(Path).ResolveClass();
+		}
+
+		const TSubclassOf<UItemDefinition> Definition = DefinitionClass && DefinitionClass->IsChildOf<UItemDefinition>() ? DefinitionClass : nullptr;
+		UE_CLOG(!Definition, LogInventorySystem, Warning, TEXT("Item definition [%s] of the inventory snapshot is not loaded, its entries are skipped."), *Path);
+		OutResolved.Definitions.Add(Definition);
+	}
+
+	OutResolved.Tags.Reset(Tables.Names.Num());
+	for (const FName& Name : Tables.Names)
+	{
+		OutResolved.Tags.Add(FGameplayTag::RequestGameplayTag(Name, false));
+	}
+
+	OutResolved.ComponentClasses.Reset(Tables.ComponentClassPaths.Num());
+	for (const FString& Path : Tables.ComponentClassPaths)
+	{
+		OutResolved.ComponentClasses.Add(FSoftClassPath(Path).TryLoadClass<UItemComponent>());
+	}
+}
+
+bool FInventorySnapshot::ApplyEntry(UInventorySystemComponent& Inventory, const FInventorySnapshotResolvedTables& Resolved, const int32 ContainerIndex, const int32 EntryIndex) const
+{
+	const FInventorySnapshotContainer& SnapshotContainer = Containers[ContainerIndex];
+	const FInventorySnapshotEntry& Entry = SnapshotContainer.Entries[EntryIndex];
+	const FGameplayTag& ContainerTag = Resolved.Tags[SnapshotContainer.TagIndex];
+	UInventoryContainer* Container = Inventory.GetContainer(ContainerTag);
+	if (!IsValid(Container))
+	{
+		UE_CLOG(EntryIndex == 0, LogInventorySystem, Warning, TEXT("Container [%s] of the inventory snapshot is not registered, its entries are skipped."), *Tables.Names[SnapshotContainer.TagIndex].ToString());
+		return false;
+	}
+
+	const TSubclassOf<UItemDefinition>& DefinitionClass = Resolved.Definitions[Entry.DefinitionIndex];
+	if (!DefinitionClass)
+	{
+		return false;
+	}
+
+	// Restored in its saved slot, so that the journals written after the load refer to the same entries
+	FInventoryList& List = Container->GetInventoryList();
+	List.ReserveEntrySlot(Entry.EntryId, Entry.Generation);
+
+	// Stored as saved: the storage, capacity and uniqueness checks were passed when the entry was added, rerunning them
+	// against changed rules would drop saved items
+	FInventoryEntryHandle Handle;
+	if (Entry.bHasInstance)
+	{
+		UItemInstance* Instance = UItemInstancePool::AcquireInstance(Inventory.GetOwner(), UItemInstance::StaticClass());
+		Instance->Initialize(Inventory.GetCachedDefinition(DefinitionClass));
+		for (const int32 TagIndex : Entry.TagIndices)
+		{
+			if (Resolved.Tags[TagIndex].IsValid())
+			{
+				Instance->AddTag(Resolved.Tags[TagIndex]);
+			}
+		}
+
+		// Components are created by the fragments of the definition, states of removed ones are skipped
+		for (const FInventorySnapshotComponent& SnapshotComponent : Entry.Components)
+		{
+			const UClass* ComponentClass = Resolved.ComponentClasses[SnapshotComponent.ClassIndex];
+			UItemComponent* const* Component = Instance->GetComponents().FindByPredicate([ComponentClass](const UItemComponent* Candidate)
+			{
+				return IsValid(Candidate) && Candidate->GetClass() == ComponentClass;
+			});
+			if (ComponentClass && Component)
+			{
+				FMemoryReaderView ComponentReader(SnapshotComponent.Data);
+				(*Component)->SerializeSnapshot(ComponentReader);
+			}
+		}
+
+		List.InsertInstance(Instance, Entry.StackCount);
+		Handle = List.MakeHandle(List.Entries.Num() - 1);
+
+		FInventoryResult Result;
+		Result.Instances.Add(Instance);
+		Inventory.RegisterReplicatedInstances(Result);
+	}
+	else
+	{
+		Handle = List.MakeHandle(List.InsertCommodity(DefinitionClass, Entry.StackCount));
+	}
+
+	// Older snapshots have no slots: the journal waits for a new checkpoint
+	List.ClearEntrySlotReservation();
+	if (!Handle.IsHandleValid() || Handle.EntryId != Entry.EntryId)
+	{
+		Inventory.bJournalRequiresCheckpoint = true;
+	}
+
+	// Placed where it was saved, the previous entries already being at their saved positions
+	UInventoryContainer_Grid* Grid = Cast<UInventoryContainer_Grid>(Container);
+	if (Grid && Entry.PackedGridPosition != InventoryGrid::InvalidPosition && Handle.IsHandleValid())
+	{
+		int32 X, Y;
+		bool bRotated;
+		InventoryGrid::UnpackPosition(Entry.PackedGridPosition, X, Y, bRotated);
+
+		FGameplayTag FailureReason;
+		UE_CLOG(!Grid->TryMoveEntryTo(Handle, X, Y, bRotated, FailureReason), LogInventorySystem, Verbose,
+			TEXT("Entry of the inventory snapshot could not be placed at (%d, %d) of container [%s]: %s"), X, Y, *ContainerTag.ToString(), *FailureReason.ToString());
+	}
+	return true;
+}
+
+int32 FInventorySnapshot::GetNumEntries() const
+{
+	int32 NumEntries = 0;
+	for (const FInventorySnapshotContainer& Container : Containers)
+	{
+		NumEntries += Container.Entries.Num();
+	}
+	return NumEntries;
+}
+
+void FInventorySnapshot::WriteEntry(FArchive& Ar, const FInventorySnapshotEntry& Entry)
+{
+	using namespace InventorySnapshot;
+
+	const bool bPlaced = Entry.PackedGridPosition != InventoryGrid::InvalidPosition;
+	uint8 Flags = static_cast<uint8>((Entry.bHasInstance ? Flag_HasInstance : 0) | (bPlaced ? Flag_Placed : 0));
+	Ar << Flags;
+	WriteCount(Ar, Entry.EntryId + 1);
+	WriteCount(Ar, Entry.Generation);
+	WriteCount(Ar, Entry.DefinitionIndex);
+	WriteCount(Ar, Entry.StackCount);
+	if (bPlaced)
+	{
+		uint16 PackedPosition = Entry.PackedGridPosition;
+		Ar << PackedPosition;
+	}
+	if (!Entry.bHasInstance)
+	{
+		return;
+	}
+
+	WriteCount(Ar, Entry.TagIndices.Num());
+	for (const int32 TagIndex : Entry.TagIndices)
+	{
+		WriteCount(Ar, TagIndex);
+	}
+
+	WriteCount(Ar, Entry.Components.Num());
+	for (const FInventorySnapshotComponent& Component : Entry.Components)
+	{
+		WriteCount(Ar, Component.ClassIndex);
+		WriteCount(Ar, static_cast<int32>(Component.Data.GetSize()));
+		Ar.Serialize(const_cast<void*>(Component.Data.GetData()), Component.Data.GetSize());
+	}
+}
+
+bool FInventorySnapshot::ReadEntry(FArchive& Ar, const FMemoryView Data, const EInventorySnapshotVersion EntryVersion, const FInventorySnapshotTables& InTables, FInventorySnapshotEntry& OutEntry)
+{
+	using namespace InventorySnapshot;
+
+	uint8 Flags = 0;
+	Ar << Flags;
+	OutEntry.bHasInstance = (Flags & Flag_HasInstance) != 0;
+	if (EntryVersion >= EInventorySnapshotVersion::EntryIds)
+	{
+		int32 EncodedEntryId = 0;
+		if (!ReadValue(Ar, EncodedEntryId) || !ReadValue(Ar, OutEntry.Generation))
+		{
+			return false;
+		}
+		OutEntry.EntryId = EncodedEntryId - 1;
+	}
+	if (!ReadIndex(Ar, InTables.DefinitionPaths.Num(), OutEntry.DefinitionIndex) || !ReadValue(Ar, OutEntry.StackCount))
+	{
+		return false;
+	}
+	if (OutEntry.StackCount <= 0)
+	{
+		Ar.SetError();
+		return false;
+	}
+	if (Flags & Flag_Placed)
+	{
+		Ar << OutEntry.PackedGridPosition;
+	}
+	if (!OutEntry.bHasInstance)
+	{
+		return !Ar.IsError();
+	}
+
+	int32 NumTags = 0;
+	if (!ReadCount(Ar, NumTags))
+	{
+		return false;
+	}
+	OutEntry.TagIndices.SetNum(NumTags);
+	for (int32& TagIndex : OutEntry.TagIndices)
+	{
+		if (!ReadIndex(Ar, InTables.Names.Num(), TagIndex))
+		{
+			return false;
+		}
+	}
+
+	int32 NumComponents = 0;
+	if (!ReadCount(Ar, NumComponents))
+	{
+		return false;
+	}
+	OutEntry.Components.SetNum(NumComponents);
+	for (FInventorySnapshotComponent& Component : OutEntry.Components)
+	{
+		int32 Size = 0;
+		if (!ReadIndex(Ar, InTables.ComponentClassPaths.Num(), Component.ClassIndex) || !ReadCount(Ar, Size))
+		{
+			return false;
+		}
+
+		// Points into the source buffer, nothing is copied
+		Component.Data = Data.Mid(Ar.Tell(), Size);
+		Ar.Seek(Ar.Tell() + Size);
+	}
+	return !Ar.IsError();
+}
+
+void FInventorySnapshot::CaptureEntry(const FInventoryEntryHandle& Handle, const UInventoryContainer_Grid* Grid, FInventorySnapshotTables& InTables, TArray<TArray<uint8>>& OutStates, FInventorySnapshotEntry& OutEntry)
+{
+	UItemInstance* Instance = Handle.ItemInstance;
+
+	OutEntry.EntryId = Handle.EntryId;
+	OutEntry.Generation = Handle.Generation;
+	OutEntry.DefinitionIndex = InTables.AddDefinitionPath(Handle.DefinitionClass ? Handle.DefinitionClass->GetClassPathName().ToString() : FString());
+	OutEntry.StackCount = Handle.StackCount;
+	OutEntry.bHasInstance = Instance != nullptr;
+
+	int32 X, Y;
+	bool bRotated;
+	OutEntry.PackedGridPosition = Grid && Grid->GetEntryPosition(Handle, X, Y, bRotated) ? InventoryGrid::PackPosition(X, Y, bRotated) : InventoryGrid::InvalidPosition;
+	if (!Instance)
+	{
+		return;
+	}
+
+	for (const FGameplayTag& Tag : Instance->GetInstanceTags())
+	{
+		OutEntry.TagIndices.Add(InTables.AddName(Tag.GetTagName()));
+	}
+
+	for (UItemComponent* Component : Instance->GetComponents())
+	{
+		if (!IsValid(Component))
+		{
+			continue;
+		}
+
+		TArray<uint8>& State = OutStates.AddDefaulted_GetRef();
+		FMemoryWriter StateWriter(State, true);
+		Component->SerializeSnapshot(StateWriter);
+
+		FInventorySnapshotComponent& SnapshotComponent = OutEntry.Components.AddDefaulted_GetRef();
+		SnapshotComponent.ClassIndex = InTables.AddComponentClassPath(Component->GetClass()->GetClassPathName().ToString());
+		SnapshotComponent.Data = MakeMemoryView(State);
+	}
+}
@@ -0,0 +1,49 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Variable length integers shared by the inventory snapshots and journals */
+namespace InventorySnapshot
+{
+	inline void WriteCount(FArchive& Ar, const int32 Value)
+	{
+		uint32 Packed = static_cast<uint32>(Value);
+		Ar.SerializeIntPacked(Packed);
+	}
+
+	inline bool ReadValue(FArchive& Ar, int32& OutValue)
+	{
+		uint32 Packed = 0;
+		Ar.SerializeIntPacked(Packed);
+		if (Ar.IsError() || Packed > static_cast<uint32>(MAX_int32))
+		{
+			Ar.SetError();
+			return false;
+		}
+		OutValue = static_cast<int32>(Packed);
+		return true;
+	}
+
+	/** Reads a number of elements, refusing values no remaining data could back */
+	inline bool ReadCount(FArchive& Ar, int32& OutValue)
+	{
+		if (!ReadValue(Ar, OutValue) || OutValue > Ar.TotalSize() - Ar.Tell())
+		{
+			Ar.SetError();
+			return false;
+		}
+		return true;
+	}
+
+	inline bool ReadIndex(FArchive& Ar, const int32 TableSize, int32& OutIndex)
+	{
+		if (!ReadValue(Ar, OutIndex) || OutIndex >= TableSize)
+		{
+			Ar.SetError();
+			return false;
+		}
+		return true;
+	}
+}
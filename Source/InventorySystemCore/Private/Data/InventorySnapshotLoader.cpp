@@ -0,0 +1,176 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Data/InventorySnapshotLoader.h"
+
+#include "Async/Async.h"
+#include "Components/InventorySystemComponent.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Log/InventorySystemLog.h"
+#include "Tasks/Task.h"
+#include "TimerManager.h"
+#include "UObject/SoftObjectPath.h"
+
+FInventorySnapshotLoader::FInventorySnapshotLoader(UInventorySystemComponent& InInventory, TArray<uint8>&& InData, const double InBudgetSeconds)
+	: Inventory(&InInventory)
+	, Data(MoveTemp(InData))
+	, BudgetSeconds(InBudgetSeconds)
+{
+}
+
+void FInventorySnapshotLoader::Start(FOnCompleted&& InOnCompleted)
+{
+	check(IsInGameThread());
+	OnCompleted = MoveTemp(InOnCompleted);
+	bRunning = true;
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [Loader = TSharedPtr<FInventorySnapshotLoader>(AsShared())]() mutable
+	{
+		// Decoding and validation only touch plain data, the buffer being owned by the loader
+		const bool bDecoded = Loader->Snapshot.Decode(MakeMemoryView(Loader->Data));
+
+		// Moved so that the last reference is never released by the worker
+		AsyncTask(ENamedThreads::GameThread, [Loader = MoveTemp(Loader), bDecoded]
+		{
+			Loader->OnDecoded(bDecoded);
+		});
+	});
+}
+
+void FInventorySnapshotLoader::Cancel()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	OnCompleted.Unbind();
+	Finish(false);
+}
+
+void FInventorySnapshotLoader::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Resolved.AddReferencedObjects(Collector);
+}
+
+void FInventorySnapshotLoader::OnDecoded(const bool bDecoded)
+{
+	if (!bRunning)
+	{
+		return;
+	}
+	if (!bDecoded || !Inventory.IsValid())
+	{
+		Finish(false);
+		return;
+	}
+
+	// Blueprint definitions are loaded without blocking, each path being resolved once they are all available
+	TArray<FSoftObjectPath> UnloadedPaths;
+	Snapshot.GetUnloadedPaths(UnloadedPaths);
+	if (UnloadedPaths.IsEmpty())
+	{
+		BeginMaterialize();
+		return;
+	}
+
+	NumPendingLoads = UnloadedPaths.Num();
+	for (const FSoftObjectPath& Path : UnloadedPaths)
+	{
+		Path.LoadAsync(FLoadSoftObjectPathAsyncDelegate::CreateSP(this, &FInventorySnapshotLoader::OnClassLoaded));
+	}
+}
+
+void FInventorySnapshotLoader::OnClassLoaded(const FSoftObjectPath& Path, UObject* LoadedObject)
+{
+	UE_CLOG(!LoadedObject, LogInventorySystem, Warning, TEXT("Class [%s] of the inventory snapshot failed to load."), *Path.ToString());
+	if (--NumPendingLoads == 0 && bRunning)
+	{
+		BeginMaterialize();
+	}
+}
+
+void FInventorySnapshotLoader::BeginMaterialize()
+{
+	UInventorySystemComponent* Component = Inventory.Get();
+	if (!IsValid(Component) || !Component->GetOwner()->HasAuthority())
+	{
+		Finish(false);
+		return;
+	}
+
+	Snapshot.Resolve(Resolved);
+	Component->BeginSnapshotRestore();
+	bRestoreStarted = true;
+	MaterializeSlice();
+}
+
+void FInventorySnapshotLoader::MaterializeSlice()
+{
+	SliceTimerHandle.Invalidate();
+	UInventorySystemComponent* Component = Inventory.Get();
+	if (!bRunning || !IsValid(Component))
+	{
+		Finish(false);
+		return;
+	}
+
+	const TArray<FInventorySnapshotContainer>& Containers = Snapshot.GetContainers();
+	const double EndTime = FPlatformTime::Seconds() + BudgetSeconds;
+	{
+		// The changes of a slice are reported at once, after the guard: listeners are refused changes until the end of
+		// the load, but the entries already materialized may change, e.g. their instance tags, which are journaled
+		FInventoryChangeScope ChangeScope(Component);
+		TGuardValue<bool> RestoreGuard(Component->bRestoringSnapshot, true);
+		do
+		{
+			while (Containers.IsValidIndex(ContainerIndex) && !Containers[ContainerIndex].Entries.IsValidIndex(EntryIndex))
+			{
+				++ContainerIndex;
+				EntryIndex = 0;
+			}
+			if (!Containers.IsValidIndex(ContainerIndex))
+			{
+				break;
+			}
+
+			NumSkipped += Snapshot.ApplyEntry(*Component, Resolved, ContainerIndex, EntryIndex++) ? 0 : 1;
+		}
+		while (FPlatformTime::Seconds() < EndTime);
+	}
+
+	if (!Containers.IsValidIndex(ContainerIndex))
+	{
+		Finish(true);
+		return;
+	}
+
+	if (UWorld* World = Component->GetWorld())
+	{
+		SliceTimerHandle = World->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateSP(this, &FInventorySnapshotLoader::MaterializeSlice));
+	}
+}
+
+void FInventorySnapshotLoader::Finish(const bool bSuccess)
+{
+	// The owning component may release the loader from the completion callback
+	const TSharedRef<FInventorySnapshotLoader> KeepAlive = AsShared();
+	bRunning = false;
+
+	UInventorySystemComponent* Component = Inventory.Get();
+	if (IsValid(Component))
+	{
+		if (const UWorld* World = Component->GetWorld(); World && SliceTimerHandle.IsValid())
+		{
+			World->GetTimerManager().ClearTimer(SliceTimerHandle);
+		}
+		if (bRestoreStarted)
+		{
+			Component->EndSnapshotRestore(bSuccess);
+		}
+	}
+
+	UE_CLOG(NumSkipped > 0, LogInventorySystem, Warning, TEXT("%d entries of the inventory snapshot could not be restored in %s."), NumSkipped, *GetNameSafe(Component));
+	OnCompleted.ExecuteIfBound(bSuccess);
+	OnCompleted.Unbind();
+}
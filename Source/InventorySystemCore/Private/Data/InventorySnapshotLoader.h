@@ -0,0 +1,83 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/InventorySnapshot.h"
+#include "Engine/TimerHandle.h"
+#include "UObject/GCObject.h"
+
+class UInventorySystemComponent;
+
+/**
+ * @class FInventorySnapshotLoader
+ * @see UInventorySystemComponent::LoadSnapshotAsync, FInventorySnapshot
+ * @brief Restores a snapshot in two phases: decoding on a worker task, then materializing on the game thread
+ * @details The snapshot is decoded and validated on a worker task, touching no UObject. Back on the game thread, the
+ * classes not loaded yet are loaded asynchronously and each path is resolved once, then the inventory is emptied and
+ * the entries are rebuilt a few at a time, within a time budget per frame. The inventory is left untouched if the
+ * data cannot be decoded.
+ */
+class FInventorySnapshotLoader : public FGCObject, public TSharedFromThis<FInventorySnapshotLoader>
+{
+public:
+	DECLARE_DELEGATE_OneParam(FOnCompleted, bool /* bSuccess */);
+
+	/**
+	 * @param InInventory The inventory to restore, on authority
+	 * @param InData The snapshot, kept by the loader as the decoded entries point into it
+	 * @param InBudgetSeconds Time spent per frame materializing entries, at least one entry being rebuilt per frame
+	 */
+	FInventorySnapshotLoader(UInventorySystemComponent& InInventory, TArray<uint8>&& InData, double InBudgetSeconds);
+
+	/**
+	 * Launches the decoding task
+	 * @param InOnCompleted Called on the game thread once the snapshot is restored or has failed, unless cancelled
+	 */
+	void Start(FOnCompleted&& InOnCompleted);
+
+	/** Stops the load, the entries materialized so far being kept */
+	void Cancel();
+
+	bool IsRunning() const { return bRunning; }
+
+	// FGCObject
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("FInventorySnapshotLoader"); }
+	// ~FGCObject
+
+private:
+	void OnDecoded(bool bDecoded);
+	void OnClassLoaded(const FSoftObjectPath& Path, UObject* LoadedObject);
+	void BeginMaterialize();
+	void MaterializeSlice();
+	void Finish(bool bSuccess);
+
+	TWeakObjectPtr<UInventorySystemComponent> Inventory;
+
+	/** The snapshot data, owned until the end of the load */
+	TArray<uint8> Data;
+
+	FInventorySnapshot Snapshot;
+
+	FInventorySnapshotResolvedTables Resolved;
+
+	FOnCompleted OnCompleted;
+
+	FTimerHandle SliceTimerHandle;
+
+	double BudgetSeconds = 0.0;
+
+	int32 NumPendingLoads = 0;
+
+	/** Next entry to materialize */
+	int32 ContainerIndex = 0;
+	int32 EntryIndex = 0;
+
+	int32 NumSkipped = 0;
+
+	bool bRunning = false;
+
+	/** True once the inventory has been emptied to be rebuilt */
+	bool bRestoreStarted = false;
+};
@@ -0,0 +1,72 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Data/InventoryTagBitset.h"
+
+#include "Misc/ScopeRWLock.h"
+
+namespace InventoryTagBits
+{
+	FRWLock& GetLock()
+	{
+		static FRWLock Lock;
+		return Lock;
+	}
+
+	TMap<FGameplayTag, int32>& GetTagBits()
+	{
+		static TMap<FGameplayTag, int32> TagBits;
+		return TagBits;
+	}
+}
+
+int32 FInventoryTagBitset::RegisterTag(const FGameplayTag& Tag)
+{
+	if (!Tag.IsValid())
+	{
+		return INDEX_NONE;
+	}
+
+	{
+		FReadScopeLock ReadLock(InventoryTagBits::GetLock());
+		if (const int32* Bit = InventoryTagBits::GetTagBits().Find(Tag))
+		{
+			return *Bit;
+		}
+	}
+
+	FWriteScopeLock WriteLock(InventoryTagBits::GetLock());
+	TMap<FGameplayTag, int32>& TagBits = InventoryTagBits::GetTagBits();
+
+	// May have been registered by another thread meanwhile
+	if (const int32* Bit = TagBits.Find(Tag))
+	{
+		return *Bit;
+	}
+	return TagBits.Add(Tag, TagBits.Num());
+}
+
+FInventoryTagBitset FInventoryTagBitset::FromTags(const FGameplayTagContainer& Tags)
+{
+	FInventoryTagBitset Bitset;
+	for (const FGameplayTag& Tag : Tags)
+	{
+		Bitset.AddTag(Tag);
+	}
+	return Bitset;
+}
+
+void FInventoryTagBitset::AddTag(const FGameplayTag& Tag)
+{
+	const int32 Bit = RegisterTag(Tag);
+	if (Bit == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 WordIndex = Bit / 64;
+	if (WordIndex >= Words.Num())
+	{
+		Words.SetNumZeroed(WordIndex + 1);
+	}
+	Words[WordIndex] |= 1ull << (Bit % 64);
+}
@@ -1,3 +1,46 @@
 ﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
 
 #include "Definitions/Fragments/ItemFragment.h"
+
+#include "Misc/ScopeRWLock.h"
+
+namespace ItemFragmentTypes
+{
+	FRWLock& GetLock()
+	{
+		static FRWLock Lock;
+		return Lock;
+	}
+
+	TMap<const UClass*, int32>& GetTypeIds()
+	{
+		static TMap<const UClass*, int32> TypeIds;
+		return TypeIds;
+	}
+}
+
+int32 UItemFragment::RegisterFragmentType(const UClass* FragmentClass)
+{
+	if (const int32 TypeId = FindFragmentTypeId(FragmentClass); TypeId != INDEX_NONE || !FragmentClass)
+	{
+		return TypeId;
+	}
+
+	FWriteScopeLock WriteLock(ItemFragmentTypes::GetLock());
+	TMap<const UClass*, int32>& TypeIds = ItemFragmentTypes::GetTypeIds();
+
+	// May have been registered by another thread meanwhile
+	if (const int32* TypeId = TypeIds.Find(FragmentClass))
+	{
+		return *TypeId;
+	}
+	return TypeIds.Add(FragmentClass, TypeIds.Num());
+}
+
+int32 UItemFragment::FindFragmentTypeId(const UClass* FragmentClass)
+{
+	FReadScopeLock ReadLock(ItemFragmentTypes::GetLock());
+
+	const int32* TypeId = ItemFragmentTypes::GetTypeIds().Find(FragmentClass);
+	return TypeId ? *TypeId : INDEX_NONE;
+}
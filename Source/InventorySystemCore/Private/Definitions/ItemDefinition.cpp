@@ -15,10 +15,20 @@ UItemDefinition::UItemDefinition(const FObjectInitializer& ObjectInitializer)
 {
 }
 
+void UItemDefinition::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	RebuildFragmentTable();
+}
+
 void UItemDefinition::PostLoad()
 {
 	UObject::PostLoad();
 
+	RebuildFragmentTable();
+	bTagCacheBuilt = false;
+
 #if WITH_EDITORONLY_DATA
 	PreviousFragments = Fragments;
 #endif
@@ -29,6 +39,10 @@ void UItemDefinition::PostEditChangeProperty(FPropertyChangedEvent& PropertyChan
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
 
+	// Fragments and tags may be modified by any edition, including undo
+	RebuildFragmentTable();
+	bTagCacheBuilt = false;
+
 	if (PropertyChangedEvent.Property && PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UItemDefinition, Fragments))
 	{
 		// Check Fragment rules from the Inventory System Settings
@@ -109,6 +123,17 @@ void UItemDefinition::GetOwnedGameplayTags(FGameplayTagContainer& TagContainer)
 }
 
 const UItemFragment* UItemDefinition::FindFragmentByClass(const TSubclassOf<UItemFragment> FragmentClass) const
+{
+	if (!IsValid(FragmentClass))
+	{
+		return nullptr;
+	}
+
+	// Never registered types are not in the table, no need to register them
+	return FindFragmentByTypeId(bFragmentTableBuilt ? UItemFragment::FindFragmentTypeId(FragmentClass) : INDEX_NONE, FragmentClass);
+}
+
+const UItemFragment* UItemDefinition::FindFragmentByClass_Linear(const UClass* FragmentClass) const
 {
 	if (IsValid(FragmentClass))
 	{
@@ -124,6 +149,71 @@ const UItemFragment* UItemDefinition::FindFragmentByClass(const TSubclassOf<UIte
 	return nullptr;
 }
 
+const FGameplayTagContainer& UItemDefinition::GetTagsWithParents() const
+{
+	ConditionalBuildTagCache();
+	return TagsWithParents;
+}
+
+const FInventoryTagBitset& UItemDefinition::GetTagBits() const
+{
+	ConditionalBuildTagCache();
+	return TagBits;
+}
+
+const FInventoryTagBitset& UItemDefinition::GetTagBitsWithParents() const
+{
+	ConditionalBuildTagCache();
+	return TagBitsWithParents;
+}
+
+void UItemDefinition::ConditionalBuildTagCache() const
+{
+	if (bTagCacheBuilt)
+	{
+		return;
+	}
+
+	TagsWithParents = Tags.GetGameplayTagParents();
+	TagBits = FInventoryTagBitset::FromTags(Tags);
+	TagBitsWithParents = FInventoryTagBitset::FromTags(TagsWithParents);
+	bTagCacheBuilt = true;
+}
+
+void UItemDefinition::RebuildFragmentTable()
+{
+	FragmentTable.Reset();
+
+	for (UItemFragment* Fragment : Fragments)
+	{
+		if (!IsValid(Fragment))
+		{
+			continue;
+		}
+
+		// Registers the fragment class and its parents, the first fragment of each type being kept as in the linear search
+		for (const UClass* Class = Fragment->GetClass(); Class; Class = Class->GetSuperClass())
+		{
+			const int32 TypeId = UItemFragment::RegisterFragmentType(Class);
+			if (TypeId >= FragmentTable.Num())
+			{
+				FragmentTable.SetNumZeroed(TypeId + 1);
+			}
+			if (!FragmentTable[TypeId])
+			{
+				FragmentTable[TypeId] = Fragment;
+			}
+
+			if (Class == UItemFragment::StaticClass())
+			{
+				break;
+			}
+		}
+	}
+
+	bFragmentTableBuilt = true;
+}
+
 bool UItemDefinition::HasFragmentByClass(const TSubclassOf<UItemFragment> FragmentClass) const
 {
 	const bool bFound = FindFragmentByClass(FragmentClass) != nullptr;
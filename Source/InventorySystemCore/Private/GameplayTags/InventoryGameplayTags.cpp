@@ -25,4 +25,8 @@ namespace InventorySystemGameplayTags
 	UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Inventory_Failure_InvalidHandle, "Inventory.Failure.InvalidHandle", "Invalid inventory entry handle");
 	UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Inventory_Failure_HandleMismatch, "Inventory.Failure.HandleMismatch", "Invalid inventory entry handle");
 	UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Inventory_Failure_InvalidIndex, "Inventory.Failure.InvalidIndex", "Invalid inventory entry handle");
+	UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Inventory_Failure_Capacity, "Inventory.Failure.Capacity", "The container weight or stack capacity would be exceeded");
+	UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Inventory_Failure_NoSpace, "Inventory.Failure.NoSpace", "No free area of the grid container fits the item");
+	UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Inventory_Failure_Locked, "Inventory.Failure.Locked", "The entry is locked by a pending inventory transaction");
+	UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Inventory_Failure_Loading, "Inventory.Failure.Loading", "The inventory is being rebuilt by an asynchronous snapshot load");
 } // namespace InventorySystemGameplayTags
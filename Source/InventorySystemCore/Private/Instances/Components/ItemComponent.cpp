@@ -2,6 +2,8 @@
 
 #include "Instances/Components/ItemComponent.h"
 
+#include "Instances/ItemInstance.h"
+
 
 void UItemComponent::Initialize(UItemInstance& InInstance, UItemFragment* InSourceFragment)
 {
@@ -12,4 +14,12 @@ void UItemComponent::Initialize(UItemInstance& InInstance, UItemFragment* InSour
 UItemInstance* UItemComponent::GetOwningInstance()
 {
 	return OwningInstance;
+}
+
+void UItemComponent::NotifyPersistentStateChanged() const
+{
+	if (IsValid(OwningInstance))
+	{
+		OwningInstance->NotifyPersistentStateChanged();
+	}
 }
\ No newline at end of file
@@ -9,12 +9,26 @@
 #include "Instances/ItemInstance.h"
 #include "Log/InventorySystemLog.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 void UItemComponent_Consumable::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(UItemComponent_Consumable, RemainingUses);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UItemComponent_Consumable, RemainingUses, Params);
+}
+
+void UItemComponent_Consumable::SerializeSnapshot(FArchive& Ar)
+{
+	Ar << RemainingUses;
+	if (Ar.IsLoading())
+	{
+		// The maximum may have been lowered since the snapshot was taken
+		RemainingUses = FMath::Clamp(RemainingUses, 0, MaxUseCount);
+		MARK_PROPERTY_DIRTY_FROM_NAME(UItemComponent_Consumable, RemainingUses, this);
+	}
 }
 
 bool UItemComponent_Consumable::CanConsume(const int32 UseCount) const
@@ -55,6 +69,8 @@ void UItemComponent_Consumable::Consume(const int32 UseCount)
 		if (Succeeded)
 		{
 			RemainingUses -= UseCount;
+			MARK_PROPERTY_DIRTY_FROM_NAME(UItemComponent_Consumable, RemainingUses, this);
+			NotifyPersistentStateChanged();
 		}
 	}
 }
@@ -63,9 +79,13 @@ void UItemComponent_Consumable::SetRemainingUses(const int32 Count)
 {
 	UE_CLOG(Count > MaxUseCount, LogInventorySystem, Warning, TEXT("Tried to set remaining uses for consumable item [%s] to %d but clamps to maximum use count %d."), *GetNameSafe(OwningInstance->GetDefinitionClass()), Count, MaxUseCount);
 	RemainingUses = FMath::Clamp(Count, 0, MaxUseCount);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UItemComponent_Consumable, RemainingUses, this);
+	NotifyPersistentStateChanged();
 }
 
 void UItemComponent_Consumable::RestoreUses()
 {
 	RemainingUses = MaxUseCount;
+	MARK_PROPERTY_DIRTY_FROM_NAME(UItemComponent_Consumable, RemainingUses, this);
+	NotifyPersistentStateChanged();
 }
\ No newline at end of file
@@ -6,6 +6,12 @@
 #include "Definitions/Fragments/ItemFragment.h"
 #include "Interfaces/InventorySystemInterface.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Subsystems/ItemDefinitionRegistry.h"
+
+#if UE_WITH_IRIS
+#include "Iris/ReplicationSystem/ReplicationFragmentUtil.h"
+#endif
 
 UItemInstance::UItemInstance(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -13,18 +19,37 @@ UItemInstance::UItemInstance(const FObjectInitializer& ObjectInitializer)
 	OwningActor = GetTypedOuter<AActor>();
 }
 
+void UItemInstance::ChangeOuter(UObject* NewOuter)
+{
+	constexpr ERenameFlags RenameFlags = REN_DontCreateRedirectors | REN_DoNotDirty | REN_NonTransactional | REN_ForceNoResetLoaders;
+
+	const FName NewName = MakeUniqueObjectName(NewOuter, GetClass(), GetClass()->GetFName());
+	Rename(*NewName.ToString(), NewOuter, RenameFlags);
+	OwningActor = GetTypedOuter<AActor>();
+}
+
 void UItemInstance::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	UObject::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ThisClass, DefinitionClass);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, Header, Params);
 }
 
+#if UE_WITH_IRIS
+void UItemInstance::RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags)
+{
+	// Builds the replication state descriptors of the replicated properties, fast arrays included
+	UE::Net::FReplicationFragmentUtil::CreateAndRegisterFragmentsForObject(this, Context, RegistrationFlags);
+}
+#endif
+
 void UItemInstance::GetOwnedGameplayTags(FGameplayTagContainer& TagContainer) const
 {
-	if (IsValid(Definition.Get()))
+	if (const UItemDefinition* ItemDefinition = GetDefinition(); IsValid(ItemDefinition))
 	{
-		Definition->GetOwnedGameplayTags(TagContainer);
+		ItemDefinition->GetOwnedGameplayTags(TagContainer);
 	}
 	TagContainer.AppendTags(Tags);
 }
@@ -48,22 +73,58 @@ void UItemInstance::Uninitialize()
 {
 	for (UItemComponent* Component : Components)
 	{
-		Component->Uninitialize();
+		if (IsValid(Component))
+		{
+			Component->Uninitialize();
+			DormantComponents.Add(Component);
+		}
+	}
+	Components.Reset();
+
+	Definition.Reset();
+	Header.DefinitionClass = nullptr;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Header, this);
+	Tags.Reset();
+}
+
+void UItemInstance::AddTag(const FGameplayTag Tag)
+{
+	if (Tag.IsValid() && !Tags.HasTagExact(Tag))
+	{
+		Tags.AddTag(Tag);
+		NotifyPersistentStateChanged();
+	}
+}
+
+void UItemInstance::RemoveTag(const FGameplayTag Tag)
+{
+	if (Tags.RemoveTag(Tag))
+	{
+		NotifyPersistentStateChanged();
+	}
+}
+
+void UItemInstance::NotifyPersistentStateChanged()
+{
+	if (UInventorySystemComponent* InventorySystem = GetInventorySystemComponent())
+	{
+		InventorySystem->NotifyInstanceStateChanged(this);
 	}
 }
 
 UInventorySystemComponent* UItemInstance::GetInventorySystemComponent() const
 {
-	if (!IsValid(OwningActor) || !OwningActor->Implements<UInventorySystemInterface>())
+	if (!IsValid(OwningActor))
 	{
 		return nullptr;
 	}
 
+	// Actors not implementing the interface are searched for their inventory component
 	if (const IInventorySystemInterface* Implementer = Cast<IInventorySystemInterface>(OwningActor))
 	{
 		return Implementer->GetInventorySystemComponent();
 	}
-	return nullptr;
+	return OwningActor->FindComponentByClass<UInventorySystemComponent>();
 }
 
 AActor* UItemInstance::GetOwningActor() const
@@ -73,19 +134,25 @@ AActor* UItemInstance::GetOwningActor() const
 
 TSubclassOf<UItemDefinition> UItemInstance::GetDefinitionClass() const
 {
-	return DefinitionClass;
+	return Header.DefinitionClass;
 }
 
 UItemDefinition* UItemInstance::GetDefinition() const
 {
-	return Definition.Get();
+	if (UItemDefinition* ItemDefinition = Definition.Get())
+	{
+		return ItemDefinition;
+	}
+
+	// Not resolved yet, e.g. queried before the replication notify
+	return Header.DefinitionClass ? UItemDefinitionRegistry::ResolveDefinition(Header.DefinitionClass) : nullptr;
 }
 
 const UItemFragment* UItemInstance::FindFragmentByClass(const TSubclassOf<UItemFragment> FragmentClass) const
 {
-	if (Definition.IsValid() && IsValid(FragmentClass))
+	if (const UItemDefinition* ItemDefinition = GetDefinition(); ItemDefinition && IsValid(FragmentClass))
 	{
-		return Definition->FindFragmentByClass(FragmentClass);
+		return ItemDefinition->FindFragmentByClass(FragmentClass);
 	}
 
 	return nullptr;
@@ -93,9 +160,9 @@ const UItemFragment* UItemInstance::FindFragmentByClass(const TSubclassOf<UItemF
 
 bool UItemInstance::HasFragmentByClass(const TSubclassOf<UItemFragment> FragmentClass) const
 {
-	if (Definition.IsValid() && IsValid(FragmentClass))
+	if (const UItemDefinition* ItemDefinition = GetDefinition(); ItemDefinition && IsValid(FragmentClass))
 	{
-		return Definition->HasFragmentByClass(FragmentClass);
+		return ItemDefinition->HasFragmentByClass(FragmentClass);
 	}
 
 	return false;
@@ -103,7 +170,25 @@ bool UItemInstance::HasFragmentByClass(const TSubclassOf<UItemFragment> Fragment
 
 UItemComponent* UItemInstance::AddComponent(const TSubclassOf<UItemComponent> ComponentClass)
 {
-	if (UItemComponent* Component = NewObject<UItemComponent>(this, ComponentClass); IsValid(Component))
+	if (!IsValid(ComponentClass))
+	{
+		return nullptr;
+	}
+
+	// Reuse a component left by a previous initialization of this instance
+	UItemComponent* Component = nullptr;
+	if (const int32 DormantIndex = DormantComponents.IndexOfByPredicate([ComponentClass](const UItemComponent* Dormant) { return Dormant && Dormant->GetClass() == ComponentClass; });
+		DormantIndex != INDEX_NONE)
+	{
+		Component = DormantComponents[DormantIndex];
+		DormantComponents.RemoveAtSwap(DormantIndex, EAllowShrinking::No);
+	}
+	else
+	{
+		Component = NewObject<UItemComponent>(this, ComponentClass);
+	}
+
+	if (IsValid(Component))
 	{
 		Component->Initialize(*this);
 		Components.Add(Component);
@@ -126,7 +211,13 @@ void UItemInstance::PostInitialize()
 void UItemInstance::SetDefinition(UItemDefinition* InDefinition)
 {
 	Definition = InDefinition;
-	DefinitionClass = InDefinition->GetClass();
+	Header.DefinitionClass = InDefinition->GetClass();
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Header, this);
+}
+
+void UItemInstance::OnRep_Header()
+{
+	Definition = UItemDefinitionRegistry::ResolveDefinition(Header.DefinitionClass);
 }
 
 const UItemComponent* UItemInstance::FindComponentByClass(const TSubclassOf<UItemComponent> ComponentClass) const
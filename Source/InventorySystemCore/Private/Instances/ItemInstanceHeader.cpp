@@ -0,0 +1,12 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Instances/ItemInstanceHeader.h"
+
+#include "Data/DefinitionNetIdTable.h"
+#include "Definitions/ItemDefinition.h"
+
+bool FItemInstanceHeader::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = FDefinitionNetIdTable::NetSerializeClass(Ar, Map, DefinitionClass);
+	return true;
+}
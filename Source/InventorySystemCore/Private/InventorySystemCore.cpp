@@ -1,13 +1,19 @@
 ﻿#include "InventorySystemCore.h"
 
+#include "Data/DefinitionNetIdTable.h"
+#include "Definitions/ItemDefinition.h"
+
 #define LOCTEXT_NAMESPACE "FInventorySystemCoreModule"
 
 void FInventorySystemCoreModule::StartupModule()
 {
+	FDefinitionNetIdTable::RegisterBaseClass(UItemDefinition::StaticClass());
+	FDefinitionNetIdTable::BindNetworkVersion();
 }
 
 void FInventorySystemCoreModule::ShutdownModule()
 {
+	FDefinitionNetIdTable::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,20 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Settings/InventoryReplicationRule.h"
+
+const FInventoryReplicationRule* FInventoryReplicationRule::FindRule(const TMap<FGameplayTag, FInventoryReplicationRule>& Rules, const FGameplayTag& ContainerTag)
+{
+	if (Rules.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	for (FGameplayTag Tag = ContainerTag; Tag.IsValid(); Tag = Tag.RequestDirectParent())
+	{
+		if (const FInventoryReplicationRule* Rule = Rules.Find(Tag))
+		{
+			return Rule;
+		}
+	}
+	return nullptr;
+}
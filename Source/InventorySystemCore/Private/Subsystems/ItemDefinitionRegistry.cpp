@@ -0,0 +1,46 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Subsystems/ItemDefinitionRegistry.h"
+
+#include "Data/InventoryCache.h"
+#include "Definitions/ItemDefinition.h"
+#include "Engine/Engine.h"
+
+void UItemDefinitionRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Cache = NewObject<UInventoryCache>(this);
+}
+
+void UItemDefinitionRegistry::Deinitialize()
+{
+	Cache = nullptr;
+
+	Super::Deinitialize();
+}
+
+UItemDefinitionRegistry* UItemDefinitionRegistry::Get()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UItemDefinitionRegistry>() : nullptr;
+}
+
+UItemDefinition* UItemDefinitionRegistry::ResolveDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass)
+{
+	if (const UItemDefinitionRegistry* Registry = Get())
+	{
+		return Registry->GetDefinition(DefinitionClass);
+	}
+
+	// Commandlets and early startup code run without engine subsystems, definitions are shared anyway
+	return IsValid(DefinitionClass) ? DefinitionClass->GetDefaultObject<UItemDefinition>() : nullptr;
+}
+
+UItemDefinition* UItemDefinitionRegistry::GetDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass) const
+{
+	if (IsValid(Cache))
+	{
+		return Cache->GetCachedDefinition(DefinitionClass);
+	}
+	return IsValid(DefinitionClass) ? DefinitionClass->GetDefaultObject<UItemDefinition>() : nullptr;
+}
@@ -0,0 +1,107 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Subsystems/ItemInstancePool.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Instances/ItemInstance.h"
+#include "Settings/InventorySystemSettings.h"
+
+bool UItemInstancePool::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer) && GetDefault<UInventorySystemSettings>()->bPoolItemInstances;
+}
+
+void UItemInstancePool::Deinitialize()
+{
+	Buckets.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UItemInstancePool::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+UItemInstance* UItemInstancePool::AcquireInstance(AActor* OwnerActor, const TSubclassOf<UItemInstance> InstanceClass)
+{
+	if (!IsValid(OwnerActor) || !InstanceClass)
+	{
+		return nullptr;
+	}
+
+	if (const UWorld* World = OwnerActor->GetWorld())
+	{
+		if (UItemInstancePool* Pool = World->GetSubsystem<UItemInstancePool>())
+		{
+			return Pool->Acquire(OwnerActor, InstanceClass);
+		}
+	}
+
+	return NewObject<UItemInstance>(OwnerActor, InstanceClass);
+}
+
+void UItemInstancePool::ReleaseInstance(UItemInstance* Instance)
+{
+	if (!IsValid(Instance))
+	{
+		return;
+	}
+
+	// Without a pool the instance is left as is to the garbage collector, it may still be read by the last listeners
+	const UWorld* World = Instance->GetWorld();
+	if (UItemInstancePool* Pool = World ? World->GetSubsystem<UItemInstancePool>() : nullptr)
+	{
+		Pool->Release(Instance);
+	}
+}
+
+int32 UItemInstancePool::GetPooledCount(const TSubclassOf<UItemInstance> InstanceClass) const
+{
+	const FItemInstancePoolBucket* Bucket = Buckets.Find(InstanceClass.Get());
+	return Bucket ? Bucket->Instances.Num() : 0;
+}
+
+UItemInstance* UItemInstancePool::Acquire(AActor* OwnerActor, const TSubclassOf<UItemInstance> InstanceClass)
+{
+	if (FItemInstancePoolBucket* Bucket = Buckets.Find(InstanceClass.Get()); Bucket && !Bucket->Instances.IsEmpty())
+	{
+		// Instances are released in order, the oldest one is the first to become reusable
+		const FPooledItemInstance& Oldest = Bucket->Instances[0];
+		if (Oldest.ReusableTime <= FPlatformTime::Seconds())
+		{
+			UItemInstance* Instance = Oldest.Instance;
+			Bucket->Instances.RemoveAt(0, EAllowShrinking::No);
+
+			if (IsValid(Instance))
+			{
+				Instance->ChangeOuter(OwnerActor);
+				return Instance;
+			}
+		}
+	}
+
+	return NewObject<UItemInstance>(OwnerActor, InstanceClass);
+}
+
+void UItemInstancePool::Release(UItemInstance* Instance)
+{
+	const UInventorySystemSettings* Settings = GetDefault<UInventorySystemSettings>();
+	FItemInstancePoolBucket& Bucket = Buckets.FindOrAdd(Instance->GetClass());
+	if (Bucket.Instances.Num() >= Settings->MaxPooledInstances)
+	{
+		// Pool is full, let the garbage collector reclaim the instance
+		return;
+	}
+
+	// Only pooled instances are reset, the others keep their state until collected
+	Instance->Uninitialize();
+
+	// Detach from the previous owner, which may be destroyed before the instance is reused
+	Instance->ChangeOuter(this);
+
+	FPooledItemInstance& Pooled = Bucket.Instances.AddDefaulted_GetRef();
+	Pooled.Instance = Instance;
+	Pooled.ReusableTime = FPlatformTime::Seconds() + Settings->PooledInstanceReuseDelay;
+}
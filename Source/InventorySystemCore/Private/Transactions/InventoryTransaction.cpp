@@ -0,0 +1,310 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "Transactions/InventoryTransaction.h"
+
+#include "Components/InventorySystemComponent.h"
+#include "Containers/InventoryContainer.h"
+#include "GameplayTags/InventoryGameplayTags.h"
+#include "Instances/ItemInstance.h"
+#include "Log/InventorySystemLog.h"
+
+void UInventoryTransaction::BeginDestroy()
+{
+	// A transaction dropped while open must not keep its entries locked
+	if (State == EInventoryTransactionState::Open)
+	{
+		Cancel();
+	}
+
+	Super::BeginDestroy();
+}
+
+UInventoryTransaction* UInventoryTransaction::BeginTransaction(UObject* Outer)
+{
+	return NewObject<UInventoryTransaction>(Outer ? Outer : GetTransientPackage());
+}
+
+bool UInventoryTransaction::AddLeg(const FInventoryEntryHandle& Handle, UInventoryContainer* TargetContainer, const int32 Count, FGameplayTag& OutFailureReason)
+{
+	if (State != EInventoryTransactionState::Open)
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Internal;
+		return false;
+	}
+
+	UInventoryContainer* SourceContainer = Handle.Container;
+	if (!Handle.IsHandleValid() || !IsValid(SourceContainer) || SourceContainer->IsHandleStale(Handle))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
+		return false;
+	}
+	if (!IsValid(SourceContainer->OwnerComponent) || !SourceContainer->OwnerComponent->GetOwner()->HasAuthority())
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_NotAuthority;
+		return false;
+	}
+	if (!IsValid(TargetContainer) || TargetContainer == SourceContainer || !IsValid(TargetContainer->OwnerComponent))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidContainer;
+		return false;
+	}
+	if (!SourceContainer->OwnerComponent->CanModifyContent(OutFailureReason) || !TargetContainer->OwnerComponent->CanModifyContent(OutFailureReason))
+	{
+		return false;
+	}
+
+	FInventoryList& SourceList = SourceContainer->InventoryList;
+	const FInventoryEntry& Entry = SourceList.Entries[SourceList.FindEntryIndex(Handle)];
+	if (Count <= 0 || Count > Entry.StackCount)
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidCount;
+		return false;
+	}
+	if (SourceList.IsEntryLocked(Entry.EntryId))
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Locked;
+		return false;
+	}
+
+	SourceList.LockedEntries.Add(Entry.EntryId);
+
+	FInventoryTransactionLeg& Leg = Legs.AddDefaulted_GetRef();
+	Leg.Handle = Handle;
+	Leg.TargetContainer = TargetContainer;
+	Leg.Count = Count;
+
+	OutFailureReason = FGameplayTag::EmptyTag;
+	return true;
+}
+
+bool UInventoryTransaction::Validate(FGameplayTag& OutFailureReason) const
+{
+	if (State != EInventoryTransactionState::Open)
+	{
+		OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_Internal;
+		return false;
+	}
+
+	// Additions of each receiving container, planned in the order the legs are applied
+	TMap<UInventoryContainer*, TArray<FInventoryCapacityRequest, TInlineAllocator<4>>, TInlineSetAllocator<4>> Additions;
+	TMap<UInventoryContainer*, TMap<TSubclassOf<UItemDefinition>, int32>, TInlineSetAllocator<4>> PlannedFreeRoom;
+	TMap<TPair<UInventoryContainer*, TSubclassOf<UItemDefinition>>, int32, TInlineSetAllocator<8>> PlannedNewStacks;
+
+	for (const FInventoryTransactionLeg& Leg : Legs)
+	{
+		const FInventoryEntry* Entry = FindSourceEntry(Leg);
+		if (!Entry)
+		{
+			OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidHandle;
+			return false;
+		}
+		if (Leg.Count > Entry->StackCount)
+		{
+			OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidCount;
+			return false;
+		}
+		if (!IsValid(Leg.TargetContainer) || !IsValid(Leg.TargetContainer->OwnerComponent))
+		{
+			OutFailureReason = InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidContainer;
+			return false;
+		}
+
+		// A load started since the leg was added would overwrite the commit
+		if (!Leg.Handle.Container->OwnerComponent->CanModifyContent(OutFailureReason) || !Leg.TargetContainer->OwnerComponent->CanModifyContent(OutFailureReason))
+		{
+			return false;
+		}
+
+		const TSubclassOf<UItemDefinition> DefinitionClass = Entry->GetDefinitionClass();
+		if (!Leg.TargetContainer->InventoryList.CanAddDefinition(DefinitionClass, OutFailureReason))
+		{
+			return false;
+		}
+
+		// Whole stacks keep their instance and get their own stack, other items are merged by definition
+		const bool bMovesInstance = Entry->Instance && Leg.Count == Entry->StackCount;
+		if (bMovesInstance && !Leg.TargetContainer->ValidateStorage(Entry->Instance, OutFailureReason))
+		{
+			return false;
+		}
+
+		UInventoryContainer* TargetContainer = Leg.TargetContainer;
+		TMap<TSubclassOf<UItemDefinition>, int32>& FreeRoom = PlannedFreeRoom.FindOrAdd(TargetContainer);
+		const int32 NewStacks = TargetContainer->InventoryList.PlanNewStacks(DefinitionClass, Leg.Count, bMovesInstance, FreeRoom);
+		PlannedNewStacks.FindOrAdd({TargetContainer, DefinitionClass}) += NewStacks;
+		Additions.FindOrAdd(TargetContainer).Add({DefinitionClass, Leg.Count, NewStacks});
+	}
+
+	// Each moved instance is a stack of its own, unique items are checked against every stack received
+	for (const auto& [Key, NewStacks] : PlannedNewStacks)
+	{
+		const auto& [TargetContainer, DefinitionClass] = Key;
+		if (!TargetContainer->InventoryList.CanAddStacks(DefinitionClass, NewStacks, OutFailureReason))
+		{
+			return false;
+		}
+	}
+
+	// Every addition to a container must fit together, including the grid placement of the new stacks
+	for (const auto& [TargetContainer, Requests] : Additions)
+	{
+		if (!TargetContainer->ValidateCapacityBatch(Requests, OutFailureReason))
+		{
+			return false;
+		}
+	}
+
+	OutFailureReason = FGameplayTag::EmptyTag;
+	return true;
+}
+
+bool UInventoryTransaction::Commit(FGameplayTag& OutFailureReason)
+{
+	if (!Validate(OutFailureReason))
+	{
+		return false;
+	}
+
+	// Each participating component reports its changes once, when the scopes end
+	TArray<UInventorySystemComponent*, TInlineAllocator<4>> Components;
+	for (const FInventoryTransactionLeg& Leg : Legs)
+	{
+		Components.AddUnique(Leg.Handle.Container->OwnerComponent);
+		Components.AddUnique(Leg.TargetContainer->OwnerComponent);
+	}
+	TArray<TUniquePtr<FInventoryChangeScope>, TInlineAllocator<4>> ChangeScopes;
+	for (UInventorySystemComponent* Component : Components)
+	{
+		ChangeScopes.Add(MakeUnique<FInventoryChangeScope>(Component));
+	}
+
+	struct FPendingAddition
+	{
+		TSubclassOf<UItemDefinition> DefinitionClass;
+		UItemInstance* Instance = nullptr;
+	};
+	TArray<FPendingAddition, TInlineAllocator<8>> Additions;
+
+	// Removals first, so that moved instances are unregistered from their source before being added
+	for (const FInventoryTransactionLeg& Leg : Legs)
+	{
+		FInventoryList& SourceList = Leg.Handle.Container->InventoryList;
+		const int32 Index = SourceList.FindEntryIndex(Leg.Handle);
+		const FInventoryEntry& Entry = SourceList.Entries[Index];
+		SourceList.LockedEntries.Remove(Entry.EntryId);
+
+		FPendingAddition& Addition = Additions.AddDefaulted_GetRef();
+		Addition.DefinitionClass = Entry.GetDefinitionClass();
+
+		if (Leg.Count == Entry.StackCount)
+		{
+			Addition.Instance = Entry.Instance;
+			SourceList.Internal_OnEntryRemoved(Index, Entry);
+			SourceList.Internal_RemoveEntryAt(Index);
+		}
+		else
+		{
+			SourceList.SetEntryStackCount(Index, Entry.StackCount - Leg.Count);
+		}
+	}
+
+	bool bApplied = true;
+	for (int32 LegIndex = 0; LegIndex < Legs.Num(); ++LegIndex)
+	{
+		const FInventoryTransactionLeg& Leg = Legs[LegIndex];
+		const FPendingAddition& Addition = Additions[LegIndex];
+		UInventoryContainer* SourceContainer = Leg.Handle.Container;
+		UInventoryContainer* TargetContainer = Leg.TargetContainer;
+
+		FInventoryResult Result;
+		const int32 AddedCount = AddItems(SourceContainer, TargetContainer, Addition.DefinitionClass, Addition.Instance, Leg.Count, Result);
+		TargetContainer->OwnerComponent->RegisterReplicatedInstances(Result);
+		if (AddedCount == Leg.Count)
+		{
+			continue;
+		}
+
+		// Never lost: what the target refused goes back to the source, which just released the room it takes
+		UE_LOG(LogInventorySystem, Error, TEXT("Validated transaction leg of %s could not be applied: %s. %d items are given back."),
+			*GetNameSafe(Addition.DefinitionClass), *Result.FailureReason.ToString(), Leg.Count - AddedCount);
+		bApplied = false;
+		OutFailureReason = Result.FailureReason.IsValid() ? Result.FailureReason : InventorySystemGameplayTags::TAG_Inventory_Failure_Internal;
+
+		FInventoryResult GivenBack;
+		AddItems(TargetContainer, SourceContainer, Addition.DefinitionClass, AddedCount == 0 ? Addition.Instance : nullptr, Leg.Count - AddedCount, GivenBack);
+		SourceContainer->OwnerComponent->RegisterReplicatedInstances(GivenBack);
+	}
+
+	State = EInventoryTransactionState::Committed;
+	return bApplied;
+}
+
+int32 UInventoryTransaction::AddItems(UInventoryContainer* FromContainer, UInventoryContainer* ToContainer, const TSubclassOf<UItemDefinition>& DefinitionClass, UItemInstance* Instance, const int32 Count, FInventoryResult& OutResult)
+{
+	UInventorySystemComponent* FromComponent = FromContainer->OwnerComponent;
+	UInventorySystemComponent* ToComponent = ToContainer->OwnerComponent;
+	FInventoryList& ToList = ToContainer->InventoryList;
+
+	if (Instance)
+	{
+		if (FromComponent != ToComponent)
+		{
+			// The clients of the giver drop their copy, the instance then replicates from the receiving actor only
+			if (FromComponent->IsUsingRegisteredSubObjectList() && FromComponent->IsReadyForReplication())
+			{
+				FromComponent->DestroyReplicatedSubObjectOnRemotePeers(Instance);
+			}
+			Instance->ChangeOuter(ToComponent->GetOwner());
+		}
+		OutResult = ToList.AddInstance(Instance, Count);
+		return OutResult.Succeeded() ? Count : 0;
+	}
+
+	const int32 CountBefore = ToList.GetTotalCountByDefinition(DefinitionClass);
+	const int32 RemainingCount = ToList.TopUpStacks(DefinitionClass, Count, OutResult);
+	ToList.CreateStacks(DefinitionClass, RemainingCount, OutResult);
+	return ToList.GetTotalCountByDefinition(DefinitionClass) - CountBefore;
+}
+
+void UInventoryTransaction::Cancel()
+{
+	if (State != EInventoryTransactionState::Open)
+	{
+		return;
+	}
+
+	ReleaseLocks();
+	State = EInventoryTransactionState::Cancelled;
+}
+
+const FInventoryEntry* UInventoryTransaction::FindSourceEntry(const FInventoryTransactionLeg& Leg) const
+{
+	const UInventoryContainer* SourceContainer = Leg.Handle.Container;
+	if (!IsValid(SourceContainer))
+	{
+		return nullptr;
+	}
+
+	const FInventoryList& SourceList = SourceContainer->InventoryList;
+	const int32 Index = SourceList.FindEntryIndex(Leg.Handle);
+	return Index != INDEX_NONE ? &SourceList.Entries[Index] : nullptr;
+}
+
+void UInventoryTransaction::ReleaseLocks()
+{
+	for (const FInventoryTransactionLeg& Leg : Legs)
+	{
+		// Containers may already be unreachable when an open transaction is garbage collected along with them
+		UInventoryContainer* SourceContainer = Leg.Handle.Container;
+		if (!IsValid(SourceContainer) || SourceContainer->IsUnreachable())
+		{
+			continue;
+		}
+
+		// A stale entry has lost its lock when removed, the slot may since be locked for another entry
+		if (!SourceContainer->IsHandleStale(Leg.Handle))
+		{
+			SourceContainer->InventoryList.LockedEntries.Remove(Leg.Handle.EntryId);
+		}
+	}
+}
@@ -5,13 +5,15 @@
 #include "Components/ActorComponent.h"
 #include "CoreMinimal.h"
 #include "Containers/InventoryContainer.h"
-#include "Data/InventoryCache.h"
+#include "Data/InventoryJournal.h"
 #include "Data/InventoryList.h"
+#include "Data/InventoryPrediction.h"
 #include "Definitions/ItemDefinition.h"
 #include "GameplayTags/InventoryGameplayTags.h"
 
 #include "InventorySystemComponent.generated.h"
 
+class FInventorySnapshotLoader;
 class UInventorySet;
 struct FGameplayTag;
 class UEquipmentComponent;
@@ -23,6 +25,32 @@ class UEquipmentComponent;
  */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryChange, const FInventoryChangeData&, Data);
 
+/**
+ * Multicast delegate that broadcasts a set of coalesced inventory changes at once
+ * @param Changes The changes, in the order the entries were first modified
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryBatchChange, const TArray<FInventoryChangeData>&, Changes);
+
+/**
+ * Multicast delegate that broadcasts the lifecycle steps of a client prediction
+ * @param Change The predicted change
+ * @param State The step reached by the prediction, listeners should refresh the predicted counts
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnInventoryPredictionChange, const FInventoryPredictedChange&, Change, EInventoryPredictionState, State);
+
+/**
+ * Delegate called on the game thread once an asynchronous snapshot has been written
+ * @param Data The snapshot
+ * @return True once the snapshot is persisted, a checkpoint only restarting the change journal then
+ */
+DECLARE_DYNAMIC_DELEGATE_RetVal_OneParam(bool, FOnInventorySnapshotSaved, const TArray<uint8>&, Data);
+
+/**
+ * Delegate called on the game thread once an asynchronous snapshot load has ended
+ * @param bSuccess False if the data is not a valid snapshot or the inventory has no authority
+ */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnInventorySnapshotLoaded, bool, bSuccess);
+
 /**
  * @class UInventorySystemComponent
  * @see UActorComponent
@@ -39,13 +67,16 @@ class INVENTORYSYSTEMCORE_API UInventorySystemComponent : public UActorComponent
 	GENERATED_BODY()
 
 	friend FInventoryList;
+	friend struct FInventoryChangeScope;
+	friend class FInventorySnapshot;
+	friend class FInventorySnapshotLoader;
+	friend class UInventoryTransaction;
 
 public:
 	UInventorySystemComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 	// UObject
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
-	virtual bool ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
 	virtual void ReadyForReplication() override;
 	// ~UObject
 
@@ -65,14 +96,215 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Inventory")
 	FInventoryResult TryAddItemInstance(UItemInstance* ItemInstance, int32 StackCount);
 
+	/**
+	 * Adds several item definitions, possibly to different containers, in a single pass
+	 * @details Each distinct definition is validated once per container, and the requests of a container are validated
+	 * together before the first modification, see UInventoryContainer::TryAddItemDefinitions. The created instances are
+	 * registered for replication together and the changes are reported by a single OnInventoryBatchChanged event.
+	 * @param Requests The definitions, counts and target containers of the items to add
+	 * @return One result per request, in the same order
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory")
+	FInventoryBatchResult TryAddItemDefinitions(const TArray<FInventoryAddRequest>& Requests);
+
 	UFUNCTION(BlueprintCallable, Category="Inventory")
 	bool TryRemoveFromHandle(FInventoryEntryHandle Handle, FGameplayTag& OutFailureReason);
+	/**
+	 * Removes an entry and destroys its item instance, which is recycled by the UItemInstancePool when pooling is
+	 * enabled. Unlike TryRemoveFromHandle, the instance must not be kept by the caller, e.g. to be dropped in the world.
+	 * @param Handle The handle of the entry to destroy
+	 * @param OutFailureReason The reason of the failure, if any
+	 * @return True if the entry was removed
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory")
+	bool TryDestroyFromHandle(FInventoryEntryHandle Handle, FGameplayTag& OutFailureReason);
 	UFUNCTION(BlueprintCallable, Category="Inventory")
 	FInventoryResult TryMoveByHandle(FInventoryEntryHandle Handle, UInventoryContainer* TargetContainer);
 
+	/**
+	 * Moves some items of a stack to another container of this inventory as a single operation
+	 * @details The items are merged into the existing stacks of the target first, the rest being stored in new stacks.
+	 * A whole stack keeps its item instance, a partial one is split from the source stack. Every check is done before
+	 * the first modification, so a refused transfer leaves both containers untouched, and the changes of both
+	 * containers are reported by a single OnInventoryBatchChanged event.
+	 * @param Handle The handle of the source stack
+	 * @param TargetContainer The container receiving the items, registered in this component
+	 * @param Count The number of items to move, at most the count of the source stack
+	 * @return The instances of the modified and created target stacks, or the failure reason
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory")
+	FInventoryResult TryTransferItems(FInventoryEntryHandle Handle, UInventoryContainer* TargetContainer, int32 Count);
+
+	/**
+	 * Removes some items of a stack and destroys them, the whole entry being destroyed when its count reaches zero
+	 * @param Handle The handle of the stack
+	 * @param Count The number of items to consume, at most the count of the stack
+	 * @param OutFailureReason The reason of the failure, if any
+	 * @return True if the items were consumed
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory")
+	bool TryConsumeFromHandle(FInventoryEntryHandle Handle, int32 Count, FGameplayTag& OutFailureReason);
+
+	/**
+	 * Consumes items on the owning client ahead of the server, see TryConsumeFromHandle. Runs directly on authority
+	 * @details The replicated state is not modified: the consumption shows in GetPredictedStackCount and
+	 * GetPredictedTotalCountByDefinitionIn, which UI should read, until the server answers
+	 * @param Handle The handle of the stack
+	 * @param Count The number of items to consume
+	 * @param OutPredictionKey The key of the prediction, zero when run on authority
+	 * @param OutFailureReason The reason of the failure, if any
+	 * @return True if the consumption was predicted, or done on authority
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Prediction")
+	bool PredictConsumeItems(FInventoryEntryHandle Handle, int32 Count, int32& OutPredictionKey, FGameplayTag& OutFailureReason);
+
+	/**
+	 * Moves items on the owning client ahead of the server, see TryTransferItems. Runs directly on authority
+	 * @details The replicated state is not modified: the move shows in the predicted getters until the server answers
+	 * @param Handle The handle of the source stack
+	 * @param TargetContainer The container receiving the items, registered in this component
+	 * @param Count The number of items to move
+	 * @param OutPredictionKey The key of the prediction, zero when run on authority
+	 * @param OutFailureReason The reason of the failure, if any
+	 * @return True if the transfer was predicted, or done on authority
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Prediction")
+	bool PredictTransferItems(FInventoryEntryHandle Handle, UInventoryContainer* TargetContainer, int32 Count, int32& OutPredictionKey, FGameplayTag& OutFailureReason);
+
+	/**
+	 * Answers a prediction of the owning client. Called by the server RPCs after applying or refusing the predicted change
+	 * @param PredictionKey The key received from the client
+	 * @param bAccepted True if the change was applied, false to roll it back on the client
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Inventory|Prediction")
+	void AcknowledgePrediction(int32 PredictionKey, bool bAccepted);
+
+	/**
+	 * Gets the number of items of a definition in a container, including the pending predictions
+	 * @param DefinitionClass The item definition
+	 * @param ContainerTag The tag of the container
+	 * @return The predicted number of items
+	 */
+	UFUNCTION(BlueprintPure, Category="Inventory|Prediction", meta = (Categories = "Inventory.Container"))
+	int32 GetPredictedTotalCountByDefinitionIn(TSubclassOf<UItemDefinition> DefinitionClass, const FGameplayTag& ContainerTag) const;
+
+	/**
+	 * Gets the count of a stack, including the pending predictions
+	 * @param Handle The handle of the stack
+	 * @return The predicted count, zero if the stack is predicted to be emptied or no longer exists
+	 */
+	UFUNCTION(BlueprintPure, Category="Inventory|Prediction")
+	int32 GetPredictedStackCount(const FInventoryEntryHandle& Handle) const;
+
+	/** @return The pending predictions of this client */
+	const TArray<FInventoryPredictedChange>& GetPendingPredictions() const { return PredictionOverlay.GetPredictions(); }
+
+	/**
+	 * Removes every entry of every container and destroys their item instances, recycled when pooling is enabled.
+	 * An asynchronous snapshot load in progress is cancelled
+	 */
 	UFUNCTION(BlueprintCallable, Category="Inventory")
 	void Empty();
 
+	/**
+	 * Writes the containers of this inventory in a compact binary snapshot, see FInventorySnapshot
+	 * @param OutData Receives the snapshot
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Persistence")
+	void SaveSnapshot(TArray<uint8>& OutData);
+
+	/**
+	 * Replaces the content of this inventory with a snapshot written by SaveSnapshot. Authority only
+	 * @param Data The snapshot
+	 * @return False if the data is not a valid snapshot or the inventory has no authority
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Persistence")
+	bool LoadSnapshot(const TArray<uint8>& Data);
+
+	/**
+	 * Enables or disables the change journal, see FInventoryJournal. Authority only
+	 * The journal restarts empty: take a checkpoint right after enabling it
+	 * @param bEnable If true, every change is appended to the journal
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Persistence")
+	void SetJournalChanges(bool bEnable);
+
+	/**
+	 * Writes a snapshot and restarts the change journal, which then only holds the changes made after this snapshot
+	 * @param OutSnapshot Receives the snapshot
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Persistence")
+	void SaveCheckpoint(TArray<uint8>& OutSnapshot);
+
+	/**
+	 * Replaces the content of this inventory with a checkpoint snapshot and the journal started after it, e.g. after
+	 * a crash. The journal restarts empty from the loaded state: take a new checkpoint, or compact the journal into
+	 * the checkpoint, see FInventoryJournal::Compact
+	 * @param Snapshot The checkpoint snapshot
+	 * @param JournalData The journal started after the checkpoint
+	 * @return False if the data could not be read or the inventory has no authority
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Persistence")
+	bool LoadSnapshotWithJournal(const TArray<uint8>& Snapshot, const TArray<uint8>& JournalData);
+
+	/**
+	 * Captures the containers on the game thread, then encodes the snapshot on a worker task
+	 * The capture still serializes every instance and its components on the game thread, only the encoding is moved
+	 * @param bCheckpoint If true, the change journal restarts from the captured state once OnSaved returns true, see
+	 * SaveCheckpoint. Until then, the changes are journaled both since the previous checkpoint and since the capture
+	 * @param OnSaved Called on the game thread with the snapshot
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Persistence")
+	void SaveSnapshotAsync(bool bCheckpoint, FOnInventorySnapshotSaved OnSaved);
+
+	/**
+	 * Replaces the content of this inventory with a snapshot without hitching the game thread. Authority only
+	 * The snapshot is decoded and validated on a worker task, then its entries are materialized over several frames
+	 * within SnapshotLoadBudget. A load in progress is cancelled. The inventory is left untouched if the data is invalid.
+	 * Changes are refused until the load ends, see CanModifyContent
+	 * @param Data The snapshot, copied
+	 * @param OnLoaded Called on the game thread once the load has ended
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Persistence")
+	void LoadSnapshotAsync(const TArray<uint8>& Data, FOnInventorySnapshotLoaded OnLoaded);
+
+	/** @return True while an asynchronous snapshot load is running, the content being incomplete */
+	UFUNCTION(BlueprintPure, Category="Inventory|Persistence")
+	bool IsLoadingSnapshot() const;
+
+	/**
+	 * Checks whether the content of this inventory may be modified, which is refused while an asynchronous snapshot
+	 * load is running: the load would empty or overwrite the changes
+	 * @param OutFailureReason Set to TAG_Inventory_Failure_Loading when refused
+	 * @return False while IsLoadingSnapshot, except for the entries materialized by the load itself
+	 */
+	bool CanModifyContent(FGameplayTag& OutFailureReason) const;
+
+	/** Stops the asynchronous snapshot load in progress, the entries materialized so far being kept */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Persistence")
+	void CancelSnapshotLoad();
+
+	/** Gets the changes journaled since the last checkpoint. Records are only appended, until the next checkpoint */
+	const FInventoryJournal& GetJournal() const { return Journal; }
+
+	/**
+	 * Journals the whole state of a stored instance whose tags or component states changed, see
+	 * UItemInstance::NotifyPersistentStateChanged
+	 * @param Instance The changed instance, ignored if not stored by this inventory
+	 */
+	void NotifyInstanceStateChanged(UItemInstance* Instance);
+
+	/**
+	 * Enables or disables the deferred notification mode. Pending changes are reported when disabling it
+	 * @param bDefer If true, changes are coalesced and reported once per frame by OnInventoryBatchChanged
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Events")
+	void SetDeferChangeNotifications(bool bDefer);
+
+	/** Reports the changes journaled so far, without waiting for the end of the frame */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Events")
+	void FlushChangeNotifications();
+
 	UFUNCTION(BlueprintCallable, Category="Inventory|Query", meta = (Categories = "Inventory.Container"))
 	FInventoryEntryHandle FindHandleFromInstanceIn(const FGameplayTag& ContainerTag, UItemInstance* Instance) const;
 	UFUNCTION(BlueprintCallable, Category="Inventory|Query")
@@ -104,9 +336,146 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Inventory", meta = (DeterminesOutputType = DefinitionClass))
 	UItemDefinition* GetCachedDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass) const;
 
+	/**
+	 * Resolves which connections receive the containers registered with a tag, from this component then the project settings
+	 * @param ContainerTag The tag of the container
+	 * @return The most specific rule of the tag or its parents, replicating to every connection if none
+	 */
+	UFUNCTION(BlueprintPure, Category = "Inventory|Replication", meta = (GameplayTagFilter = "Inventory.Container"))
+	FInventoryReplicationRule GetContainerReplicationRule(const FGameplayTag& ContainerTag) const;
+
 protected:
 	static bool IsValidContainerTag(const FGameplayTag& Tag);
 
+	/**
+	 * Records the container storing an item instance. Called by the inventory lists on every entry addition
+	 * @param Instance The stored item instance
+	 * @param Container The container storing the instance
+	 */
+	void RegisterInstanceContainer(UItemInstance* Instance, UInventoryContainer* Container);
+
+	/**
+	 * Forgets the container storing an item instance. Called by the inventory lists on every entry removal
+	 * @param Instance The removed item instance
+	 * @param Container The container the instance is removed from
+	 */
+	void UnregisterInstanceContainer(UItemInstance* Instance, const UInventoryContainer* Container);
+
+	/**
+	 * Registers the instances of a successful add operation as replicated subobjects
+	 * @param Result The result of the add operation
+	 */
+	void RegisterReplicatedInstances(const FInventoryResult& Result);
+
+	/**
+	 * Registers a container or an item instance as a replicated subobject, with the condition of its container
+	 * @param SubObject The container or item instance
+	 * @param Rule The replication rule of the container
+	 */
+	void AddReplicatedInventorySubObject(UObject* SubObject, const FInventoryReplicationRule& Rule);
+
+	/**
+	 * Unregisters a container or an item instance from the replicated subobjects, without destroying it on the clients
+	 * @param SubObject The container or item instance
+	 * @param Rule The replication rule it has been registered with
+	 */
+	void RemoveReplicatedInventorySubObject(UObject* SubObject, const FInventoryReplicationRule& Rule);
+
+	/** Flushes the net dormancy of the owner on authority, so that an inventory change reaches the clients */
+	void WakeDormantOwner() const;
+
+	/**
+	 * Replaces the content of this inventory with a decoded snapshot, without journaling the rebuild
+	 * @param Snapshot The decoded snapshot
+	 * @return False if the inventory has no authority
+	 */
+	bool ApplySnapshot(const FInventorySnapshot& Snapshot);
+
+	/** Empties this inventory before rebuilding it from a snapshot, restarting the journal from the loaded state */
+	void BeginSnapshotRestore();
+
+	/**
+	 * Ends the rebuild of this inventory
+	 * @param bCompleted If false, the journal waits for a new checkpoint as only part of the snapshot was restored
+	 */
+	void EndSnapshotRestore(bool bCompleted);
+
+	/** @return True if changes are appended to the journal, see bJournalChanges */
+	bool ShouldJournalChanges() const;
+
+	/**
+	 * Appends a change to the journal and to the journals of the checkpoints being saved
+	 * @param Record Appends the change to the given journal
+	 */
+	void RecordJournal(TFunctionRef<void(FInventoryJournal&)> Record);
+
+	/**
+	 * Restarts the change journal from a checkpoint saved by SaveSnapshotAsync
+	 * @param Serial The serial of the checkpoint
+	 * @param bSaved If false, the checkpoint is dropped and the journal kept
+	 */
+	void CompleteCheckpoint(int32 Serial, bool bSaved);
+
+	/** The handle is only trusted for its container and entry identifiers, TryConsumeFromHandle checks them */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerConsumeItems(int32 PredictionKey, FInventoryEntryHandle Handle, int32 Count);
+
+	/** The handle and the target are only trusted once TryTransferItems checked they belong to this component */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerTransferItems(int32 PredictionKey, FInventoryEntryHandle Handle, UInventoryContainer* TargetContainer, int32 Count);
+
+	/**
+	 * Checks a prediction key received from the owning client and records it as answered
+	 * @return False if the key was already answered, the request is then ignored
+	 */
+	bool ConsumeServerPredictionKey(int32 PredictionKey);
+
+	UFUNCTION(Client, Reliable)
+	void ClientAcknowledgePrediction(int32 PredictionKey, bool bAccepted);
+
+	/**
+	 * Records a predicted change and schedules its expiration
+	 * @param Change The predicted change, its key being assigned
+	 * @return The key of the prediction
+	 */
+	int32 RecordPrediction(FInventoryPredictedChange Change);
+
+	/**
+	 * Ends the accepted predictions of a container once its replicated state is received. Called by the inventory lists
+	 * @param Container The container that received replicated state
+	 */
+	void ReconcilePredictions(const UInventoryContainer* Container);
+
+	/** Rolls back the predictions the server did not answer within PredictionTimeout */
+	void ExpirePredictions();
+
+	/** Rearms the timer expiring the earliest pending prediction */
+	void SchedulePredictionExpiration();
+
+	/**
+	 * Destroys an item instance no longer stored by this inventory, recycled when pooling is enabled
+	 * @param Instance The removed item instance
+	 */
+	void ReleaseItemInstance(UItemInstance* Instance);
+
+	/**
+	 * Routes a change reported by an inventory list to the matching events, or journals it when notifications are deferred
+	 * @param Data Information about the inventory change
+	 */
+	void DispatchInventoryChange(const FInventoryChangeData& Data);
+
+	/**
+	 * Adds a change to the journal, merging it with the pending change of the same entry if any
+	 * @param Data Information about the inventory change
+	 */
+	void JournalInventoryChange(const FInventoryChangeData& Data);
+
+	/** Starts journaling the inventory changes until the matching EndChangeScope call. See FInventoryChangeScope */
+	void BeginChangeScope();
+
+	/** Reports the changes journaled since the outermost BeginChangeScope call */
+	void EndChangeScope();
+
 	/**
 	 * Called after an item is added to the inventory
 	 * @param Data Information about the added inventory entry
@@ -131,6 +500,18 @@ protected:
 	 */
 	virtual void PostInventoryChanged(const FInventoryChangeData& Data);
 
+	/**
+	 * Reports a change through the per-entry event of its type, then through OnInventoryChanged
+	 * @param Data Information about the inventory change
+	 */
+	void PostInventoryChange(const FInventoryChangeData& Data);
+
+	/**
+	 * Called once after a batched operation with all the changes it made
+	 * @param Changes Information about the inventory changes, in the order they occurred
+	 */
+	virtual void PostInventoryBatchChanged(const TArray<FInventoryChangeData>& Changes);
+
 	/** Event fired when an item is added to the inventory */
 	UPROPERTY(BlueprintAssignable, Category = "Inventory")
 	FOnInventoryChange OnInventoryEntryAdded;
@@ -147,6 +528,18 @@ protected:
 	UPROPERTY(BlueprintAssignable, Category = "Inventory")
 	FOnInventoryChange OnInventoryChanged;
 
+	/** Event fired when a prediction of this client is made, confirmed or rolled back */
+	UPROPERTY(BlueprintAssignable, Category = "Inventory|Prediction")
+	FOnInventoryPredictionChange OnInventoryPredictionChanged;
+
+	/**
+	 * Event fired with the coalesced changes of a change scope (e.g. TryAddItemDefinitions), or once per frame in deferred mode
+	 * In deferred mode, journaled changes are only reported through this event. Otherwise, the coalesced changes of a
+	 * scope are also reported by the per-entry events once the scope ends, after this event
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Inventory")
+	FOnInventoryBatchChange OnInventoryBatchChanged;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
 	TSubclassOf<UInventoryContainer> DefaultContainerClass = UInventoryContainer::StaticClass();
 
@@ -156,10 +549,121 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
 	TObjectPtr<UInventorySet> DefaultInventorySet;
 
+	/**
+	 * Replication of the containers per container tag, applying to the child tags. Overrides the project settings,
+	 * e.g. to make the default container of a loot chest public while the backpacks of the players are owner only
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory|Replication", meta = (Categories = "Inventory.Container"))
+	TMap<FGameplayTag, FInventoryReplicationRule> ContainerReplicationRules;
+
+	/**
+	 * If true, the owner is made dormant on authority and only woken by inventory changes, e.g. for loot chests
+	 * Leave false for actors replicating other state continuously, such as pawns
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory|Replication")
+	bool bMakeOwnerDormant = false;
+
+	/**
+	 * If true, changes are journaled, merged per entry and reported once per frame by OnInventoryBatchChanged
+	 * Otherwise, each change is reported immediately by the per-entry events, or once coalesced at the end of a change scope
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory|Events")
+	bool bDeferChangeNotifications = false;
+
+	/**
+	 * If true, every change is appended to a journal on authority, so that autosaves only write the changes since
+	 * the last checkpoint. See SaveCheckpoint
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory|Persistence")
+	bool bJournalChanges = false;
+
+	/** Time in milliseconds spent per frame materializing the entries of an asynchronous snapshot load */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory|Persistence", meta = (ClampMin = "0.1", Units = "ms"))
+	float SnapshotLoadBudget = 1.f;
+
+	/** Time in seconds after which a prediction the server did not answer is rolled back */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory|Prediction", meta = (ClampMin = "0.1", Units = "s"))
+	float PredictionTimeout = 3.f;
+
 	UPROPERTY(/* Replicated */) // Should be marked as replicated but not supported, so replicated as subobjects
 	TMap<FGameplayTag, TObjectPtr<UInventoryContainer>> Containers;
 
-	/** Inventory definitions cache. Not replicated */
-	UPROPERTY()
-	TObjectPtr<UInventoryCache> Cache;
+	/** Container storing each item instance of this inventory, maintained by the inventory lists. Not replicated */
+	TMap<TObjectKey<UItemInstance>, TObjectPtr<UInventoryContainer>> InstanceContainers;
+
+	/** Number of nested change scopes running, changes are journaled while greater than zero */
+	int32 ChangeScopeDepth = 0;
+
+	/** Pending changes, at most one per entry. Merged away changes are left with an invalid index */
+	TArray<FInventoryChangeData> ChangeJournal;
+
+	/**
+	 * Position in the journal of the pending change of each entry, identified by its container and instance.
+	 * Commodity entries have no instance and are identified by their slot identifier and generation instead.
+	 */
+	TMap<TTuple<TObjectKey<UInventoryContainer>, TObjectKey<UItemInstance>, int32, int32>, int32> ChangeJournalIndex;
+
+	/** Timer reporting the journaled changes at the next frame in deferred mode */
+	FTimerHandle ChangeFlushTimerHandle;
+
+	/** Changes since the last checkpoint, appended when bJournalChanges is set */
+	FInventoryJournal Journal;
+
+	/**
+	 * True while entries are restored from a snapshot, by ApplySnapshot or a slice of an asynchronous load, whose
+	 * changes are not journaled. Changes made between the slices are journaled
+	 */
+	bool bRestoringSnapshot = false;
+
+	/**
+	 * True after a load which could not restore every entry in its saved slot, e.g. from a snapshot older than
+	 * EInventorySnapshotVersion::EntryIds. Changes are not journaled until the next checkpoint, as the journal could
+	 * not be folded into the loaded snapshot
+	 */
+	bool bJournalRequiresCheckpoint = false;
+
+	/** Checkpoint captured by SaveSnapshotAsync, waiting for its snapshot to be persisted */
+	struct FPendingCheckpoint
+	{
+		/** Identifies the checkpoint, increasing with each capture */
+		int32 Serial = 0;
+
+		/** Changes since the capture */
+		FInventoryJournal Journal;
+	};
+
+	/** Checkpoints being saved, oldest first. Dropped whenever the journal restarts */
+	TArray<FPendingCheckpoint> PendingCheckpoints;
+
+	/** Serial of the last checkpoint captured by SaveSnapshotAsync */
+	int32 LastCheckpointSerial = 0;
+
+	/** Asynchronous snapshot load in progress */
+	TSharedPtr<FInventorySnapshotLoader> SnapshotLoader;
+
+	/** Pending predictions of the owning client, layered over the replicated state. Empty on authority */
+	UPROPERTY(Transient)
+	FInventoryPredictionOverlay PredictionOverlay;
+
+	/** Timer rolling back the earliest pending prediction */
+	FTimerHandle PredictionTimerHandle;
+
+	/** Last prediction key answered by the server. Keys of a client only grow and reliable RPCs arrive in order */
+	int32 LastServerPredictionKey = 0;
+};
+
+
+/**
+ * @struct FInventoryChangeScope
+ * @see UInventorySystemComponent
+ * @brief Journals the inventory changes of a component while in scope, and reports them coalesced when leaving it
+ * @details Scopes can be nested, changes being reported when the outermost scope ends.
+ */
+struct INVENTORYSYSTEMCORE_API FInventoryChangeScope : FNoncopyable
+{
+	explicit FInventoryChangeScope(UInventorySystemComponent* InComponent);
+	~FInventoryChangeScope();
+
+private:
+	TWeakObjectPtr<UInventorySystemComponent> Component;
 };
@@ -3,7 +3,10 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "InventoryView.h"
+#include "Containers/Policies/StoragePolicy.h"
 #include "Data/InventoryList.h"
+#include "Settings/InventoryReplicationRule.h"
 #include "UObject/Object.h"
 #include "InventoryContainer.generated.h"
 
@@ -21,16 +24,21 @@ class INVENTORYSYSTEMCORE_API UInventoryContainer : public UObject
 {
 	GENERATED_BODY()
 
+	friend class UInventorySystemComponent;
+	friend class UInventoryTransaction;
+	friend struct FInventoryList;
+
 public:
 	UInventoryContainer(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 	// UObject
 	virtual bool IsSupportedForNetworking() const override { return true; }
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+#if UE_WITH_IRIS
+	virtual void RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags) override;
+#endif
 	// ~UObject
 
-	virtual bool ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags);
-
 
 	UFUNCTION(BlueprintCallable, Category="Inventory|Container")
 	FInventoryResult TryAddItemDefinition(TSubclassOf<UItemDefinition> Definition, int32 Count);
@@ -38,6 +46,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Inventory|Container")
 	FInventoryResult TryAddItemInstance(UItemInstance* Instance, int32 Count);
 
+	/**
+	 * Adds several item definitions to this container in a single pass, validated together before the first modification.
+	 * Requests refused on their own (invalid, refused definition or uniqueness) report their failure, the other ones are
+	 * stored together or, if they do not fit together, all refused with the capacity failure
+	 * @param Requests The definitions and counts to add. Container tags are ignored
+	 * @return One result per request, in the same order
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Container")
+	FInventoryBatchResult TryAddItemDefinitions(const TArray<FInventoryAddRequest>& Requests);
+
 	UFUNCTION(BlueprintCallable, Category="Inventory|Container")
 	bool TryRemoveItem(FInventoryEntryHandle& Handle, FGameplayTag& OutFailureReason);
 
@@ -47,28 +65,130 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Inventory|Container")
 	FInventoryEntryHandle FindHandle(UItemInstance* Instance) const;
 
+	/**
+	 * Checks in constant time whether the entry referenced by a handle is no longer stored in this container
+	 * @param Handle The handle to check
+	 * @return True if the handle does not belong to this container or its entry has been removed since it was made
+	 */
+	UFUNCTION(BlueprintPure, Category="Inventory|Container")
+	bool IsHandleStale(const FInventoryEntryHandle& Handle) const;
+
 	UFUNCTION(BlueprintCallable, Category="Inventory|Container")
 	FInventoryList& GetInventoryList() { return InventoryList; }
 
 	UFUNCTION(BlueprintCallable, Category="Inventory|Container")
 	void SetOwnerComponent(UInventorySystemComponent* NewOwner);
+
+	/** Gets the tag this container is registered with in its owner component */
+	UFUNCTION(BlueprintPure, Category="Inventory|Container")
+	const FGameplayTag& GetContainerTag() const { return ContainerTag; }
+
+	/** Gets which connections receive this container and its item instances, resolved from its tag when registered */
+	const FInventoryReplicationRule& GetReplicationRule() const { return ReplicationRule; }
+
 	int32 GetStackCountByDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass) const;
 	int32 GetTotalCountByDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass) const;
 
+	/** Gets the running totals of the content of this container, maintained on every change */
+	const FInventoryAggregates& GetAggregates() const { return InventoryList.GetAggregates(); }
+
+	/** Gets the total weight of the items stored in this container */
+	UFUNCTION(BlueprintPure, Category="Inventory|Container")
+	float GetTotalWeight() const { return GetAggregates().TotalWeight; }
+
+	/** Gets the number of stacks stored in this container */
+	UFUNCTION(BlueprintPure, Category="Inventory|Container")
+	int32 GetOccupiedStacks() const { return GetAggregates().OccupiedStacks; }
+
+	/** Gets the number of stored items whose definition has the given tag or one of its child tags */
+	UFUNCTION(BlueprintPure, Category="Inventory|Container")
+	int32 GetItemCountByTag(const FGameplayTag& Tag) const { return GetAggregates().GetCountByTag(Tag); }
+
+	/**
+	 * Gets the entries whose definition has the given tag or one of its child tags, without visiting the other entries
+	 * @param Tag The tag to look up
+	 * @return A handle to each matching entry, in no particular order
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Container")
+	TArray<FInventoryEntryHandle> GetHandlesByTag(const FGameplayTag& Tag) const { return InventoryList.GetHandlesByTag(Tag); }
+
+	/**
+	 * Creates a filtered and sorted view of this container, kept up to date as the content changes
+	 * @param FilterTag The tag the entries of the view must have, child tags included. Every entry matches if not set
+	 * @param SortKey The sort order of the entries
+	 * @param bDescending True to reverse the sort order
+	 * @return The populated view, to be kept referenced by the caller
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Container")
+	UInventoryView* CreateView(FGameplayTag FilterTag, EInventoryViewSortKey SortKey = EInventoryViewSortKey::None, bool bDescending = false);
+
 	UFUNCTION(BlueprintCallable, Category="Inventory|Container")
 	void AddStoragePolicy(UStoragePolicy* Policy);
 
 protected:
+	/** Checks that the owning inventory accepts changes, see UInventorySystemComponent::CanModifyContent */
+	bool CanModifyContent(FGameplayTag& OutFailureReason) const;
+
 	bool ValidateStorage(UItemInstance* Instance, FGameplayTag& OutFailureReason) const;
+	/**
+	 * Checks a quantity of items against the storage policies and the layout of the container, e.g. the capacity limits
+	 * @param DefinitionClass The definition of the added items
+	 * @param Count The number of added items
+	 * @param NewStacks The number of stacks the addition would create
+	 * @param OutFailureReason The reason of the refusal, if any
+	 * @return True if every policy accepts the items
+	 */
+	virtual bool ValidateCapacity(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 Count, int32 NewStacks, FGameplayTag& OutFailureReason) const;
+	/**
+	 * Checks several additions made together against the storage policies and the layout of the container
+	 * @param Requests The additions, in the order they will be applied
+	 * @param OutFailureReason The reason of the refusal, if any
+	 * @return True if every policy accepts the additions together
+	 */
+	virtual bool ValidateCapacityBatch(TConstArrayView<FInventoryCapacityRequest> Requests, FGameplayTag& OutFailureReason) const;
+
+	/**
+	 * Called by the inventory list once an entry is stored, on authority and on clients, before its addition is notified
+	 * @param Entry The stored entry
+	 */
+	virtual void PostEntryAdded(FInventoryEntry& Entry) {}
+	/**
+	 * Called by the inventory list before an entry is removed, on authority and on clients
+	 * @param Entry The removed entry
+	 */
+	virtual void PreEntryRemoved(const FInventoryEntry& Entry) {}
+	/**
+	 * Called by the inventory list when a change of an entry has been replicated
+	 * @param Entry The changed entry
+	 */
+	virtual void PostEntryReplicatedChange(const FInventoryEntry& Entry) {}
+
+	/** Called by the inventory list once an entry is accounted with its resolved definition, forwarded to the views */
+	void NotifyViewsEntryAdded(const FInventoryEntry& Entry) const;
+	/** Called by the inventory list before an accounted entry is removed, forwarded to the views */
+	void NotifyViewsEntryRemoved(const FInventoryEntry& Entry) const;
+	/** Called by the inventory list when the stack count of an accounted entry changed, forwarded to the views */
+	void NotifyViewsEntryChanged(const FInventoryEntry& Entry) const;
 
 	UPROPERTY()
 	UInventorySystemComponent* OwnerComponent = nullptr;
 
-	// Replicated list of items in this container
+	// Tag this container is registered with in its owner component
+	UPROPERTY()
+	FGameplayTag ContainerTag;
+
+	// Connections receiving this container, resolved by the owner component from the container tag (not replicated)
+	UPROPERTY(Transient)
+	FInventoryReplicationRule ReplicationRule;
+
+	// Replicated list of items in this container, push based: dirtied by each mutation of the list
 	UPROPERTY(Replicated)
 	FInventoryList InventoryList;
 
 	// Policies local to this container (not replicated)
 	UPROPERTY()
 	TArray<TObjectPtr<UStoragePolicy>> Policies;
+
+	// Views created on this container, released views being pruned on the next notification (not replicated)
+	mutable TArray<TWeakObjectPtr<UInventoryView>> Views;
 };
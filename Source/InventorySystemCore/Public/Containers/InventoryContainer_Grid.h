@@ -0,0 +1,145 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InventoryContainer.h"
+#include "InventoryContainer_Grid.generated.h"
+
+class UInventoryContainer_Grid;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryGridLayoutChanged, UInventoryContainer_Grid*, Container);
+
+namespace InventoryGrid
+{
+	/** Largest supported grid, a row being stored in a single 64 bits word */
+	constexpr int32 MaxWidth = 64;
+	constexpr int32 MaxHeight = 511;
+
+	/** Packed position of entries not placed in a grid */
+	constexpr uint16 InvalidPosition = MAX_uint16;
+
+	/** Packs a grid position in 16 bits: 6 bits for the column, 9 bits for the row and 1 bit for the rotation */
+	inline uint16 PackPosition(const int32 X, const int32 Y, const bool bRotated)
+	{
+		return static_cast<uint16>((X & 0x3F) | ((Y & 0x1FF) << 6) | (bRotated ? 0x8000 : 0));
+	}
+
+	inline void UnpackPosition(const uint16 Packed, int32& OutX, int32& OutY, bool& bOutRotated)
+	{
+		OutX = Packed & 0x3F;
+		OutY = (Packed >> 6) & 0x1FF;
+		bOutRotated = (Packed & 0x8000) != 0;
+	}
+}
+
+/**
+ * @class UInventoryContainer_Grid
+ * @see UInventoryContainer, UItemFragment_GridStorable
+ * @brief Container placing each stack on a two-dimensional grid, according to the footprint of its item
+ * @details Occupancy is kept as one 64 bits mask per row, so that free space is searched a whole row at a time with
+ * bitwise operations. Positions are replicated with the entries as packed coordinates, clients rebuilding the
+ * occupancy from them. Stacks which do not fit anymore are refused with TAG_Inventory_Failure_NoSpace.
+ */
+UCLASS(BlueprintType, Blueprintable)
+class INVENTORYSYSTEMCORE_API UInventoryContainer_Grid : public UInventoryContainer
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the position of an entry in the grid
+	 * @param Handle The handle of the entry
+	 * @param OutX The column of the top left cell of the entry
+	 * @param OutY The row of the top left cell of the entry
+	 * @param bOutRotated True if the entry is placed rotated
+	 * @return False if the entry is not stored in this container or not placed yet
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Grid")
+	bool GetEntryPosition(const FInventoryEntryHandle& Handle, int32& OutX, int32& OutY, bool& bOutRotated) const;
+
+	/**
+	 * Moves an entry to another position of the grid
+	 * @param Handle The handle of the entry to move
+	 * @param X The column of the new top left cell of the entry
+	 * @param Y The row of the new top left cell of the entry
+	 * @param bRotated Whether the entry is placed rotated, only accepted if its item can rotate
+	 * @param OutFailureReason The reason of the failure, if any
+	 * @return True if the entry has been moved
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Grid")
+	bool TryMoveEntryTo(const FInventoryEntryHandle& Handle, int32 X, int32 Y, bool bRotated, FGameplayTag& OutFailureReason);
+
+	/**
+	 * Places every entry again, largest footprints first, to gather the free space. Authority only.
+	 * The layout is left untouched if some entry would not fit anymore.
+	 * @return True if the entries have been rearranged
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Grid")
+	bool SortAndCompact();
+
+	/**
+	 * Searches the first free area of a given size, row by row
+	 * @return False if no area is large enough
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Grid")
+	bool FindFreeArea(int32 Width, int32 Height, int32& OutX, int32& OutY) const;
+
+	UFUNCTION(BlueprintPure, Category="Inventory|Grid")
+	bool IsCellOccupied(int32 X, int32 Y) const;
+
+	UFUNCTION(BlueprintPure, Category="Inventory|Grid")
+	int32 GetGridWidth() const { return GridWidth; }
+
+	UFUNCTION(BlueprintPure, Category="Inventory|Grid")
+	int32 GetGridHeight() const { return GridHeight; }
+
+	/** Called when entries are placed, moved or removed */
+	UPROPERTY(BlueprintAssignable)
+	FOnInventoryGridLayoutChanged OnGridLayoutChanged;
+
+protected:
+	// UInventoryContainer
+	virtual bool ValidateCapacity(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 Count, int32 NewStacks, FGameplayTag& OutFailureReason) const override;
+	virtual bool ValidateCapacityBatch(TConstArrayView<FInventoryCapacityRequest> Requests, FGameplayTag& OutFailureReason) const override;
+	virtual void PostEntryAdded(FInventoryEntry& Entry) override;
+	virtual void PreEntryRemoved(const FInventoryEntry& Entry) override;
+	virtual void PostEntryReplicatedChange(const FInventoryEntry& Entry) override;
+	// ~UInventoryContainer
+
+	using FRowMasks = TArray<uint64, TInlineAllocator<16>>;
+
+	/**
+	 * Gets the footprint of an item, a single cell if its definition has no grid fragment
+	 * @return False if the definition is not resolved
+	 */
+	static bool GetFootprint(const TSubclassOf<UItemDefinition>& DefinitionClass, bool bRotated, int32& OutWidth, int32& OutHeight, bool* bOutCanRotate = nullptr);
+
+	/** Searches the first free area of the given size in a set of row masks */
+	bool FindFit(const FRowMasks& Rows, int32 Width, int32 Height, int32& OutX, int32& OutY) const;
+	/** Checks whether an area is free in a set of row masks */
+	bool IsAreaFree(const FRowMasks& Rows, int32 X, int32 Y, int32 Width, int32 Height) const;
+	/** Searches room for an item footprint, rotated if needed and allowed, and marks it occupied */
+	bool PlaceFootprint(FRowMasks& Rows, const TSubclassOf<UItemDefinition>& DefinitionClass, uint16& OutPackedPosition) const;
+	/** Sets or clears the cells of an area in a set of row masks */
+	static void MarkArea(FRowMasks& Rows, int32 X, int32 Y, int32 Width, int32 Height, bool bOccupied);
+	/** Sets or clears the cells occupied by a placed entry */
+	static bool MarkEntry(FRowMasks& Rows, const FInventoryEntry& Entry, bool bOccupied);
+
+	/** Rebuilds the occupancy from the entry positions if it has been invalidated */
+	void ConditionalRebuildOccupancy() const;
+
+	/** Number of columns of the grid */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Grid", meta = (ClampMin = 1, ClampMax = 64))
+	int32 GridWidth = 8;
+
+	/** Number of rows of the grid */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Grid", meta = (ClampMin = 1, ClampMax = 511))
+	int32 GridHeight = 6;
+
+	/** One mask per row, bit X being set when the cell of column X is occupied. Not replicated */
+	mutable FRowMasks OccupiedRows;
+
+	/** True when the occupancy no longer matches the entries and must be rebuilt before the next query */
+	mutable bool bOccupancyDirty = true;
+};
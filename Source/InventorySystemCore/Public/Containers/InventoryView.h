@@ -0,0 +1,154 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Data/InventoryEntryHandle.h"
+#include "UObject/Object.h"
+#include "InventoryView.generated.h"
+
+class UInventoryContainer;
+class UInventoryView;
+class UItemDefinition;
+struct FInventoryEntry;
+
+/**
+ * Sort orders of the entries of an inventory view
+ */
+UENUM(BlueprintType)
+enum class EInventoryViewSortKey : uint8
+{
+	None, ///< Entries keep the order in which they entered the view
+	DisplayName, ///< Display name of the item definition
+	StackCount, ///< Number of items in the stack
+	Weight ///< Weight of the whole stack
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnInventoryViewChanged, UInventoryView*, View, const TArray<FInventoryEntryHandle>&, Added, const TArray<FInventoryEntryHandle>&, Removed, const TArray<FInventoryEntryHandle>&, Changed);
+
+/**
+ * @struct FInventoryViewItem
+ * @see UInventoryView
+ * @brief An entry of an inventory view along with its sort key
+ */
+struct FInventoryViewItem
+{
+	/** Handle to the entry, refreshed on each change of the entry */
+	FInventoryEntryHandle Handle;
+
+	/** Sort key of the numeric sort orders */
+	float NumericKey = 0.f;
+
+	/** Sort key of the display name sort order */
+	FText NameKey;
+};
+
+/**
+ * @class UInventoryView
+ * @see UInventoryContainer::CreateView
+ * @brief Filtered and sorted list of the entries of a container, kept up to date incrementally
+ * @details The view is populated once from the container tag index, then only visits the entries reported by the
+ * container as added, removed or changed, inserting them at their sorted position. Changes are accumulated and
+ * broadcast as a single diff on the next tick, so that a filtered tab only pays for the size of each change.
+ * Without world, changes are only broadcast by FlushChanges. The container only holds a weak reference to its views.
+ */
+UCLASS(BlueprintType)
+class INVENTORYSYSTEMCORE_API UInventoryView : public UObject
+{
+	GENERATED_BODY()
+
+	friend class UInventoryContainer;
+
+public:
+	/** Gets the handles of the entries of the view, in sort order */
+	UFUNCTION(BlueprintPure, Category="Inventory|View")
+	TArray<FInventoryEntryHandle> GetHandles() const;
+
+	/** Gets the number of entries of the view */
+	UFUNCTION(BlueprintPure, Category="Inventory|View")
+	int32 Num() const { return Items.Num(); }
+
+	/** Gets the container this view reflects */
+	UFUNCTION(BlueprintPure, Category="Inventory|View")
+	UInventoryContainer* GetContainer() const { return Container.Get(); }
+
+	/** Gets the tag the entries of the view must have, child tags included. Every entry matches if not set */
+	UFUNCTION(BlueprintPure, Category="Inventory|View")
+	const FGameplayTag& GetFilterTag() const { return FilterTag; }
+
+	/**
+	 * Rebuilds the view from the content of the container and broadcasts the difference immediately
+	 * @note Only needed if the definitions of the stored items have been modified
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|View")
+	void Refresh();
+
+	/** Broadcasts the accumulated changes now rather than on the next tick */
+	UFUNCTION(BlueprintCallable, Category="Inventory|View")
+	void FlushChanges();
+
+	/** Called with the entries added to, removed from and changed in the view since the last broadcast */
+	UPROPERTY(BlueprintAssignable, Category="Inventory|View")
+	FOnInventoryViewChanged OnViewChanged;
+
+protected:
+	/**
+	 * Sets the filter and the sort order of the view, then populates it
+	 * @param InContainer The container to reflect
+	 * @param InFilterTag The tag the entries must have, child tags included
+	 * @param InSortKey The sort order of the entries
+	 * @param bInDescending True to reverse the sort order
+	 */
+	void Initialize(UInventoryContainer* InContainer, const FGameplayTag& InFilterTag, EInventoryViewSortKey InSortKey, bool bInDescending);
+
+	/** Called by the container once an entry is stored and its definition resolved */
+	void HandleEntryAdded(const FInventoryEntry& Entry);
+	/** Called by the container before an entry is removed */
+	void HandleEntryRemoved(const FInventoryEntry& Entry);
+	/** Called by the container when the stack count of an entry changed */
+	void HandleEntryChanged(const FInventoryEntry& Entry);
+
+	/** Checks if the entries of a definition belong to the view */
+	bool Matches(const UItemDefinition* Definition) const;
+	/** Makes the view item of an entry, computing its sort key */
+	FInventoryViewItem MakeItem(const FInventoryEntryHandle& Handle, const UItemDefinition* Definition) const;
+	/** Checks if an item is sorted before another one, entry identifiers breaking ties */
+	bool IsSortedBefore(const FInventoryViewItem& A, const FInventoryViewItem& B) const;
+	/** Inserts an item at its sorted position */
+	void InsertSorted(FInventoryViewItem&& Item);
+	/** Removes the item at a position */
+	void RemoveAt(int32 Position);
+	/** Records the positions of the items from a position to the end, after an insertion or a removal */
+	void UpdatePositionsFrom(int32 Position);
+	/** Finds the position of an entry in the view, or INDEX_NONE if it is not in the view */
+	int32 FindPosition(int32 EntryId, int32 Generation) const;
+	/** Requests the broadcast of the accumulated changes on the next tick */
+	void ScheduleFlush();
+
+	/** The container this view reflects */
+	TWeakObjectPtr<UInventoryContainer> Container;
+
+	/** The tag the entries must have, child tags included */
+	FGameplayTag FilterTag;
+
+	/** The sort order of the entries */
+	EInventoryViewSortKey SortKey = EInventoryViewSortKey::None;
+
+	/** True to reverse the sort order */
+	bool bDescending = false;
+
+	/** The entries of the view, in sort order */
+	TArray<FInventoryViewItem> Items;
+
+	/** Position in Items of each entry identifier, so that removed and changed entries are found without a scan */
+	TMap<int32, int32> PositionByEntryId;
+
+	/** Changes not broadcast yet */
+	TArray<FInventoryEntryHandle> PendingAdded;
+	TArray<FInventoryEntryHandle> PendingRemoved;
+	TArray<FInventoryEntryHandle> PendingChanged;
+
+	/** True while a broadcast is scheduled for the next tick */
+	bool bFlushScheduled = false;
+};
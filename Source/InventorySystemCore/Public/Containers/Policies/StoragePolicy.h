@@ -3,11 +3,63 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Data/InventoryTagBitset.h"
 #include "UObject/Object.h"
 #include "StoragePolicy.generated.h"
 
-struct FGameplayTag;
+class UInventoryContainer;
+class UItemDefinition;
 class UItemInstance;
+
+/**
+ * @struct FStoragePolicyPredicate
+ * @see UStoragePolicy::GetCompiledPredicate
+ * @brief Native form of a storage policy only depending on the tags of the item definition
+ * @details Evaluated against the tag bitsets precomputed on the definitions, without allocation nor Blueprint call.
+ */
+struct INVENTORYSYSTEMCORE_API FStoragePolicyPredicate
+{
+	/** Tags the item must have, all of them or at least one according to bRequireAll */
+	FInventoryTagBitset RequiredTags;
+
+	/** Tags the item must not have */
+	FInventoryTagBitset ForbiddenTags;
+
+	/** True if every required tag must be present, false if one is enough */
+	bool bRequireAll = true;
+
+	/** True to check against the tags of the definition and their parents, false for the exact tags */
+	bool bMatchParentTags = false;
+
+	/** Reported when the predicate refuses an item */
+	FGameplayTag FailureReason;
+
+	/**
+	 * Checks the tags of a definition against the predicate
+	 * @param Definition The definition of the item to store
+	 * @return True if the item is accepted
+	 */
+	bool Evaluate(const UItemDefinition& Definition) const;
+};
+
+/**
+ * @struct FInventoryCapacityRequest
+ * @see UStoragePolicy::CanStoreBatch, UInventoryContainer::ValidateCapacityBatch
+ * @brief Items of a definition added to a container along with other additions, e.g. the grants of a batch
+ */
+struct FInventoryCapacityRequest
+{
+	/** The definition of the added items */
+	TSubclassOf<UItemDefinition> DefinitionClass;
+
+	/** The number of added items */
+	int32 Count = 0;
+
+	/** The number of stacks the addition creates, once the previous additions of the batch are applied */
+	int32 NewStacks = 0;
+};
+
 /**
  * @class UStoragePolicy
  * Base abstract class for container policies.
@@ -26,4 +78,57 @@ public:
 	 */
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category="Inventory|Policy")
 	bool CanStoreItem(UItemInstance* Instance, FGameplayTag& OutFailureReason) const;
+
+	/**
+	 * Determines whether a quantity of items can be added to the container, given its current content.
+	 * Called for definitions and instances alike, before any entry is created or modified.
+	 * @param Container - the container receiving the items
+	 * @param DefinitionClass - the definition of the added items
+	 * @param Count - the number of added items
+	 * @param NewStacks - the number of stacks the addition would create
+	 * @param OutFailureReason - if false, the reason the items are rejected
+	 */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category="Inventory|Policy")
+	bool CanStoreCount(const UInventoryContainer* Container, TSubclassOf<UItemDefinition> DefinitionClass, int32 Count, int32 NewStacks, FGameplayTag& OutFailureReason) const;
+
+	/**
+	 * Determines whether several additions can be made together to the container, given its current content.
+	 * Calls CanStoreCount for each addition by default: policies limiting totals must sum the additions instead.
+	 * @param Container - the container receiving the items
+	 * @param Requests - the additions, in the order they will be applied
+	 * @param OutFailureReason - if false, the reason the items are rejected
+	 */
+	virtual bool CanStoreBatch(const UInventoryContainer* Container, TConstArrayView<FInventoryCapacityRequest> Requests, FGameplayTag& OutFailureReason) const;
+
+	/**
+	 * Gets the native predicate equivalent to CanStoreItem for items without instance tags, compiled on first use.
+	 * @return The predicate, or nullptr if the policy cannot be compiled or CanStoreItem is overridden in Blueprint
+	 */
+	const FStoragePolicyPredicate* GetCompiledPredicate() const;
+
+	/** Discards the compiled predicate, to be called after modifying the policy at runtime */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Policy")
+	void InvalidateCompiledPredicate() { bPredicateCompiled = false; }
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+protected:
+	/**
+	 * Compiles CanStoreItem to a native predicate, for policies only depending on the tags of the item definition
+	 * @param OutPredicate The predicate to fill
+	 * @return True if the predicate is equivalent to CanStoreItem, false to always call CanStoreItem
+	 */
+	virtual bool CompilePredicate(FStoragePolicyPredicate& OutPredicate) const { return false; }
+
+private:
+	/** Compiled form of the policy, valid if bPredicateValid */
+	mutable FStoragePolicyPredicate CompiledPredicate;
+
+	/** True once CompilePredicate has been called on the current state of the policy */
+	mutable bool bPredicateCompiled = false;
+
+	/** True if the policy could be compiled */
+	mutable bool bPredicateValid = false;
 };
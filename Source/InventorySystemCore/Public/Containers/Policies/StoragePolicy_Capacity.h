@@ -0,0 +1,45 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StoragePolicy.h"
+#include "StoragePolicy_Capacity.generated.h"
+
+/**
+ * @class UStoragePolicy_Capacity
+ * @see UStoragePolicy, FInventoryAggregates
+ * @brief Limits the total weight and the number of stacks of a container
+ * @details Checked against the running aggregates of the container, without iterating its entries.
+ */
+UCLASS(DisplayName = "Capacity")
+class INVENTORYSYSTEMCORE_API UStoragePolicy_Capacity : public UStoragePolicy
+{
+	GENERATED_BODY()
+
+public:
+	/** Maximum total weight of the container. No limit if zero */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Policy", meta = (ClampMin = 0, Units = "kg"))
+	float MaxWeight = 0.f;
+
+	/** Maximum number of stacks of the container. No limit if zero */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Policy", meta = (ClampMin = 0))
+	int32 MaxStacks = 0;
+
+	virtual bool CanStoreCount_Implementation(const UInventoryContainer* Container, TSubclassOf<UItemDefinition> DefinitionClass, int32 Count, int32 NewStacks, FGameplayTag& OutFailureReason) const override;
+	virtual bool CanStoreBatch(const UInventoryContainer* Container, TConstArrayView<FInventoryCapacityRequest> Requests, FGameplayTag& OutFailureReason) const override;
+
+protected:
+	/**
+	 * Checks additions against the limits, given the current content of the container
+	 * @param Container The container receiving the items
+	 * @param NewStacks The number of stacks created by every addition
+	 * @param AddedWeight The weight of every added item
+	 * @param OutFailureReason The reason of the refusal, if any
+	 * @return True if the limits are respected
+	 */
+	bool CheckLimits(const UInventoryContainer* Container, int32 NewStacks, float AddedWeight, FGameplayTag& OutFailureReason) const;
+
+	/** Gets the weight of a number of items of a definition */
+	static float GetWeight(TSubclassOf<UItemDefinition> DefinitionClass, int32 Count);
+};
@@ -25,8 +25,12 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Policy")
 	FGameplayTagContainer ForbiddenTags;
 
+	/** True to require all the exact tags, false to require any tag or one of its children. See InvalidateCompiledPredicate */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Policy")
 	bool bExactMatch = true;
 
 	virtual bool CanStoreItem_Implementation(UItemInstance* Instance, FGameplayTag& OutFailureReason) const override;
+
+protected:
+	virtual bool CompilePredicate(FStoragePolicyPredicate& OutPredicate) const override;
 };
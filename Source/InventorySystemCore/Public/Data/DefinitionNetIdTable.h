@@ -0,0 +1,140 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SubclassOf.h"
+#include "UObject/TopLevelAssetPath.h"
+
+class UPackageMap;
+
+/**
+ * @class FDefinitionNetIdTable
+ * @see FItemInstanceHeader, FInventoryEntry::NetSerialize, UE::Net::FInventoryEntryNetSerializer
+ * @brief Compact network identifiers of the definition classes derived from a base class, shared by server and clients
+ * @details Identifiers are the positions of the classes in the sorted list of every subclass known to the asset
+ * registry, native or blueprint. Processes running the same cooked content build the same list, so the identifiers are
+ * deterministic without any exchange. The hash of the tables of the registered base classes is mixed into the network
+ * version, so a client whose content lists other classes is refused at the handshake instead of resolving the wrong
+ * definitions. Projects binding FNetworkVersion::GetLocalNetworkVersionOverride themselves must mix GetCombinedHash in.
+ * Classes missing from the table, e.g. blueprints created after it was built in the editor, are sent through the
+ * package map instead.
+ * Tables are built on the game thread, loading every listed class, and never change afterwards: they can be read from
+ * any thread, e.g. by the Iris serializers, and resolving an identifier never loads anything.
+ */
+class INVENTORYSYSTEMCORE_API FDefinitionNetIdTable
+{
+public:
+	/** Codes preceding the identifiers on the wire, shared by the legacy and Iris serializers */
+	enum ENetCode : uint32
+	{
+		NullClass = 0,
+		UnlistedClass = 1,
+		FirstNetId = 2
+	};
+
+	/**
+	 * Registers a definition base class whose table is part of the network version. Game thread, at module startup
+	 * @param BaseClass The definition base class, e.g. UItemDefinition
+	 */
+	static void RegisterBaseClass(const UClass* BaseClass);
+
+	/** Mixes the hash of the tables into the network version, unless the project overrides it already */
+	static void BindNetworkVersion();
+
+	/** Releases the tables and the network version override, at module shutdown */
+	static void Shutdown();
+
+	/**
+	 * Gets the table of a definition base class, built on first call from the game thread
+	 * @param BaseClass The definition base class, e.g. UItemDefinition
+	 * @return The table shared by the whole process, or an empty table if it is not built yet off the game thread
+	 */
+	static const FDefinitionNetIdTable& Get(const UClass* BaseClass);
+
+	/** Gets the hash of the tables of every registered base class, building them if needed. Game thread only */
+	static uint32 GetCombinedHash();
+
+	/**
+	 * Serializes a definition class as its compact identifier, or through the package map if it has none
+	 * @param Ar The archive to read from or write to
+	 * @param Map The package map of the connection
+	 * @param BaseClass The definition base class, selecting the table
+	 * @param InOutClass The class to write, or the class read
+	 * @return False if a received identifier or class could not be resolved
+	 */
+	static bool NetSerializeClass(FArchive& Ar, UPackageMap* Map, const UClass* BaseClass, UClass*& InOutClass);
+
+	template <typename T>
+	static bool NetSerializeClass(FArchive& Ar, UPackageMap* Map, TSubclassOf<T>& InOutClass)
+	{
+		UClass* Class = InOutClass;
+		const bool bSuccess = NetSerializeClass(Ar, Map, T::StaticClass(), Class);
+		if (Ar.IsLoading())
+		{
+			InOutClass = Class;
+		}
+		return bSuccess;
+	}
+
+	/**
+	 * Gets the identifier of a class
+	 * @param Class The definition class
+	 * @return The identifier, or INDEX_NONE if the class is not in the table
+	 */
+	int32 GetNetId(const UClass* Class) const;
+
+	/**
+	 * Gets the code sent for a class
+	 * @param Class The definition class, or nullptr
+	 * @return NullClass, UnlistedClass if the class is not in the table, or its identifier offset by FirstNetId
+	 */
+	uint32 GetNetCode(const UClass* Class) const;
+
+	/**
+	 * Resolves a received identifier code to its class, see GetNetCode
+	 * @param NetCode The code, at least FirstNetId
+	 * @return The class, or nullptr if the identifier is unknown or the class failed to load
+	 */
+	UClass* ResolveNetCode(const uint32 NetCode) const { return NetCode >= FirstNetId ? ResolveNetId(static_cast<int32>(NetCode - FirstNetId)) : nullptr; }
+
+	/**
+	 * Resolves an identifier to its class, loaded when the table was built
+	 * @param NetId The identifier
+	 * @return The class, or nullptr if the identifier is unknown or the class failed to load
+	 */
+	UClass* ResolveNetId(const int32 NetId) const { return Classes.IsValidIndex(NetId) ? Classes[NetId].Get() : nullptr; }
+
+	/**
+	 * Finds a class of the table by its path, without loading anything
+	 * @param ClassPath The path of the definition class
+	 * @return The class, or nullptr if it is not in the table or failed to load
+	 */
+	UClass* FindClass(const FTopLevelAssetPath& ClassPath) const;
+
+	/** Gets the number of classes in the table */
+	int32 Num() const { return ClassPaths.Num(); }
+
+	/** Gets the hash of the sorted class paths, equal in processes assigning the same identifiers */
+	uint32 GetHash() const { return Hash; }
+
+private:
+	friend class FDefinitionNetIdTableRegistry;
+
+	FDefinitionNetIdTable() = default;
+
+	/** Lists and sorts the subclasses of the base class known to the asset registry, then loads them */
+	explicit FDefinitionNetIdTable(const UClass* InBaseClass);
+
+	/** Paths of the definition classes, sorted. The identifier of a class is its index */
+	TArray<FTopLevelAssetPath> ClassPaths;
+
+	/** Identifier of each class path */
+	TMap<FTopLevelAssetPath, int32> NetIds;
+
+	/** Class of each identifier, loaded with the table and kept referenced by the registry */
+	TArray<TObjectPtr<UClass>> Classes;
+
+	/** Hash of the sorted class paths */
+	uint32 Hash = 0;
+};
@@ -12,26 +12,28 @@ class UItemDefinition;
  * @class UInventoryCache
  * @see UObject
  * @brief A thread-safe cache system for ItemDefinitions
- * @details This class manages a cache of ItemDefinitions to improve performance by reducing object creation 
- * and providing thread-safe access to cached objects.
+ * @details This class manages a cache of ItemDefinitions resolving each definition class to its default object,
+ * shared by the whole process and never duplicated. Owned by the UItemDefinitionRegistry.
+ * Lookups only take a shared read lock, so any thread can query it without contending with other readers. The
+ * exclusive write lock is only taken to add a missing definition, and to prune stale entries after garbage collection.
  */
 UCLASS(HideDropdown, Hidden)
 class INVENTORYSYSTEMCORE_API UInventoryCache : public UObject
 {
 	GENERATED_BODY()
 
-	friend class UInventorySystemComponent;
+	friend class UItemDefinitionRegistry;
 
 public:
 	UInventoryCache();
 	virtual ~UInventoryCache() override;
 
 	/**
-	 * Gets or creates a cached ItemDefinition instance in a thread-safe manner
-	 * If the ItemDefinition is not in the cache, creates a new one and adds it to the cache
+	 * Gets a cached ItemDefinition instance in a thread-safe manner
+	 * If the ItemDefinition is not in the cache, its class default object is added to the cache
 	 *
-	 * @param ItemDefinitionClass The class of the ItemDefinition to retrieve or create
-	 * @return A pointer to the cached or newly created ItemDefinition instance
+	 * @param ItemDefinitionClass The class of the ItemDefinition to retrieve
+	 * @return A pointer to the shared ItemDefinition instance
 	 * @see UItemDefinition
 	 */
 	UItemDefinition* GetCachedDefinition(const TSubclassOf<UItemDefinition>& ItemDefinitionClass);
@@ -47,7 +49,7 @@ public:
 
 private:
 	/**
-	 * Clears the cache of any ItemDefinitions that are no longer rooted
+	 * Clears the cache of any ItemDefinitions that have been garbage collected (e.g. unloaded or recompiled classes)
 	 * This method is called after garbage collection and is thread-safe
 	 * @see CacheLock
 	 */
@@ -62,7 +64,7 @@ private:
 
 	/**
 	 * Synchronization primitive for thread-safe access to the CachedDefinitionMap
-	 * Used to prevent concurrent modifications to the cache
+	 * Read locked by lookups, write locked by modifications
 	 */
-	FCriticalSection CacheLock;
+	mutable FRWLock CacheLock;
 };
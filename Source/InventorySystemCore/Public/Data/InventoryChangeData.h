@@ -5,6 +5,8 @@
 #include "InventoryChangeData.generated.h"
 
 struct FInventoryEntry;
+class UInventoryContainer;
+class UItemDefinition;
 class UItemInstance;
 
 /**
@@ -57,6 +59,34 @@ struct INVENTORYSYSTEMCORE_API FInventoryChangeData
 	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
 	TObjectPtr<UItemInstance> Instance = nullptr;
 
+	/** 
+	 * Definition of the affected item
+	 * Identifies the item of commodity entries, which have no instance
+	 */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	TSubclassOf<UItemDefinition> DefinitionClass = nullptr;
+
+	/** 
+	 * Identifier of the slot of the affected entry in its list
+	 * Used with the container to identify the entry across changes
+	 */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	int32 EntryId = INDEX_NONE;
+
+	/** 
+	 * Generation of the slot of the affected entry, incremented each time the entry of the slot is removed
+	 * Tells apart the successive entries stored under the same EntryId
+	 */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	int32 Generation = 0;
+
+	/** 
+	 * Container storing the affected entry
+	 * Used with the instance to identify the entry across changes
+	 */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	TObjectPtr<UInventoryContainer> Container = nullptr;
+
 	/** 
 	 * Specifies whether the item was added, removed, or modified
 	 * Defaults to Added when not specified
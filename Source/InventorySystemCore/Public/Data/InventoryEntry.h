@@ -7,7 +7,9 @@
 
 #include "InventoryEntry.generated.h"
 
+class UItemDefinition;
 class UItemInstance;
+namespace UE::Net { struct FInventoryEntryNetSerializer; }
 
 /**
  * @struct FInventoryEntry
@@ -24,6 +26,9 @@ struct INVENTORYSYSTEMCORE_API FInventoryEntry : public FFastArraySerializerItem
 	friend struct FInventoryList;
 	friend struct FInventoryChangeData;
 	friend struct FInventoryEntryHandle;
+	friend class UInventoryContainer_Grid;
+	friend class UInventoryView;
+	friend struct UE::Net::FInventoryEntryNetSerializer;
 
 	FInventoryEntry()
 	{
@@ -41,6 +46,24 @@ struct INVENTORYSYSTEMCORE_API FInventoryEntry : public FFastArraySerializerItem
 	FString GetDebugString() const;
 	// ~FFastArraySerializer
 
+	/**
+	 * Serializes the replicated fields of the entry: presence flags, the commodity definition as its compact net id,
+	 * and variable length counts and identifiers. Iris uses UE::Net::FInventoryEntryNetSerializer instead
+	 */
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	/**
+	 * Gets the definition class of the item stored in this entry
+	 * @return The definition class, or nullptr if the item instance is not valid (or not replicated yet)
+	 */
+	TSubclassOf<UItemDefinition> GetDefinitionClass() const;
+
+	/**
+	 * Checks if this entry stores a commodity, counted without item instance
+	 * @return True if the entry has a definition but no item instance
+	 */
+	bool IsCommodity() const { return Instance == nullptr && CommodityDefinition != nullptr; }
+
 private:
 	/**
 	 * The actual item instance being stored in this inventory entry
@@ -49,6 +72,13 @@ private:
 	UPROPERTY()
 	TObjectPtr<UItemInstance> Instance = nullptr;
 
+	/**
+	 * Definition of a commodity entry, stored in place of an item instance
+	 * Null for entries holding an item instance
+	 */
+	UPROPERTY()
+	TSubclassOf<UItemDefinition> CommodityDefinition = nullptr;
+
 	/**
 	 * Current number of items in this stack
 	 * Represents how many items of this type are grouped together
@@ -56,6 +86,27 @@ private:
 	UPROPERTY()
 	int32 StackCount = 0;
 
+	/**
+	 * Identifier of the slot referencing this entry in the owning list
+	 * Stable while the entry is stored, replicated so handles are shared between server and clients
+	 */
+	UPROPERTY()
+	int32 EntryId = INDEX_NONE;
+
+	/**
+	 * Generation of the slot when this entry was stored
+	 * Compared against handle generations to detect stale handles
+	 */
+	UPROPERTY()
+	int32 Generation = 0;
+
+	/**
+	 * Position of the entry in grid containers, packed by InventoryGrid::PackPosition
+	 * MAX_uint16 if the entry is not placed
+	 */
+	UPROPERTY()
+	uint16 PackedGridPosition = MAX_uint16;
+
 	/** 
 	 * Used to detect local stack changes without replication
 	 * Helps with client-side prediction of stack modifications
@@ -64,6 +115,13 @@ private:
 	UPROPERTY(NotReplicated)
 	int32 LastStackCount = INDEX_NONE;
 
+	/**
+	 * Stack count and definition accounted for in the aggregates of the owning list
+	 * INDEX_NONE until the definition of the entry is resolved
+	 */
+	mutable int32 AggregatedCount = INDEX_NONE;
+	mutable TSubclassOf<UItemDefinition> AggregatedDefinition = nullptr;
+
 	/** 
 	 * Used to detect local stack changes without replication
 	 * Helps with client-side prediction of stack modifications
@@ -72,3 +130,12 @@ private:
 	UPROPERTY(NotReplicated, Transient)
 	UInventoryContainer* OwningContainer = nullptr;
 };
+
+template <>
+struct TStructOpsTypeTraits<FInventoryEntry> : TStructOpsTypeTraitsBase2<FInventoryEntry>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
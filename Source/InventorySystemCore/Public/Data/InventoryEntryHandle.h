@@ -12,10 +12,11 @@ class UItemInstance;
 /**
  * @struct FInventoryEntryHandle
  * @see UItemInstance
- * @brief Represents a handle to an inventory entry, providing access to its index, item instance, and stack count.
- * @details This structure acts as a lightweight wrapper around inventory entry data, allowing access to the entry's
- * position in the inventory, its associated item instance, and the current stack count. Used throughout the inventory
- * system to reference and manipulate inventory entries.
+ * @brief Represents a handle to an inventory entry, providing access to its identifier, item instance, and stack count.
+ * @details This structure acts as a lightweight wrapper around inventory entry data. The entry is referenced by a stable
+ * slot identifier and the generation of that slot, resolved by the owning FInventoryList through its slot table: the handle
+ * survives the removal of other entries, and is detected as stale in constant time once its own entry is removed.
+ * Item instance and stack count are a snapshot taken when the handle was made.
  */
 USTRUCT(BlueprintType)
 struct INVENTORYSYSTEMCORE_API FInventoryEntryHandle
@@ -28,47 +29,52 @@ struct INVENTORYSYSTEMCORE_API FInventoryEntryHandle
 
 	/**
 	 * Creates a handle from an existing inventory entry
-	 * @param InIndex Index of the entry in the inventory
 	 * @param InEntry The inventory entry to reference
+	 * @param InContainer The container storing the entry
 	 */
-	FInventoryEntryHandle(const int32 InIndex, const FInventoryEntry& InEntry)
-		: EntryIndex(InIndex)
+	FInventoryEntryHandle(const FInventoryEntry& InEntry, UInventoryContainer* InContainer)
+		: EntryId(InEntry.EntryId), Generation(InEntry.Generation), ItemInstance(InEntry.Instance), DefinitionClass(InEntry.GetDefinitionClass()), StackCount(InEntry.StackCount), Container(InContainer)
 	{
-		EntryIndex = InIndex;
-		ItemInstance = InEntry.Instance;
-		StackCount = InEntry.StackCount;
-		Container = InEntry.OwningContainer;
 	}
 
 	/**
 	 * Creates a handle with specified values
-	 * @param InIndex Index of the entry in the inventory
+	 * @param InEntryId Identifier of the entry slot in the inventory list
 	 * @param InInstance The item instance to reference
 	 * @param InStackCount Number of items in the stack
-	 * @param InContainer
+	 * @param InContainer The container storing the entry
+	 * @param InGeneration Generation of the entry slot when the handle is made
 	 */
-	FInventoryEntryHandle(const int32 InIndex, UItemInstance* InInstance, const int32 InStackCount, UInventoryContainer* InContainer)
-		: EntryIndex(InIndex), ItemInstance(InInstance), StackCount(InStackCount), Container(InContainer)
+	FInventoryEntryHandle(const int32 InEntryId, UItemInstance* InInstance, const int32 InStackCount, UInventoryContainer* InContainer, const int32 InGeneration = 0)
+		: EntryId(InEntryId), Generation(InGeneration), ItemInstance(InInstance), StackCount(InStackCount), Container(InContainer)
 	{
 	}
 
 	/**
-	 * Checks if this handle references a valid inventory entry
-	 * @return true if the handle points to a valid entry, false otherwise
+	 * Checks if this handle has been made from an inventory entry
+	 * @return true if the handle points to an entry, false otherwise
+	 * @note Does not check that the entry is still stored, see UInventoryContainer::IsHandleStale
 	 */
 	bool IsHandleValid() const;
 
 	bool operator==(const FInventoryEntryHandle& Other) const
 	{
-		return EntryIndex == Other.EntryIndex && ItemInstance == Other.ItemInstance && Container == Other.Container;
+		return EntryId == Other.EntryId && Generation == Other.Generation && ItemInstance == Other.ItemInstance && Container == Other.Container;
 	}
 
 	/**
-	 * Index of the inventory entry in the inventory list
+	 * Identifier of the entry slot in the inventory list, stable while the entry is stored
 	 * Defaults to INDEX_NONE (-1) if the handle is invalid
 	 */
 	UPROPERTY(BlueprintReadOnly)
-	int32 EntryIndex = INDEX_NONE;
+	int32 EntryId = INDEX_NONE;
+
+	/**
+	 * Generation of the entry slot when this handle was made
+	 * The slot generation is incremented when its entry is removed, making this handle stale
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	int32 Generation = 0;
 
 	/**
 	 * The item instance associated with this inventory entry
@@ -77,6 +83,13 @@ struct INVENTORYSYSTEMCORE_API FInventoryEntryHandle
 	UPROPERTY(BlueprintReadOnly)
 	TObjectPtr<UItemInstance> ItemInstance = nullptr;
 
+	/**
+	 * The definition of the item stored in the entry
+	 * The only reference to the item for commodity entries, which have no item instance
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	TSubclassOf<UItemDefinition> DefinitionClass = nullptr;
+
 	/**
 	 * Current number of items in this stack
 	 * Represents how many items of this type are grouped together
@@ -0,0 +1,112 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/InventorySnapshot.h"
+
+struct FInventoryChangeData;
+class UInventoryContainer;
+
+/**
+ * Types of the records of an inventory journal
+ */
+enum class EInventoryJournalRecord : uint8
+{
+	DefinitionPath, ///< Adds a definition class path to the tables of the journal
+	Name, ///< Adds a container or instance tag name to the tables of the journal
+	ComponentClassPath, ///< Adds a component class path to the tables of the journal
+	Added, ///< An entry was added, with its whole state
+	Changed, ///< The stack count or grid position of an entry changed
+	Removed, ///< An entry was removed
+	Cleared, ///< Every entry of a container was removed
+	Captured ///< The instance tags or component states of an entry changed, with its whole state
+};
+
+/**
+ * @class FInventoryJournal
+ * @see FInventorySnapshot, UInventorySystemComponent::SaveCheckpoint
+ * @brief Append-only binary log of the changes of an inventory since its last checkpoint snapshot
+ * @details Every add, change and remove reported by the inventory lists is appended as a compact record, entries being
+ * identified by their container and slot. Paths and names are written once, as definition records preceding their
+ * first use. Records are only ever appended, so an autosave writes the bytes added since the previous one, and a
+ * crash is recovered by folding the journal into the checkpoint snapshot it was started after. Game thread only.
+ *
+ * Layout: magic, version, the version of the entry encoding, then the records, each starting with its type.
+ */
+class INVENTORYSYSTEMCORE_API FInventoryJournal
+{
+public:
+	/** Identifies inventory journals, 'INVJ' */
+	static constexpr uint32 Magic = 0x4A564E49;
+
+	/** Version of the journal layout, 2 adding the Captured records */
+	static constexpr uint16 Version = 2;
+
+	/**
+	 * Appends a change reported by an inventory list
+	 * @param Data The change, its entry still being stored for removals
+	 */
+	void RecordChange(const FInventoryChangeData& Data);
+
+	/**
+	 * Appends the whole state of an entry whose persistent state changed without a list change, e.g. an instance tag
+	 * @param Handle The entry, still stored in its container
+	 */
+	void RecordEntryState(const FInventoryEntryHandle& Handle);
+
+	/**
+	 * Appends the removal of every entry of a container
+	 * @param Container The emptied container
+	 */
+	void RecordCleared(const UInventoryContainer& Container);
+
+	/** Starts a new journal, after a checkpoint snapshot has been taken */
+	void Reset();
+
+	/** Gets the journal since the last checkpoint, header included once a record has been appended */
+	const TArray<uint8>& GetData() const { return Data; }
+
+	int32 GetNumRecords() const { return NumRecords; }
+
+	/**
+	 * Applies a journal to the snapshot taken at the checkpoint it was started after
+	 * @param InOutSnapshot The decoded checkpoint snapshot, updated with the changes of the journal
+	 * @param JournalData The journal, which must outlive the snapshot as added entries point into it
+	 * @return False if the data is not a journal or is corrupted. A journal truncated by a crash within its last record
+	 * is folded up to its last complete record
+	 */
+	static bool Fold(FInventorySnapshot& InOutSnapshot, FMemoryView JournalData);
+
+	/**
+	 * Folds a journal into its checkpoint snapshot and writes the result as a fresh snapshot
+	 * @param SnapshotData The checkpoint snapshot
+	 * @param JournalData The journal started after the checkpoint
+	 * @param OutSnapshot Receives the compacted snapshot
+	 * @return False if the snapshot or the journal could not be read
+	 */
+	static bool Compact(FMemoryView SnapshotData, FMemoryView JournalData, TArray<uint8>& OutSnapshot);
+
+private:
+	/** Appends a record holding the whole state of an entry, for Added and Captured */
+	void WriteEntryRecord(EInventoryJournalRecord Type, UInventoryContainer& Container, int32 Index);
+
+	/** Writes the header before the first record */
+	FArchive& BeginRecord(FMemoryWriter& Writer, EInventoryJournalRecord Type);
+
+	/** Interns the paths and names of a captured entry, appending definition records for the new ones */
+	void WriteTableAdditions(int32 NumDefinitionPaths, int32 NumNames, int32 NumComponentClassPaths);
+
+	/** Gets the index of a container tag, appending its definition record if new */
+	int32 AddContainerName(const UInventoryContainer& Container);
+
+	TArray<uint8> Data;
+
+	/** Paths and names defined so far by this journal */
+	FInventorySnapshotTables Tables;
+
+	/** Storage of the component states captured by added entries, before they are written */
+	TArray<TArray<uint8>> CapturedStates;
+
+	int32 NumRecords = 0;
+};
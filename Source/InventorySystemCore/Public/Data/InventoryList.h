@@ -7,6 +7,7 @@
 #include "InventoryEntry.h"
 #include "InventoryEntryHandle.h"
 #include "Net/Serialization/FastArraySerializer.h"
+#include "UObject/ObjectKey.h"
 
 #include "InventoryList.generated.h"
 
@@ -35,6 +36,124 @@ struct FInventoryResult
 };
 
 
+/**
+ * @struct FInventoryAddRequest
+ * @see UInventorySystemComponent::TryAddItemDefinitions
+ * @brief A single item grant of a batched add operation
+ */
+USTRUCT(BlueprintType)
+struct FInventoryAddRequest
+{
+	GENERATED_BODY()
+
+	FInventoryAddRequest()
+	{
+	}
+
+	FInventoryAddRequest(const TSubclassOf<UItemDefinition>& InItemDefinition, const int32 InCount, const FGameplayTag& InContainerTag = FGameplayTag())
+		: ItemDefinition(InItemDefinition), Count(InCount), ContainerTag(InContainerTag)
+	{
+	}
+
+	/** The item definition class to add */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory")
+	TSubclassOf<UItemDefinition> ItemDefinition = nullptr;
+
+	/** The number of items to add */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory", meta = (ClampMin = 1))
+	int32 Count = 1;
+
+	/** The container receiving the items. The component default container is used if not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory", meta = (Categories = "Inventory.Container"))
+	FGameplayTag ContainerTag;
+};
+
+
+/**
+ * @struct FInventoryBatchResult
+ * @see FInventoryAddRequest, FInventoryResult
+ * @brief Results of a batched add operation, one per request and in the same order
+ */
+USTRUCT(BlueprintType)
+struct FInventoryBatchResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	TArray<FInventoryResult> Results;
+
+	/** True if every request succeeded */
+	bool Succeeded() const { return !Results.ContainsByPredicate([](const FInventoryResult& Result) { return !Result.Succeeded(); }); }
+};
+
+
+/**
+ * @struct FInventoryDefinitionIndex
+ * @see FInventoryList
+ * @brief Per-definition bookkeeping maintained by FInventoryList alongside its entries
+ * @details Holds the indices of every entry storing a given definition and the sum of their stack counts, so that
+ * definition queries do not have to walk and dereference every entry of the list.
+ */
+struct FInventoryDefinitionIndex
+{
+	/** Indices in FInventoryList::Entries of the stacks holding the definition, in insertion order */
+	TArray<int32, TInlineAllocator<4>> EntryIndices;
+
+	/** Sum of the stack counts of all the indexed entries */
+	int32 TotalCount = 0;
+};
+
+
+/**
+ * @struct FInventoryAggregates
+ * @see FInventoryList, UStoragePolicy_Capacity
+ * @brief Running totals of the content of an inventory list
+ * @details Maintained incrementally on every addition, removal and stack change, replicated ones included, so that
+ * encumbrance displays and capacity checks read them in constant time.
+ */
+USTRUCT(BlueprintType)
+struct FInventoryAggregates
+{
+	GENERATED_BODY()
+
+	/** Sum of the weights of every stored item */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory", meta = (Units = "kg"))
+	float TotalWeight = 0.f;
+
+	/** Number of stacks stored */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	int32 OccupiedStacks = 0;
+
+	/** Number of stored items per tag of their definition, parent tags included */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	TMap<FGameplayTag, int32> TagCounts;
+
+	/** Gets the number of stored items whose definition has the given tag or one of its child tags */
+	int32 GetCountByTag(const FGameplayTag& Tag) const
+	{
+		const int32* Count = TagCounts.Find(Tag);
+		return Count ? *Count : 0;
+	}
+};
+
+
+/**
+ * @struct FInventoryEntrySlot
+ * @see FInventoryList, FInventoryEntryHandle
+ * @brief Indirection between a stable entry identifier and the current position of the entry in FInventoryList::Entries
+ * @details Slots are recycled once their entry is removed, their generation being incremented so that handles made
+ * for the previous entry are detected as stale.
+ */
+struct FInventoryEntrySlot
+{
+	/** Index of the entry in FInventoryList::Entries, INDEX_NONE while the slot is free */
+	int32 EntryIndex = INDEX_NONE;
+
+	/** Incremented each time the entry of the slot is removed */
+	int32 Generation = 0;
+};
+
+
 /**
  * @class FInventoryList
  * @see FFastArraySerializer
@@ -50,6 +169,9 @@ struct INVENTORYSYSTEMCORE_API FInventoryList : public FFastArraySerializer
 
 	friend class UInventorySystemComponent;
 	friend class UInventoryContainer;
+	friend class UInventoryContainer_Grid;
+	friend class UInventoryTransaction;
+	friend class FInventorySnapshot;
 	friend FInventoryEntry;
 
 	FInventoryList();
@@ -59,6 +181,7 @@ struct INVENTORYSYSTEMCORE_API FInventoryList : public FFastArraySerializer
 	void PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize);
 	void PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize);
 	void PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize);
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
 
 	/** Implements network delta serialization for the equipment list. */
 	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParams)
@@ -72,16 +195,40 @@ struct INVENTORYSYSTEMCORE_API FInventoryList : public FFastArraySerializer
 	FInventoryResult AddFromDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 Count = 1);
 	FInventoryResult AddInstance(UItemInstance* ItemInstance, int32 Count = 1);
 
+	/**
+	 * Adds several item definitions in a single pass, validating them together before the first modification.
+	 * Count-independent checks are done once per distinct definition, the uniqueness against the stacks created by every
+	 * request of the definition. Requests failing these checks are refused on their own, the others are checked together
+	 * against the capacity of the container and are all refused if they do not fit together.
+	 * @param Requests The definitions and counts to add. Container tags are not considered at this level
+	 * @param OutResults Receives one result per request, in the same order
+	 */
+	void AddFromDefinitions(TConstArrayView<FInventoryAddRequest> Requests, TArray<FInventoryResult>& OutResults);
+
+	/** Removes the entry of an instance, unless it is locked by a transaction */
 	void RemoveInstance(UItemInstance* Instance);
 	bool RemoveFromHandle(const FInventoryEntryHandle& Handle, FGameplayTag& OutFailureReason);
 	bool RemoveFromIndex(int32 Index, FGameplayTag& OutFailureReason);
 
 	FInventoryEntryHandle MakeHandle(int32 Index) const;
+	/**
+	 * Resolves a handle to the current index of its entry
+	 * @param Handle The handle to resolve
+	 * @return The index of the entry in the list, or INDEX_NONE if the entry has been removed since the handle was made
+	 */
+	int32 FindEntryIndex(const FInventoryEntryHandle& Handle) const;
 	FInventoryEntryHandle FindHandleFromInstance(UItemInstance* Instance) const;
 	FInventoryEntryHandle FindHandleOfType(const TSubclassOf<UItemDefinition>& ItemDefinition);
 
 	TArray<FInventoryEntryHandle> GetAllHandles() const;
+	/** Gets the handles of the entries of a definition or its subclasses, in list order */
 	TArray<FInventoryEntryHandle> GetHandlesOfType(const TSubclassOf<UItemDefinition>& ItemDefinition);
+	/**
+	 * Gets the entries whose definition has the given tag or one of its child tags, using the tag index
+	 * @param Tag The tag to look up
+	 * @return A handle to each matching entry, in no particular order
+	 */
+	TArray<FInventoryEntryHandle> GetHandlesByTag(const FGameplayTag& Tag) const;
 	TArray<FInventoryEntry*> GetAllEntries();
 	FInventoryEntry* FindEntryOfType(const TSubclassOf<UItemDefinition>& ItemDefinition);
 	TArray<FInventoryEntry*> GetEntriesOfType(const TSubclassOf<UItemDefinition>& ItemDefinition);
@@ -89,11 +236,73 @@ struct INVENTORYSYSTEMCORE_API FInventoryList : public FFastArraySerializer
 	int32 GetStackCountByDefinition(const TSubclassOf<UItemDefinition>& ItemDefinitionClass) const;
 	int32 GetTotalCountByDefinition(const TSubclassOf<UItemDefinition>& ItemDefinitionClass) const;
 
+	/** Gets the running totals of the content of this list */
+	const FInventoryAggregates& GetAggregates() const;
+	/**
+	 * Counts the stacks that adding items of a definition would create, after topping up the existing stacks
+	 * @param DefinitionClass The item definition class to add
+	 * @param Count The number of items to add
+	 * @return The number of new stacks, 0 if the definition is not storable
+	 */
+	int32 GetNewStackCount(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 Count) const;
+	/**
+	 * Counts the items of a definition that the existing stacks can still receive
+	 * @param DefinitionClass The item definition class
+	 * @return The room left in the stacks of the definition, 0 if the definition is not stackable
+	 */
+	int32 GetFreeStackRoom(const TSubclassOf<UItemDefinition>& DefinitionClass) const;
+	/**
+	 * Counts the stacks that an addition would create once the additions planned before it are applied, see GetNewStackCount
+	 * @param DefinitionClass The item definition class to add
+	 * @param Count The number of items to add
+	 * @param bOwnStack True if the items keep their own stack, e.g. a moved item instance, instead of topping up stacks
+	 * @param PlannedFreeRoom Room left in the stacks of each definition by the planned additions, updated
+	 * @return The number of new stacks
+	 */
+	int32 PlanNewStacks(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 Count, bool bOwnStack, TMap<TSubclassOf<UItemDefinition>, int32>& PlannedFreeRoom) const;
+	/**
+	 * Checks the uniqueness of a definition once new stacks of it are created, e.g. by every request of a batch
+	 * @param DefinitionClass The item definition class to check
+	 * @param NewStacks The number of stacks created for the definition
+	 * @param OutFailureReason The reason of the refusal, if any
+	 * @return False if the definition is unique and the list would hold more than one stack of it
+	 */
+	bool CanAddStacks(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 NewStacks, FGameplayTag& OutFailureReason) const;
+
+	/** Removes every entry from the list without broadcasting per-entry events. Entry locks are released */
+	void Empty();
+
+	/**
+	 * Checks if an entry is locked by a pending transaction, in which case it cannot be removed nor transferred
+	 * @param EntryId The slot identifier of the entry
+	 * @return True if the entry is locked
+	 */
+	bool IsEntryLocked(const int32 EntryId) const { return LockedEntries.Contains(EntryId); }
+
+	/**
+	 * Makes the next entry added on authority use a given slot instead of a free one, e.g. to restore the slots saved
+	 * by a snapshot. The reservation is used by the next added entry or dropped by ClearEntrySlotReservation
+	 * @param EntryId The slot identifier
+	 * @param Generation The generation given to the slot
+	 * @return False if the slot is used by a stored entry
+	 */
+	bool ReserveEntrySlot(int32 EntryId, int32 Generation);
+
+	/** Drops the slot reserved by ReserveEntrySlot if no entry used it */
+	void ClearEntrySlotReservation() { ReservedEntryId = INDEX_NONE; }
+
 	void SetOwningComponent(UInventorySystemComponent* Component);
 	void SetOwningContainer(UInventoryContainer* Container);
 
 protected:
 	UItemInstance* CreateItemInstance(const TSubclassOf<UItemDefinition>& DefinitionClass, int32& Count);
+	/**
+	 * Creates a new stack of a commodity definition, holding the definition and count without item instance
+	 * @param DefinitionClass The commodity definition class, already validated with CanAddDefinition
+	 * @param Count The number of items to store, decremented by the count of the new stack
+	 * @return True if the stack has been created
+	 */
+	bool CreateCommodityEntry(const TSubclassOf<UItemDefinition>& DefinitionClass, int32& Count);
 
 	/**
 	 * Checks if an item of the specified definition can be added
@@ -103,6 +312,63 @@ protected:
 	 * @return True if the item can be added, false otherwise
 	 */
 	bool CanAdd(const TSubclassOf<UItemDefinition>& DefinitionClass, FGameplayTag& OutFailureReason, int32 InCount = 1);
+	/**
+	 * Checks the conditions of CanAdd not depending on the added count nor the current content of the list
+	 * @param DefinitionClass The item definition class to check
+	 * @param OutFailureReason
+	 * @return True if items of the definition can be stored in this list, false otherwise
+	 */
+	bool CanAddDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass, FGameplayTag& OutFailureReason);
+	/**
+	 * Checks the conditions of CanAdd depending on the added count and the current content of the list (e.g. uniqueness)
+	 * @param DefinitionClass The item definition class to check, already validated with CanAddDefinition
+	 * @param OutFailureReason
+	 * @param InCount
+	 * @return True if the count can be added, false otherwise
+	 */
+	bool CanAddCount(const TSubclassOf<UItemDefinition>& DefinitionClass, FGameplayTag& OutFailureReason, int32 InCount = 1);
+
+	/**
+	 * Tops up the existing stacks of a definition then creates new ones for the remaining count
+	 * @param DefinitionClass The item definition class to add, already validated with CanAddDefinition
+	 * @param Count The number of items to add
+	 * @param OutResult Receives the modified and created instances, or the failure reason
+	 */
+	void Internal_AddFromDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 Count, FInventoryResult& OutResult);
+	/**
+	 * Adds items of a definition to its existing stacks, without validation
+	 * @param DefinitionClass The item definition class to add, already validated
+	 * @param Count The number of items to add
+	 * @param OutResult Receives the instances of the modified stacks
+	 * @return The number of items that did not fit in the existing stacks
+	 */
+	int32 TopUpStacks(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 Count, FInventoryResult& OutResult);
+	/**
+	 * Creates new stacks of a definition for the given count, checking the uniqueness before each one
+	 * @param DefinitionClass The item definition class to add, already validated
+	 * @param RemainingCount The number of items to store in the new stacks
+	 * @param OutResult Receives the created instances, or the failure reason
+	 */
+	void CreateStacks(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 RemainingCount, FInventoryResult& OutResult);
+	/**
+	 * Stores an instance in a new entry, without validation
+	 * @param ItemInstance The instance to store, its definition already validated with CanAddDefinition and CanAddStacks
+	 * @param Count The stack count of the new entry
+	 */
+	void InsertInstance(UItemInstance* ItemInstance, int32 Count);
+	/**
+	 * Stores a commodity in a new entry, without validation
+	 * @param DefinitionClass The commodity definition class
+	 * @param Count The stack count of the new entry
+	 * @return The index of the new entry
+	 */
+	int32 InsertCommodity(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 Count);
+	/**
+	 * Modifies the stack count of an entry, keeping the indices and aggregates in sync and notifying the change
+	 * @param Index The index of the modified entry
+	 * @param NewCount The new stack count, greater than zero
+	 */
+	void SetEntryStackCount(int32 Index, int32 NewCount);
 
 	/**
 	 * Called when an entry is changed.
@@ -123,6 +389,97 @@ protected:
 	 */
 	void Internal_OnEntryRemoved(int32 Index, const FInventoryEntry& Entry) const;
 
+	/**
+	 * Registers a newly added entry in the list indices and in the owning component instance lookup.
+	 * @param Index The index of the added entry.
+	 */
+	void Internal_TrackEntry(int32 Index);
+
+	/**
+	 * Removes the entry at the given index from the array and keeps the indices in sync.
+	 * The last entry is swapped into the removed position, outstanding handles are kept valid by the slot table.
+	 * @param Index The index of the entry to remove.
+	 */
+	void Internal_RemoveEntryAt(int32 Index);
+
+	/**
+	 * Assigns the reserved slot, or a free one, to the entry at the given index. Called on authority only, clients receive
+	 * the slot with the entry.
+	 * @param Index The index of the added entry.
+	 */
+	void AllocateEntrySlot(int32 Index);
+	/**
+	 * Frees the slot of the entry at the given index, making every handle to this entry stale.
+	 * @param Index The index of the removed entry.
+	 */
+	void ReleaseEntrySlot(int32 Index);
+
+	/**
+	 * Registers the entry at the given index in the definition and instance indices.
+	 * @param Index The index of the entry to register.
+	 * @return False if the entry definition could not be resolved yet (e.g. instance not replicated), true otherwise.
+	 */
+	bool IndexEntry(int32 Index) const;
+	/**
+	 * Unregisters the entry at the given index from the definition and instance indices.
+	 * @param Index The index of the entry to unregister.
+	 */
+	void UnindexEntry(int32 Index) const;
+	/**
+	 * Applies a stack count variation of an already indexed entry to its definition total.
+	 * @param Index The index of the modified entry.
+	 * @param OldCount The stack count of the entry before the modification.
+	 */
+	void ReindexEntryCount(int32 Index, int32 OldCount) const;
+	/**
+	 * Points the indices at the new position of an entry moved in the array.
+	 * @param FromIndex The previous index of the moved entry.
+	 * @param ToIndex The new index of the moved entry.
+	 */
+	void RelocateEntryIndex(int32 FromIndex, int32 ToIndex) const;
+
+	/**
+	 * Accounts an entry in the aggregates, once its definition is resolved.
+	 * @param Entry The added entry.
+	 */
+	void AggregateEntry(const FInventoryEntry& Entry) const;
+	/**
+	 * Removes the contribution of an entry from the aggregates.
+	 * @param Entry The removed entry.
+	 */
+	void UnaggregateEntry(const FInventoryEntry& Entry) const;
+	/**
+	 * Applies the stack count variation of an entry to the aggregates, or accounts it if it was not yet.
+	 * @param Entry The modified entry.
+	 */
+	void ReaggregateEntryCount(const FInventoryEntry& Entry) const;
+	/**
+	 * Adds or removes an entry from the tag index, under every tag of its definition and their parents.
+	 * @param EntryId The slot identifier of the entry.
+	 * @param DefinitionClass The definition of the entry.
+	 * @param bAdd True to index the entry, false to unindex it.
+	 */
+	void UpdateTagIndex(int32 EntryId, const TSubclassOf<UItemDefinition>& DefinitionClass, bool bAdd) const;
+	/**
+	 * Applies a variation of stacks and items of a definition to the aggregates.
+	 * @param DefinitionClass The definition of the items.
+	 * @param StackDelta The number of added stacks, negative for removed ones.
+	 * @param CountDelta The number of added items, negative for removed ones.
+	 */
+	void ApplyAggregateDelta(const TSubclassOf<UItemDefinition>& DefinitionClass, int32 StackDelta, int32 CountDelta) const;
+
+	/** Marks an entry for fast array replication and the list for push model replication */
+	void MarkEntryDirty(FInventoryEntry& Entry);
+	/** Marks the whole array for fast array replication and the list for push model replication */
+	void MarkListDirty();
+	/** Marks the list property of the owning container dirty for push model replication */
+	void MarkOwnerDirty() const;
+
+	/** Rebuilds the indices from scratch if they have been invalidated */
+	void ConditionalRebuildIndex() const;
+	/** Rebuilds the indices from scratch */
+	void RebuildIndex() const;
+
 	/** Array of inventory entries managed by this list */
 	UPROPERTY()
 	TArray<FInventoryEntry> Entries;
@@ -134,6 +491,46 @@ protected:
 	/** The inventory container that owns this list. Not replicated */
 	UPROPERTY(NotReplicated)
 	TObjectPtr<UInventoryContainer> OwningContainer = nullptr;
+
+	/**
+	 * Entries grouped by definition class, maintained on every mutation. Not replicated.
+	 * Rebuilt lazily on clients when replication reorders entries or delivers them before their instance.
+	 */
+	mutable TMap<TSubclassOf<UItemDefinition>, FInventoryDefinitionIndex> DefinitionIndex;
+
+	/** Entry index of each stored item instance, maintained on every mutation. Not replicated */
+	mutable TMap<TObjectKey<UItemInstance>, int32> InstanceIndex;
+
+	/**
+	 * Slot table resolving FInventoryEntry::EntryId to entry indices, maintained on every mutation. Not replicated.
+	 * Entries carry their slot identifier and generation, so clients rebuild it lazily along with the other indices.
+	 */
+	mutable TArray<FInventoryEntrySlot> Slots;
+
+	/** Slots released by removed entries, reused by the next additions. Authority only */
+	TArray<int32> FreeSlots;
+
+	/** Slot given to the next added entry instead of a free one, see ReserveEntrySlot. Authority only */
+	int32 ReservedEntryId = INDEX_NONE;
+	int32 ReservedGeneration = 0;
+
+	/** True when the indices no longer match Entries and must be rebuilt before the next query */
+	mutable bool bIndexDirty = false;
+
+	/** Running totals of the entries, updated on every mutation and replication callback. Not replicated */
+	mutable FInventoryAggregates Aggregates;
+
+	/** True when some entries could not be aggregated yet because their definition was not resolved */
+	mutable bool bAggregatesPending = false;
+
+	/** Slot identifiers of the entries locked by pending transactions, see UInventoryTransaction. Authority only */
+	TSet<int32> LockedEntries;
+
+	/**
+	 * Slot identifiers of the aggregated entries per tag of their definition, parent tags included. Not replicated.
+	 * Keyed by slot identifier rather than index, so that it is unaffected by the reordering of the entries.
+	 */
+	mutable TMap<FGameplayTag, TSet<int32>> TagIndex;
 };
 
 // Required to specify that this structure uses a NetDeltaSerializer method to help serialization operation decision
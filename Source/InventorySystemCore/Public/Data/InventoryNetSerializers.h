@@ -0,0 +1,56 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if UE_WITH_IRIS
+
+#include "Data/DefinitionNetIdTable.h"
+#include "Iris/Core/NetObjectReference.h"
+#include "Iris/Serialization/NetSerializer.h"
+
+/**
+ * Building blocks of the Iris serializers of the inventory and equipment structs. Definition classes are quantized as
+ * their FDefinitionNetIdTable codes, the classes missing from the table and other objects as object references through
+ * the serializer of object properties.
+ */
+namespace UE::Net::InventoryNetSerializers
+{
+	/** Definition class quantized as its net code, with a reference for the classes missing from the table */
+	struct FQuantizedDefinitionClass
+	{
+		uint32 NetCode;
+		FNetObjectReference UnlistedClass;
+	};
+
+	inline bool operator==(const FQuantizedDefinitionClass& A, const FQuantizedDefinitionClass& B)
+	{
+		return A.NetCode == B.NetCode && A.UnlistedClass == B.UnlistedClass;
+	}
+
+	INVENTORYSYSTEMCORE_API void QuantizeObject(FNetSerializationContext& Context, UObject* Object, FNetObjectReference& Target);
+	INVENTORYSYSTEMCORE_API UObject* DequantizeObject(FNetSerializationContext& Context, const FNetObjectReference& Source);
+	INVENTORYSYSTEMCORE_API void SerializeObject(FNetSerializationContext& Context, const FNetObjectReference& Source);
+	INVENTORYSYSTEMCORE_API void DeserializeObject(FNetSerializationContext& Context, FNetObjectReference& Target);
+	INVENTORYSYSTEMCORE_API void CollectObjectReference(FNetSerializationContext& Context, const FNetCollectReferencesArgs& OuterArgs, const FNetObjectReference& Source);
+
+	/**
+	 * Quantizes a definition class as its code in the table of its base class
+	 * @param BaseClass The definition base class, selecting the table
+	 */
+	INVENTORYSYSTEMCORE_API void QuantizeDefinitionClass(FNetSerializationContext& Context, const UClass* BaseClass, UClass* Class, FQuantizedDefinitionClass& Target);
+
+	/**
+	 * Resolves a quantized definition class
+	 * @param BaseClass The definition base class, selecting the table
+	 * @return The class, or nullptr if none was sent or the identifier is unknown
+	 */
+	INVENTORYSYSTEMCORE_API UClass* DequantizeDefinitionClass(FNetSerializationContext& Context, const UClass* BaseClass, const FQuantizedDefinitionClass& Source);
+
+	INVENTORYSYSTEMCORE_API void SerializeDefinitionClass(FNetSerializationContext& Context, const FQuantizedDefinitionClass& Source);
+	INVENTORYSYSTEMCORE_API void DeserializeDefinitionClass(FNetSerializationContext& Context, FQuantizedDefinitionClass& Target);
+	INVENTORYSYSTEMCORE_API void CollectDefinitionClassReference(FNetSerializationContext& Context, const FNetCollectReferencesArgs& OuterArgs, const FQuantizedDefinitionClass& Source);
+}
+
+#endif
@@ -0,0 +1,176 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "InventoryPrediction.generated.h"
+
+class UInventoryContainer;
+class UItemDefinition;
+
+/**
+ * Defines the inventory operations a client can predict
+ */
+UENUM(BlueprintType)
+enum class EInventoryPredictedOperation : uint8
+{
+	Consume, ///< Items are removed from a stack and destroyed
+	Move ///< Items are moved from a stack to another container
+};
+
+/**
+ * Defines the lifecycle steps of a predicted change reported to the client
+ */
+UENUM(BlueprintType)
+enum class EInventoryPredictionState : uint8
+{
+	Predicted, ///< The change shows in the predicted getters of the component, waiting for the server
+	Confirmed, ///< The server applied the change, the replicated state shows it or soon will
+	RolledBack ///< The server refused the change or did not answer in time, the predicted getters no longer include it
+};
+
+/**
+ * @struct FInventoryPredictedChange
+ * @see FInventoryPredictionOverlay, UInventorySystemComponent
+ * @brief A change predicted on the client ahead of the server, identified by its prediction key
+ * @details Only the predicted getters of the component include it, e.g. GetPredictedStackCount: the replicated state
+ * is never modified by the client
+ */
+USTRUCT(BlueprintType)
+struct INVENTORYSYSTEMCORE_API FInventoryPredictedChange
+{
+	GENERATED_BODY()
+
+	/** Key shared with the server, greater than zero */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory|Prediction")
+	int32 PredictionKey = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory|Prediction")
+	EInventoryPredictedOperation Operation = EInventoryPredictedOperation::Consume;
+
+	/** The source container */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory|Prediction")
+	TObjectPtr<UInventoryContainer> Container = nullptr;
+
+	/** The container receiving the items of a move */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory|Prediction")
+	TObjectPtr<UInventoryContainer> TargetContainer = nullptr;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory|Prediction")
+	TSubclassOf<UItemDefinition> DefinitionClass = nullptr;
+
+	/** Identifier of the source stack */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory|Prediction")
+	int32 EntryId = INDEX_NONE;
+
+	/** Generation of the source stack */
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory|Prediction")
+	int32 Generation = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory|Prediction")
+	int32 Count = 0;
+
+	/** World time after which the prediction is rolled back if still pending */
+	double ExpirationTime = 0.0;
+
+	/** Replicated stack count of the source stack when the change was predicted */
+	int32 SourceStackCount = INDEX_NONE;
+
+	/** Replicated count of the definition in the target container of a move when the change was predicted */
+	int32 ReceivingCount = 0;
+
+	/** True once the server accepted the change, until its replicated state is received */
+	bool bAccepted = false;
+
+	/** True once the replicated state of the affected containers shows the change */
+	bool bReplicated = false;
+
+	/**
+	 * Gets the variation of the count of a definition in a container predicted by this change
+	 * @param InContainer The queried container
+	 * @param InDefinitionClass The queried item definition
+	 * @return The number of predicted items, negative for removed ones
+	 */
+	int32 GetCountDelta(const UInventoryContainer* InContainer, const TSubclassOf<UItemDefinition>& InDefinitionClass) const;
+
+	/** @return True if the change modifies the given container */
+	bool Affects(const UInventoryContainer* InContainer) const;
+
+	/** Records the replicated state the change applies to, compared by IsReplicated */
+	void CaptureReplicatedState();
+
+	/**
+	 * Checks if the replicated state shows the change: the source stack lost at least Count items, or its entry was
+	 * removed, and the target container of a move gained at least Count items of the definition. State of unrelated
+	 * changes, e.g. an addition to the source stack, does not qualify
+	 * @return True if the prediction can be replaced by the replicated state
+	 */
+	bool IsReplicated() const;
+};
+
+/**
+ * @struct FInventoryPredictionOverlay
+ * @see FInventoryPredictedChange, UInventorySystemComponent
+ * @brief The pending predicted changes of a client, layered over the replicated inventory state without modifying it
+ * @details The replicated lists stay authoritative: queries add the deltas of the pending changes to the replicated
+ * counts, so a rollback only has to drop the change. An accepted change is dropped once the replicated state of its
+ * containers shows it, see FInventoryPredictedChange::IsReplicated. Replicated state received before the answer of the
+ * server, e.g. of another change, does not end the prediction. UI showing predicted changes reads the predicted
+ * getters of UInventorySystemComponent rather than the containers.
+ */
+USTRUCT()
+struct INVENTORYSYSTEMCORE_API FInventoryPredictionOverlay
+{
+	GENERATED_BODY()
+
+	/**
+	 * Records a predicted change, assigning its prediction key and capturing the replicated state it applies to
+	 * @param Change The predicted change, not applied to the replicated state
+	 * @return The recorded change
+	 */
+	const FInventoryPredictedChange& AddPrediction(FInventoryPredictedChange Change);
+
+	/**
+	 * Applies the answer of the server to a prediction
+	 * @param PredictionKey The key of the prediction
+	 * @param bAccepted True if the server applied the change
+	 * @param OutChange Receives the change if the prediction ended
+	 * @return True if the prediction ended: refused, or accepted with its replicated state already received
+	 */
+	bool Acknowledge(int32 PredictionKey, bool bAccepted, FInventoryPredictedChange& OutChange);
+
+	/**
+	 * Ends the accepted predictions of a container whose received replicated state shows them
+	 * @param Container The container that received replicated state
+	 * @param OutEnded Receives the ended predictions
+	 */
+	void Reconcile(const UInventoryContainer* Container, TArray<FInventoryPredictedChange>& OutEnded);
+
+	/**
+	 * Ends the predictions that were not answered, or whose replicated state was not received, in time
+	 * @param Now The current world time
+	 * @param OutExpired Receives the expired predictions, accepted ones keeping bAccepted set
+	 */
+	void Expire(double Now, TArray<FInventoryPredictedChange>& OutExpired);
+
+	/** @return The predicted variation of the count of a definition in a container */
+	int32 GetCountDelta(const UInventoryContainer* Container, const TSubclassOf<UItemDefinition>& DefinitionClass) const;
+
+	/** @return The predicted variation of the stack count of an entry */
+	int32 GetEntryDelta(const UInventoryContainer* Container, int32 EntryId, int32 Generation) const;
+
+	/** @return The earliest expiration time of the pending predictions, or zero if none */
+	double GetNextExpirationTime() const;
+
+	bool IsEmpty() const { return Predictions.IsEmpty(); }
+
+	const TArray<FInventoryPredictedChange>& GetPredictions() const { return Predictions; }
+
+private:
+	UPROPERTY()
+	TArray<FInventoryPredictedChange> Predictions;
+
+	/** Key of the last prediction, keys are never reused by a component */
+	int32 LastPredictionKey = 0;
+};
@@ -28,8 +28,9 @@ class INVENTORYSYSTEMCORE_API UInventorySet : public UPrimaryDataAsset
 
 public:
 	/**
-	 * Grants all items defined in this set to the specified inventory system component
+	 * Grants all items defined in this set to the specified inventory system component, in a single batched operation
 	 * @param InventorySystemComp The target inventory component that will receive the items
+	 * @return All the modified or created instances, with the first failure reason met if any
 	 * @see UInventorySystemComponent
 	 */
 	FInventoryResult GiveToInventorySystem(UInventorySystemComponent* InventorySystemComp);
@@ -0,0 +1,233 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Memory/MemoryView.h"
+#include "Templates/SubclassOf.h"
+
+class UInventoryContainer_Grid;
+class UInventorySystemComponent;
+class UItemComponent;
+class UItemDefinition;
+struct FInventoryEntryHandle;
+struct FSoftObjectPath;
+
+/**
+ * Versions of the inventory snapshot format. Snapshots of any older version are still read
+ */
+enum class EInventorySnapshotVersion : uint16
+{
+	Initial = 1,
+	/** Entries keep their slot identifier and generation, so that journals can be folded into the snapshot */
+	EntryIds,
+
+	// New versions go above this line
+	LatestPlusOne,
+	Latest = LatestPlusOne - 1
+};
+
+/** State of an item component, pointing into the decoded buffer */
+struct FInventorySnapshotComponent
+{
+	/** Index of the component class in the component class table */
+	int32 ClassIndex = INDEX_NONE;
+
+	/** Data written by UItemComponent::SerializeSnapshot */
+	FMemoryView Data;
+};
+
+/** A stack of a container */
+struct FInventorySnapshotEntry
+{
+	/** Identifier and generation of the slot of the entry when saved, INDEX_NONE before EntryIds */
+	int32 EntryId = INDEX_NONE;
+	int32 Generation = 0;
+
+	/** Index of the item definition in the definition table */
+	int32 DefinitionIndex = INDEX_NONE;
+
+	int32 StackCount = 0;
+
+	/** Position in grid containers, packed by InventoryGrid::PackPosition. MAX_uint16 if not placed */
+	uint16 PackedGridPosition = MAX_uint16;
+
+	/** False for commodity entries, which have no item instance, tags nor components */
+	bool bHasInstance = false;
+
+	/** Indices of the instance tags in the name table */
+	TArray<int32, TInlineAllocator<4>> TagIndices;
+
+	TArray<FInventorySnapshotComponent, TInlineAllocator<2>> Components;
+};
+
+/** The stacks of a container, in storage order */
+struct FInventorySnapshotContainer
+{
+	/** Index of the container tag in the name table */
+	int32 TagIndex = INDEX_NONE;
+
+	TArray<FInventorySnapshotEntry> Entries;
+};
+
+/** Paths and names written once and referred to by index, shared by snapshots and journals */
+struct INVENTORYSYSTEMCORE_API FInventorySnapshotTables
+{
+	/** Class paths of the item definitions */
+	TArray<FString> DefinitionPaths;
+
+	/** Container tags and instance tags */
+	TArray<FName> Names;
+
+	/** Class paths of the item components */
+	TArray<FString> ComponentClassPaths;
+
+	/** Each function returns the index of the value, added at the end of its table if missing */
+	int32 AddDefinitionPath(const FString& Path);
+	int32 AddName(FName Name);
+	int32 AddComponentClassPath(const FString& Path);
+
+	void Reset();
+
+private:
+	TMap<FString, int32> DefinitionIndices;
+	TMap<FName, int32> NameIndices;
+	TMap<FString, int32> ComponentClassIndices;
+};
+
+/** Paths and names of a snapshot resolved to their classes and tags, by index. Game thread only */
+struct INVENTORYSYSTEMCORE_API FInventorySnapshotResolvedTables
+{
+	/** Null for the definitions which could not be resolved, whose entries are skipped */
+	TArray<TSubclassOf<UItemDefinition>> Definitions;
+
+	TArray<FGameplayTag> Tags;
+
+	/** Null for the components which could not be resolved, whose states are skipped */
+	TArray<TObjectPtr<UClass>> ComponentClasses;
+
+	/** Reports the classes to the garbage collector, while materializing over several frames */
+	void AddReferencedObjects(FReferenceCollector& Collector);
+};
+
+/**
+ * @class FInventorySnapshot
+ * @see UInventorySystemComponent::SaveSnapshot, UItemComponent::SerializeSnapshot, FInventoryJournal
+ * @brief Compact and versioned binary image of the containers of an inventory, for persistence between sessions
+ * @details Definitions, tags and component classes are written once in tables, entries referring to them by packed
+ * indices. Paths are only resolved when the snapshot is applied, through the classes loaded by the FDefinitionNetIdTable
+ * or streamed in beforehand, so a snapshot survives content changes, unlike the network identifiers. Decoding does not copy the component states:
+ * they point into the source buffer, e.g. a memory mapped file, which must outlive the decoded snapshot. Decoding does
+ * not touch any UObject and may run on any thread; capturing and applying it is game thread only.
+ *
+ * Layout: magic, version, then the definition paths, names and component class paths tables, then the containers
+ * with their entries. Component states are prefixed by their size, so states of removed components are skipped.
+ */
+class INVENTORYSYSTEMCORE_API FInventorySnapshot
+{
+	friend class FInventoryJournal;
+
+public:
+	/** Identifies inventory snapshots, 'INVS' */
+	static constexpr uint32 Magic = 0x53564E49;
+
+	/**
+	 * Writes the containers of an inventory
+	 * @param Inventory The inventory to save
+	 * @param OutData Receives the snapshot, appended to its content
+	 */
+	static void Write(UInventorySystemComponent& Inventory, TArray<uint8>& OutData);
+
+	/**
+	 * Captures the containers of an inventory, the component states being owned by this object
+	 * @param Inventory The inventory to save
+	 */
+	void Capture(UInventorySystemComponent& Inventory);
+
+	/**
+	 * Writes the captured or decoded snapshot with the latest version
+	 * @param OutData Receives the snapshot, appended to its content
+	 */
+	void Encode(TArray<uint8>& OutData) const;
+
+	/**
+	 * Reads the tables and entries of a snapshot, without resolving any path
+	 * @param Data The snapshot, which must outlive this object
+	 * @return False if the data is not a snapshot, is truncated or comes from a newer version
+	 */
+	bool Decode(FMemoryView Data);
+
+	/**
+	 * Replaces the content of an inventory with the decoded snapshot, rebuilding the instances. Authority only.
+	 * Entries are stored as saved, without the storage and capacity checks of additions. Entries whose container or
+	 * definition is not available anymore are skipped with a warning
+	 * @param Inventory The inventory to restore
+	 * @return False if the inventory has no authority
+	 */
+	bool Apply(UInventorySystemComponent& Inventory) const;
+
+	/**
+	 * Gets the class paths of the definitions and components not loaded yet, to be loaded before resolving the tables
+	 * @param OutPaths Receives the paths. Game thread only
+	 */
+	void GetUnloadedPaths(TArray<FSoftObjectPath>& OutPaths) const;
+
+	/**
+	 * Resolves each path and name of the tables once, whatever the number of entries referring to it. Definitions are
+	 * never loaded: those missing from the net id table must be loaded beforehand, see GetUnloadedPaths. Game thread only
+	 * @param OutResolved Receives the classes and tags
+	 */
+	void Resolve(FInventorySnapshotResolvedTables& OutResolved) const;
+
+	/**
+	 * Rebuilds an entry in an inventory, after it has been emptied. Used by Apply and by time-sliced loads
+	 * @param Inventory The inventory being restored, on authority
+	 * @param Resolved The resolved tables of this snapshot
+	 * @param ContainerIndex The index of the container in GetContainers
+	 * @param EntryIndex The index of the entry in its container
+	 * @return False if the entry was skipped
+	 */
+	bool ApplyEntry(UInventorySystemComponent& Inventory, const FInventorySnapshotResolvedTables& Resolved, int32 ContainerIndex, int32 EntryIndex) const;
+
+	EInventorySnapshotVersion GetVersion() const { return Version; }
+
+	const TArray<FInventorySnapshotContainer>& GetContainers() const { return Containers; }
+
+	/** Gets the number of entries of every container */
+	int32 GetNumEntries() const;
+
+private:
+	/** Writes an entry, its indices referring to the given tables */
+	static void WriteEntry(FArchive& Ar, const FInventorySnapshotEntry& Entry);
+
+	/**
+	 * Reads an entry written by WriteEntry
+	 * @param Ar The archive reading Data
+	 * @param Data The buffer read by the archive, the component states pointing into it
+	 * @param EntryVersion The version the entry was written with
+	 * @param Tables The tables the indices refer to, only used for bounds checking
+	 * @param OutEntry Receives the entry
+	 * @return False if the data is corrupted, the archive being in error
+	 */
+	static bool ReadEntry(FArchive& Ar, FMemoryView Data, EInventorySnapshotVersion EntryVersion, const FInventorySnapshotTables& Tables, FInventorySnapshotEntry& OutEntry);
+
+	/**
+	 * Captures a stored entry, interning its paths and names in the given tables
+	 * @param Handle The handle of the entry
+	 * @param Grid The container of the entry if it is a grid, to capture its position
+	 * @param Tables The tables receiving the paths and names
+	 * @param OutStates Receives the component states, referred to by the entry
+	 * @param OutEntry Receives the entry
+	 */
+	static void CaptureEntry(const FInventoryEntryHandle& Handle, const UInventoryContainer_Grid* Grid, FInventorySnapshotTables& Tables, TArray<TArray<uint8>>& OutStates, FInventorySnapshotEntry& OutEntry);
+
+	EInventorySnapshotVersion Version = EInventorySnapshotVersion::Latest;
+
+	FInventorySnapshotTables Tables;
+
+	TArray<FInventorySnapshotContainer> Containers;
+
+	/** Component states of captured or folded entries, each array keeping its allocation when the outer one grows */
+	TArray<TArray<uint8>> OwnedStates;
+};
@@ -0,0 +1,68 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+/**
+ * @struct FInventoryTagBitset
+ * @see UItemDefinition::GetTagBits, FStoragePolicyPredicate
+ * @brief Set of gameplay tags stored as one bit per tag, for allocation free tag checks
+ * @details Bits are dense process-local identifiers assigned on first registration of each tag, so that the sets of
+ * few tags fit in the inline words. Tags do not imply their parents: containers must be expanded before conversion
+ * for hierarchical checks.
+ */
+struct INVENTORYSYSTEMCORE_API FInventoryTagBitset
+{
+	/**
+	 * Gets the bit of a tag, registering it on first call
+	 * @param Tag The tag to register
+	 * @return The bit of the tag, or INDEX_NONE for an invalid tag
+	 */
+	static int32 RegisterTag(const FGameplayTag& Tag);
+
+	/**
+	 * Makes the set of the tags of a container
+	 * @param Tags The tags to set, registered if needed
+	 * @return The bitset holding exactly the given tags
+	 */
+	static FInventoryTagBitset FromTags(const FGameplayTagContainer& Tags);
+
+	/** Adds a tag to the set, registering it if needed */
+	void AddTag(const FGameplayTag& Tag);
+
+	/** Checks if every tag of another set is in this one, true if the other set is empty */
+	bool HasAll(const FInventoryTagBitset& Other) const
+	{
+		for (int32 WordIndex = 0; WordIndex < Other.Words.Num(); ++WordIndex)
+		{
+			const uint64 Word = Words.IsValidIndex(WordIndex) ? Words[WordIndex] : 0;
+			if ((Word & Other.Words[WordIndex]) != Other.Words[WordIndex])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Checks if at least one tag of another set is in this one, false if the other set is empty */
+	bool HasAny(const FInventoryTagBitset& Other) const
+	{
+		const int32 NumWords = FMath::Min(Words.Num(), Other.Words.Num());
+		for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+		{
+			if ((Words[WordIndex] & Other.Words[WordIndex]) != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** Checks if the set holds no tag */
+	bool IsEmpty() const { return Words.IsEmpty(); }
+
+	/** Bits of the set, the highest word always being non zero */
+	TArray<uint64, TInlineAllocator<2>> Words;
+};
@@ -29,4 +29,31 @@ public:
 	virtual void OnInstanceCreated(UItemInstance* Instance)
 	{
 	}
+
+	/**
+	 * Gets the type id of a fragment class, registering it on first call
+	 * @details Type ids are dense and process-local, used to index the fragment tables of the item definitions.
+	 * @param FragmentClass The fragment class, or one of its parents
+	 * @return The type id of the class
+	 */
+	static int32 RegisterFragmentType(const UClass* FragmentClass);
+
+	/**
+	 * Gets the type id of an already registered fragment class
+	 * @param FragmentClass The fragment class
+	 * @return The type id of the class, or INDEX_NONE if it has never been registered
+	 */
+	static int32 FindFragmentTypeId(const UClass* FragmentClass);
+
+	/**
+	 * Template version of RegisterFragmentType, resolved once per fragment type
+	 * @tparam T The fragment class type
+	 * @return The type id of the class
+	 */
+	template <typename T>
+	static int32 GetFragmentTypeId()
+	{
+		static const int32 TypeId = RegisterFragmentType(T::StaticClass());
+		return TypeId;
+	}
 };
@@ -0,0 +1,32 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ItemFragment_Storable.h"
+#include "ItemFragment_GridStorable.generated.h"
+
+/**
+ * @class UItemFragment_GridStorable
+ * @see UItemFragment_Storable, UInventoryContainer_Grid
+ * @brief Storable fragment giving an item a rectangular footprint in grid containers.
+ * @details Items without this fragment occupy a single cell of grid containers.
+ */
+UCLASS(DisplayName = "Grid Storable Fragment")
+class INVENTORYSYSTEMCORE_API UItemFragment_GridStorable : public UItemFragment_Storable
+{
+	GENERATED_BODY()
+
+public:
+	/** Number of columns occupied by the item */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grid", meta = (ClampMin = 1, ClampMax = 64))
+	int32 Width = 1;
+
+	/** Number of rows occupied by the item */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grid", meta = (ClampMin = 1, ClampMax = 511))
+	int32 Height = 1;
+
+	/** Allows the item to be placed rotated by a quarter turn, swapping its width and height */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grid")
+	bool bCanRotate = true;
+};
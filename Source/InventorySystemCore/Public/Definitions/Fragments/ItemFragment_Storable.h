@@ -47,6 +47,13 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Storage", meta = (Bitmask, BitmaskEnum = "/Script/InventorySystemCore.EItemStorageFlags"))
 	int32 StorageFlags;
 
+	/**
+	 * Stores the item as a plain counter, without item instance. Suited to ammunition, currencies or crafting materials.
+	 * Commodity entries have no per-item state: fragments are not given an instance, so no item component is added.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Storage")
+	bool bCommodity = false;
+
 	/**
 	 * Checks if this item can be stacked with others of the same type
 	 * @return True if the item can be stacked (MaxStackCount > 1), false otherwise
@@ -60,4 +67,11 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable)
 	bool IsUnique() const;
+
+	/**
+	 * Checks if this item is stored as a counter without item instance
+	 * @return True if the item is a commodity
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool IsCommodity() const { return bCommodity; }
 };
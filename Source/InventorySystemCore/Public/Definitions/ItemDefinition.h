@@ -5,12 +5,13 @@
 #include "CoreMinimal.h"
 #include "GameplayTagAssetInterface.h"
 #include "GameplayTagContainer.h"
+#include "Data/InventoryTagBitset.h"
+#include "Definitions/Fragments/ItemFragment.h"
 #include "UObject/Object.h"
 
 #include "ItemDefinition.generated.h"
 
 class UInventorySystemComponent;
-class UItemFragment;
 
 /**
  * @class UItemDefinition
@@ -29,6 +30,7 @@ public:
 	UItemDefinition(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 	// UObject
+	virtual void PostInitProperties() override;
 	virtual void PostLoad() override;
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -63,7 +65,57 @@ public:
 	 * @see FindFragmentByClass
 	 */
 	template <typename T>
-	const T* FindFragmentByClass() const { return Cast<T>(FindFragmentByClass(T::StaticClass())); }
+	const T* FindFragmentByClass() const { return static_cast<const T*>(FindFragmentByTypeId(UItemFragment::GetFragmentTypeId<T>(), T::StaticClass())); }
+
+	/**
+	 * Searches for a fragment by its registered type id, using the fragment table when built
+	 * @param TypeId The type id of the fragment class, see UItemFragment::RegisterFragmentType
+	 * @param FragmentClass The fragment class, searched linearly if the fragment table is not built
+	 * @return The first fragment of the class or one of its children, or nullptr if not found
+	 */
+	const UItemFragment* FindFragmentByTypeId(const int32 TypeId, const UClass* FragmentClass) const
+	{
+		if (bFragmentTableBuilt)
+		{
+			// Types registered after the table build cannot be a parent of one of the fragments
+			const UItemFragment* Fragment = FragmentTable.IsValidIndex(TypeId) ? FragmentTable[TypeId].Get() : nullptr;
+#if WITH_EDITOR
+			// Blueprint fragment classes may have been recompiled since the table build, registering new types
+			if (!Fragment)
+			{
+				return FindFragmentByClass_Linear(FragmentClass);
+			}
+#endif
+			return Fragment;
+		}
+		return FindFragmentByClass_Linear(FragmentClass);
+	}
+
+	/**
+	 * Rebuilds the fragment table used by the fragment lookups
+	 * @note Automatically called on creation, load and edition. Must be called after modifying Fragments at runtime
+	 */
+	void RebuildFragmentTable();
+
+	/**
+	 * Gets the tags of this definition along with all their parent tags, e.g. Item.Weapon for Item.Weapon.Sword
+	 * @return The expanded tags, built on first access
+	 * @note Used by the hierarchical tag queries of the inventory lists
+	 */
+	const FGameplayTagContainer& GetTagsWithParents() const;
+
+	/**
+	 * Gets the tags of this definition as a bitset, for allocation free checks of the compiled storage policies
+	 * @return The exact tags of the definition, built on first access
+	 * @note Only reflects Tags, overrides of GetOwnedGameplayTags are not considered
+	 */
+	const FInventoryTagBitset& GetTagBits() const;
+
+	/**
+	 * Gets the tags of this definition along with all their parent tags as a bitset
+	 * @return The expanded tags of the definition, built on first access
+	 */
+	const FInventoryTagBitset& GetTagBitsWithParents() const;
 
 	/**
 	 * Checks if this item can be given to the specified inventory
@@ -104,4 +156,33 @@ public:
 	UPROPERTY(Transient)
 	TArray<UItemFragment*> PreviousFragments;
 #endif
+
+protected:
+	/** Searches for a fragment by scanning Fragments, used while the fragment table is not built */
+	const UItemFragment* FindFragmentByClass_Linear(const UClass* FragmentClass) const;
+
+	/**
+	 * First fragment of each registered fragment type, including parent types, indexed by type id. Not serialized.
+	 * Only covers the types registered when built, later types being none of the fragments classes or parents.
+	 */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UItemFragment>> FragmentTable;
+
+	/** True once FragmentTable reflects Fragments */
+	bool bFragmentTableBuilt = false;
+
+	/** Tags and their parents, see GetTagsWithParents. Not serialized */
+	mutable FGameplayTagContainer TagsWithParents;
+
+	/** Tags as a bitset, see GetTagBits. Not serialized */
+	mutable FInventoryTagBitset TagBits;
+
+	/** Tags and their parents as a bitset, see GetTagBitsWithParents. Not serialized */
+	mutable FInventoryTagBitset TagBitsWithParents;
+
+	/** True once the tag caches reflect Tags */
+	mutable bool bTagCacheBuilt = false;
+
+	/** Builds the tag caches if they do not reflect Tags */
+	void ConditionalBuildTagCache() const;
 };
@@ -39,6 +39,15 @@ public:
 	virtual void PostInitialize() {}
 	virtual void Uninitialize() {}
 
+	/**
+	 * Writes or reads the persistent state of this component in an inventory snapshot, see FInventorySnapshot
+	 * @details Called after Initialize when restoring. The state is stored with its size, so reading less than was
+	 * written, e.g. after removing a property, is safe. Properties added later must tolerate the end of the archive.
+	 * Call NotifyPersistentStateChanged whenever this state changes, so that it is journaled.
+	 * @param Ar The archive to write to or read from
+	 */
+	virtual void SerializeSnapshot(FArchive& Ar) {}
+
 	/**
 	 * Returns the item instance that owns this fragment
 	 * @return The owning item instance, or nullptr if not attached
@@ -47,6 +56,9 @@ public:
 	UItemInstance* GetOwningInstance();	
 
 protected:
+
+	/** Reports a change of the state written by SerializeSnapshot, see UItemInstance::NotifyPersistentStateChanged */
+	void NotifyPersistentStateChanged() const;
 	
 	/** The item instance that owns this fragment instance */
 	UPROPERTY(Transient)
@@ -31,6 +31,10 @@ public:
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	// ~UObject
 
+	// UItemComponent
+	virtual void SerializeSnapshot(FArchive& Ar) override;
+	// ~UItemComponent
+
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 	virtual bool CanConsume(const int32 UseCount = 1) const;
 
@@ -5,6 +5,7 @@
 #include "Components/ItemComponent.h"
 #include "CoreMinimal.h"
 #include "Definitions/ItemDefinition.h"
+#include "Instances/ItemInstanceHeader.h"
 #include "UObject/Object.h"
 
 #include "ItemInstance.generated.h"
@@ -26,6 +27,7 @@ class INVENTORYSYSTEMCORE_API UItemInstance : public UObject, public IGameplayTa
 	GENERATED_BODY()
 
 	friend struct FInventoryList;
+	friend class UItemInstancePool;
 
 public:
 	explicit UItemInstance(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
@@ -33,6 +35,9 @@ public:
 	// UObject
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual bool IsSupportedForNetworking() const override { return true; }
+#if UE_WITH_IRIS
+	virtual void RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags) override;
+#endif
 	// ~UObject
 
 	// IGameplayTagAssetInterface
@@ -40,15 +45,44 @@ public:
 	// ~IGameplayTagAssetInterface
 
 	
+	/**
+	 * Sets the definition of this instance and lets its fragments add their components
+	 * @param InDefinition The item definition this instance is based on
+	 */
 	virtual void Initialize(UItemDefinition* InDefinition);
+	/**
+	 * Resets this instance to its freshly constructed state, so it can be initialized again from any definition.
+	 * Components are uninitialized and kept aside to be reused by AddComponent.
+	 */
 	virtual void Uninitialize();
 
+	/**
+	 * Moves this instance under another outer, e.g. when it is traded to the inventory of another actor
+	 * @param NewOuter The new outer, usually the actor owning the receiving inventory
+	 * @note Replicated subobject registration is left to the caller
+	 */
+	void ChangeOuter(UObject* NewOuter);
 	
 	UFUNCTION(BlueprintCallable, Category="Tags")
-	void AddTag(const FGameplayTag Tag) { Tags.AddTag(Tag); }
+	void AddTag(const FGameplayTag Tag);
 
 	UFUNCTION(BlueprintCallable, Category="Tags")
-	void RemoveTag(const FGameplayTag Tag) { Tags.RemoveTag(Tag); }
+	void RemoveTag(const FGameplayTag Tag);
+
+	/**
+	 * Reports a change of the state saved by inventory snapshots, e.g. a tag or a component state, to the inventory
+	 * storing this instance so that it is journaled, see UInventorySystemComponent::SetJournalChanges
+	 */
+	void NotifyPersistentStateChanged();
+
+	/** Checks if tags have been added to this instance on top of the ones of its definition */
+	bool HasInstanceTags() const { return !Tags.IsEmpty(); }
+
+	/** Gets the tags added to this instance on top of the ones of its definition */
+	const FGameplayTagContainer& GetInstanceTags() const { return Tags; }
+
+	/** Gets the components attached to this instance */
+	const TArray<UItemComponent*>& GetComponents() const { return Components; }
 
 	/**
 	 * Gets the inventory system component that owns this item instance
@@ -72,9 +106,10 @@ public:
 
 	/**
 	 * Gets the item definition class associated with this instance.
+	 * Replaces the former DefinitionClass property in Blueprints, the class now replicating within the header.
 	 * @return The item definition class.
 	 */
-	UFUNCTION(BlueprintCallable)
+	UFUNCTION(BlueprintPure)
 	TSubclassOf<UItemDefinition> GetDefinitionClass() const;
 
 	/**
@@ -94,7 +129,11 @@ public:
 	 * Try to find fragment of class FragmentClass in this item's definition
 	 */
 	template <typename T>
-	const T* FindFragmentByClass() const { return Cast<T>(FindFragmentByClass(T::StaticClass())); }
+	const T* FindFragmentByClass() const
+	{
+		const UItemDefinition* ItemDefinition = GetDefinition();
+		return ItemDefinition ? ItemDefinition->FindFragmentByClass<T>() : nullptr;
+	}
 
 	UFUNCTION(BlueprintCallable, BlueprintPure = false)
 	bool HasFragmentByClass(TSubclassOf<UItemFragment> FragmentClass) const;
@@ -135,13 +174,17 @@ protected:
 	 */
 	void SetDefinition(UItemDefinition* InDefinition);
 
+	/** Resolves the shared definition of the replicated definition class */
+	UFUNCTION()
+	void OnRep_Header();
+
 	/** The item definition that this instance is based on.
-	 * Only replicate the class.
+	 * Only replicate the class, as its compact net id.
 	 */
-	UPROPERTY(Replicated, BlueprintReadOnly, Category="Tags")
-	TSubclassOf<UItemDefinition> DefinitionClass;
+	UPROPERTY(ReplicatedUsing=OnRep_Header)
+	FItemInstanceHeader Header;
 
-	/** The Item Definition default object, cached by the local InventorySystemComponent cache */
+	/** The shared Item Definition, resolved through the UItemDefinitionRegistry */
 	UPROPERTY(BlueprintReadOnly, Category="Tags")
 	TWeakObjectPtr<UItemDefinition> Definition;
 
@@ -149,6 +192,10 @@ protected:
 	UPROPERTY(Replicated, BlueprintReadOnly, Category="Tags")
 	TArray<UItemComponent*> Components;
 
+	/** Uninitialized components kept to be reused by the next initialization */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UItemComponent>> DormantComponents;
+
 	/** Tags used to classify or filter this item statically */
 	UPROPERTY(BlueprintReadOnly, Category="Tags")
 	FGameplayTagContainer Tags;
@@ -0,0 +1,44 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SubclassOf.h"
+
+#include "ItemInstanceHeader.generated.h"
+
+class UItemDefinition;
+
+/**
+ * @struct FItemInstanceHeader
+ * @see UItemInstance, FDefinitionNetIdTable
+ * @brief Replicated identity of an item instance, sent as the compact net id of its definition class
+ * @details Serialized by NetSerialize on the legacy replication path and by UE::Net::FItemInstanceHeaderNetSerializer
+ * with Iris.
+ */
+USTRUCT()
+struct INVENTORYSYSTEMCORE_API FItemInstanceHeader
+{
+	GENERATED_BODY()
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FItemInstanceHeader& Other) const
+	{
+		return DefinitionClass == Other.DefinitionClass;
+	}
+
+	/** The definition class of the item instance */
+	UPROPERTY()
+	TSubclassOf<UItemDefinition> DefinitionClass = nullptr;
+};
+
+template <>
+struct TStructOpsTypeTraits<FItemInstanceHeader> : TStructOpsTypeTraitsBase2<FItemInstanceHeader>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
@@ -0,0 +1,44 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "UObject/CoreNetTypes.h"
+
+#include "InventoryReplicationRule.generated.h"
+
+/**
+ * @struct FInventoryReplicationRule
+ * @see UInventorySystemSettings, UInventorySystemComponent
+ * @brief Defines which connections receive an inventory container and its item instances
+ * @details COND_None replicates to every relevant connection, e.g. a loot chest. COND_OwnerOnly restricts the container
+ * to the owning connection, e.g. a backpack. COND_NetGroup restricts it to the player controllers included in NetGroup,
+ * e.g. equipment visible to the team, see APlayerController::IncludeInNetConditionGroup.
+ */
+USTRUCT(BlueprintType)
+struct INVENTORYSYSTEMCORE_API FInventoryReplicationRule
+{
+	GENERATED_BODY()
+
+	/**
+	 * Finds the rule of a container tag, falling back on the rules of its parent tags
+	 * @param Rules The rules per container tag
+	 * @param ContainerTag The tag of the container
+	 * @return The most specific rule, or nullptr if neither the tag nor its parents have one
+	 */
+	static const FInventoryReplicationRule* FindRule(const TMap<FGameplayTag, FInventoryReplicationRule>& Rules, const FGameplayTag& ContainerTag);
+
+	bool operator==(const FInventoryReplicationRule& Other) const
+	{
+		return Condition == Other.Condition && NetGroup == Other.NetGroup;
+	}
+
+	/** Condition of the container and its item instances, in the replicated subobject list of the component */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replication")
+	TEnumAsByte<ELifetimeCondition> Condition = COND_None;
+
+	/** Net condition group receiving the container, used with COND_NetGroup */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replication")
+	FName NetGroup;
+};
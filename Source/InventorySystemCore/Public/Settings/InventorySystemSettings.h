@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DeveloperSettings.h"
+#include "Settings/InventoryReplicationRule.h"
 #include "Settings/ItemFragmentRule.h"
 #include "Definitions/Fragments/ItemFragment.h"
 #include "InventorySystemSettings.generated.h"
@@ -32,5 +33,21 @@ public:
 	TMap<TSubclassOf<UItemFragment>, FItemFragmentRule> FragmentRules;
 #endif
 
+	// Recycle item instances and their components through a per-world pool instead of creating new objects
+	UPROPERTY(config, EditAnywhere, Category = "Pooling")
+	bool bPoolItemInstances = false;
+
+	// Maximum number of released instances kept per instance class, in each world
+	UPROPERTY(config, EditAnywhere, Category = "Pooling", meta = (EditCondition = "bPoolItemInstances", ClampMin = 0))
+	int32 MaxPooledInstances = 256;
+
+	// Delay before a released instance can be reused, leaving time for its destruction to reach the clients
+	UPROPERTY(config, EditAnywhere, Category = "Pooling", meta = (EditCondition = "bPoolItemInstances", ClampMin = 0, Units = "s"))
+	float PooledInstanceReuseDelay = 1.f;
+
+	// Replication of the containers per container tag, applying to the child tags. Inventory components can override them
+	UPROPERTY(config, EditAnywhere, Category = "Replication")
+	TMap<FGameplayTag, FInventoryReplicationRule> ContainerReplicationRules;
+
 	// TODO : Add item categories
 };
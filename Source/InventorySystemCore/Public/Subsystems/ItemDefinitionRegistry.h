@@ -0,0 +1,56 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+
+#include "ItemDefinitionRegistry.generated.h"
+
+class UInventoryCache;
+class UItemDefinition;
+
+/**
+ * @class UItemDefinitionRegistry
+ * @see UEngineSubsystem, UInventoryCache
+ * @brief Process-wide registry resolving item definition classes to their shared definition object
+ * @details Definitions are immutable at runtime, so every inventory and item instance of the process shares a single
+ * definition per class, resolved through one cache owned by this subsystem. Memory used by definitions and their
+ * instanced fragments does not depend on the number of inventories.
+ */
+UCLASS()
+class INVENTORYSYSTEMCORE_API UItemDefinitionRegistry : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// ~USubsystem
+
+	/**
+	 * Gets the registry of the running engine
+	 * @return The registry, or nullptr if the engine subsystems are not initialized yet
+	 */
+	static UItemDefinitionRegistry* Get();
+
+	/**
+	 * Resolves a definition class to its shared definition, through the registry when available
+	 * @param DefinitionClass The item definition class to resolve
+	 * @return The shared definition, or nullptr if the class is not valid
+	 */
+	static UItemDefinition* ResolveDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass);
+
+	/**
+	 * Gets the shared definition of a class
+	 * @param DefinitionClass The item definition class to resolve
+	 * @return The shared definition, or nullptr if the class is not valid
+	 */
+	UItemDefinition* GetDefinition(const TSubclassOf<UItemDefinition>& DefinitionClass) const;
+
+protected:
+	/** Cache shared by all the inventories of the process */
+	UPROPERTY(Transient)
+	TObjectPtr<UInventoryCache> Cache;
+};
@@ -0,0 +1,87 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "ItemInstancePool.generated.h"
+
+class UItemInstance;
+
+/** Instance released to the pool, waiting for its reuse delay to elapse */
+USTRUCT()
+struct FPooledItemInstance
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UItemInstance> Instance;
+
+	/** Time at which the instance can be handed out again */
+	double ReusableTime = 0.0;
+};
+
+/** Released instances of a single instance class, oldest first */
+USTRUCT()
+struct FItemInstancePoolBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FPooledItemInstance> Instances;
+};
+
+/**
+ * @class UItemInstancePool
+ * @see UWorldSubsystem, UItemInstance
+ * @brief Per-world pool recycling item instances and their item components
+ * @details Created only when bPoolItemInstances is enabled in the inventory settings. Released instances are
+ * uninitialized, moved under the pool and handed out again once PooledInstanceReuseDelay has elapsed, so that their
+ * destruction has reached the clients before they replicate again under a new owner. A released instance must not be
+ * referenced anymore by gameplay code.
+ */
+UCLASS()
+class INVENTORYSYSTEMCORE_API UItemInstancePool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// ~USubsystem
+
+	/**
+	 * Gets a new item instance owned by an actor, recycled from the pool of its world when enabled
+	 * @param OwnerActor The actor owning the instance, used as its outer
+	 * @param InstanceClass The class of the instance to create
+	 * @return An uninitialized item instance
+	 */
+	static UItemInstance* AcquireInstance(AActor* OwnerActor, TSubclassOf<UItemInstance> InstanceClass);
+
+	/**
+	 * Gives an item instance back to the pool of its world when enabled. Only an instance kept by the pool is
+	 * uninitialized, the others are left untouched to the garbage collector.
+	 * @param Instance The instance to release, already removed from its inventory and from replication
+	 */
+	static void ReleaseInstance(UItemInstance* Instance);
+
+	/**
+	 * Gets the number of released instances of a class kept by this pool
+	 * @param InstanceClass The instance class to count
+	 */
+	int32 GetPooledCount(TSubclassOf<UItemInstance> InstanceClass) const;
+
+protected:
+	// UWorldSubsystem
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// ~UWorldSubsystem
+
+	UItemInstance* Acquire(AActor* OwnerActor, TSubclassOf<UItemInstance> InstanceClass);
+	void Release(UItemInstance* Instance);
+
+	/** Released instances, per instance class */
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UClass>, FItemInstancePoolBucket> Buckets;
+};
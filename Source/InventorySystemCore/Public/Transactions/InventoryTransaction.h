@@ -0,0 +1,145 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Data/InventoryEntryHandle.h"
+#include "Data/InventoryList.h"
+#include "UObject/Object.h"
+#include "InventoryTransaction.generated.h"
+
+class UInventoryContainer;
+
+/**
+ * Lifecycle of an inventory transaction
+ */
+UENUM(BlueprintType)
+enum class EInventoryTransactionState : uint8
+{
+	Open, ///< Legs can be added, their source entries are locked
+	Committed, ///< Every leg has been applied
+	Cancelled ///< No leg has been applied, the locks have been released
+};
+
+/**
+ * @struct FInventoryTransactionLeg
+ * @see UInventoryTransaction
+ * @brief Items of a stack given to a container, possibly of another inventory component
+ */
+USTRUCT(BlueprintType)
+struct FInventoryTransactionLeg
+{
+	GENERATED_BODY()
+
+	/** The source stack, locked while the transaction is open */
+	UPROPERTY(BlueprintReadOnly, Category="Inventory|Transaction")
+	FInventoryEntryHandle Handle;
+
+	/** The container receiving the items */
+	UPROPERTY(BlueprintReadOnly, Category="Inventory|Transaction")
+	TObjectPtr<UInventoryContainer> TargetContainer = nullptr;
+
+	/** The number of items given, the whole stack keeping its item instance */
+	UPROPERTY(BlueprintReadOnly, Category="Inventory|Transaction")
+	int32 Count = 0;
+};
+
+/**
+ * @class UInventoryTransaction
+ * @see UInventorySystemComponent, FInventoryTransactionLeg
+ * @brief Escrow of items exchanged between inventory components, e.g. a trade or a vendor purchase, applied atomically
+ * @details Each leg locks its source entry until the transaction is committed or cancelled, so that the entry can be
+ * neither removed nor transferred meanwhile. Commit validates every leg against the content of the receiving containers
+ * before the first modification: a refused transaction leaves every inventory untouched, and the changes of each
+ * component are reported by a single OnInventoryBatchChanged event. Item instances given as a whole stack move under the
+ * receiving actor along with their replicated subobject registration.
+ * The additions of each receiving container are checked together against its uniqueness rules, capacity policies and
+ * grid layout, against the content before the transaction. Authority only.
+ */
+UCLASS(BlueprintType)
+class INVENTORYSYSTEMCORE_API UInventoryTransaction : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	// UObject
+	virtual void BeginDestroy() override;
+	// ~UObject
+
+	/**
+	 * Creates an open transaction
+	 * @param Outer The outer of the transaction, e.g. the vendor or the trade session
+	 * @return The new transaction
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Transaction", meta = (DefaultToSelf = "Outer"))
+	static UInventoryTransaction* BeginTransaction(UObject* Outer);
+
+	/**
+	 * Adds items of a stack to the transaction, locking the stack
+	 * @param Handle The handle of the source stack
+	 * @param TargetContainer The container receiving the items
+	 * @param Count The number of items to give, at most the count of the stack
+	 * @param OutFailureReason The reason of the refusal, if any
+	 * @return True if the leg has been added
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Transaction")
+	bool AddLeg(const FInventoryEntryHandle& Handle, UInventoryContainer* TargetContainer, int32 Count, FGameplayTag& OutFailureReason);
+
+	/**
+	 * Checks every leg against the current content of the containers, without modifying them
+	 * @param OutFailureReason The reason of the refusal, if any
+	 * @return True if the transaction can be committed
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Transaction")
+	bool Validate(FGameplayTag& OutFailureReason) const;
+
+	/**
+	 * Validates then applies every leg. The transaction stays open if refused, to be fixed or cancelled
+	 * Should a validated leg still not fit in its target, its items are given back to their source rather than lost: the
+	 * transaction is then committed with the other legs applied, and the failure is reported
+	 * @param OutFailureReason The reason of the refusal, if any
+	 * @return True if the transaction has been committed with every leg applied
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Transaction")
+	bool Commit(FGameplayTag& OutFailureReason);
+
+	/** Releases the locks of an open transaction without applying it */
+	UFUNCTION(BlueprintCallable, Category="Inventory|Transaction")
+	void Cancel();
+
+	UFUNCTION(BlueprintPure, Category="Inventory|Transaction")
+	EInventoryTransactionState GetState() const { return State; }
+
+	UFUNCTION(BlueprintPure, Category="Inventory|Transaction")
+	const TArray<FInventoryTransactionLeg>& GetLegs() const { return Legs; }
+
+protected:
+	/**
+	 * Resolves the source entry of a leg
+	 * @param Leg The leg
+	 * @return The entry, or nullptr if it has been removed since the leg was added
+	 */
+	const FInventoryEntry* FindSourceEntry(const FInventoryTransactionLeg& Leg) const;
+
+	/** Unlocks the source entries of the legs */
+	void ReleaseLocks();
+
+	/**
+	 * Adds the items of a leg to a container, moving the instance of a whole stack under the receiving actor
+	 * @param FromContainer The container the items come from, already removed from it
+	 * @param ToContainer The container receiving the items
+	 * @param DefinitionClass The definition of the items
+	 * @param Instance The instance of a whole stack, nullptr if the items are merged by definition
+	 * @param Count The number of items
+	 * @param OutResult Receives the created and modified instances, or the failure reason
+	 * @return The number of items added
+	 */
+	static int32 AddItems(UInventoryContainer* FromContainer, UInventoryContainer* ToContainer, const TSubclassOf<UItemDefinition>& DefinitionClass, UItemInstance* Instance, int32 Count, FInventoryResult& OutResult);
+
+	/** The items exchanged, in the order they were added */
+	UPROPERTY()
+	TArray<FInventoryTransactionLeg> Legs;
+
+	EInventoryTransactionState State = EInventoryTransactionState::Open;
+};
@@ -0,0 +1,332 @@
+﻿// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "InventorySystemCore/Public/Components/InventorySystemComponent.h"
+#include "InventorySystemCore/Public/Containers/InventoryContainer.h"
+#include "InventorySystemCore/Public/Instances/ItemInstance.h"
+#include "Engine/World.h"
+#include "Tests/AutomationEditorCommon.h"
+#include "Tests/Definitions/TestItemDefinition.h"
+#include "Tests/Definitions/TestItemDefinition_Unique.h"
+
+#include <atomic>
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Benchmarks of the inventory hot paths, reporting the time and the allocations per operation.
+ * Run headless with: UnrealEditor-Cmd <Project> -nullrhi -unattended -ExecCmds="Automation RunTests InventorySystem.Benchmark; Quit"
+ * Results are written as CSV to -InventoryBenchmarkCsv=<Path>, Saved/Automation/InventorySystemBenchmarks.csv by default.
+ * Thresholds are read from the [InventorySystem.Benchmarks] section of the engine config, a benchmark exceeding them
+ * fails the test. ThresholdScale multiplies every time threshold, for slower machines.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_BenchmarkTest, "InventorySystem.Benchmark.HotPaths",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace InventoryBenchmarks
+{
+	static const TCHAR* ConfigSection = TEXT("InventorySystem.Benchmarks");
+
+	/**
+	 * @class FAllocationCounter
+	 * @brief Counts the allocations made by the benchmarking thread between Begin and End
+	 * @details Installed over GMalloc on the first measure and never removed, since other threads may still call it
+	 * through a GMalloc they read earlier. Every call is forwarded to the allocator it replaced, which stays valid for
+	 * the whole process. Allocations of other threads are not counted.
+	 */
+	class FAllocationCounter final : public FMalloc
+	{
+	public:
+		void Begin()
+		{
+			check(IsInGameThread() && !bCounting);
+			if (!Inner)
+			{
+				Inner = GMalloc;
+				GMalloc = this;
+			}
+			ThreadId = FPlatformTLS::GetCurrentThreadId();
+			NumAllocations = 0;
+			bCounting.store(true);
+		}
+
+		uint64 End()
+		{
+			check(bCounting);
+			bCounting.store(false);
+			return NumAllocations;
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				CountAllocation();
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				CountAllocation();
+			}
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	private:
+		void CountAllocation()
+		{
+			if (bCounting.load(std::memory_order_relaxed) && FPlatformTLS::GetCurrentThreadId() == ThreadId)
+			{
+				++NumAllocations;
+			}
+		}
+
+		/** The replaced allocator, set once installed */
+		FMalloc* Inner = nullptr;
+
+		/** Whether a measure is running, read by every allocating thread */
+		std::atomic<bool> bCounting = false;
+
+		uint32 ThreadId = 0;
+
+		uint64 NumAllocations = 0;
+	};
+
+	/**
+	 * @class FBenchmarkRunner
+	 * @brief Measures benchmarks, checks them against the configured thresholds and writes their results as CSV
+	 */
+	class FBenchmarkRunner
+	{
+	public:
+		explicit FBenchmarkRunner(FAutomationTestBase& InTest)
+			: Test(InTest)
+		{
+			GConfig->GetDouble(ConfigSection, TEXT("ThresholdScale"), ThresholdScale, GEngineIni);
+			Csv = TEXT("Benchmark,Operations,NsPerOp,AllocationsPerOp,MaxNsPerOp,MaxAllocationsPerOp,Passed\n");
+		}
+
+		/**
+		 * Measures a benchmark, its setup being done by the caller beforehand
+		 * @param Name The benchmark name, also the prefix of its threshold keys: <Name>.MaxNsPerOp and <Name>.MaxAllocationsPerOp
+		 * @param NumOps Number of operations performed by Body
+		 * @param Body Performs every operation of the benchmark
+		 */
+		void Measure(const FString& Name, const int32 NumOps, const TFunctionRef<void()> Body)
+		{
+			// Never destroyed, GMalloc keeps pointing at it until the process exits
+			static FAllocationCounter& AllocationCounter = *new FAllocationCounter();
+
+			AllocationCounter.Begin();
+			const double StartTime = FPlatformTime::Seconds();
+			Body();
+			const double EndTime = FPlatformTime::Seconds();
+			const uint64 NumAllocations = AllocationCounter.End();
+
+			const double NsPerOp = (EndTime - StartTime) * 1e9 / FMath::Max(NumOps, 1);
+			const double AllocationsPerOp = static_cast<double>(NumAllocations) / FMath::Max(NumOps, 1);
+
+			// Missing thresholds are reported as zero and not checked
+			double MaxNsPerOp = 0.0;
+			double MaxAllocationsPerOp = 0.0;
+			const bool bHasTimeThreshold = GConfig->GetDouble(ConfigSection, *(Name + TEXT(".MaxNsPerOp")), MaxNsPerOp, GEngineIni);
+			const bool bHasAllocationThreshold = GConfig->GetDouble(ConfigSection, *(Name + TEXT(".MaxAllocationsPerOp")), MaxAllocationsPerOp, GEngineIni);
+			MaxNsPerOp *= ThresholdScale;
+
+			bool bPassed = true;
+			if (bHasTimeThreshold && NsPerOp > MaxNsPerOp)
+			{
+				Test.AddError(FString::Printf(TEXT("%s: %.1f ns/op exceeds the threshold of %.1f ns/op"), *Name, NsPerOp, MaxNsPerOp));
+				bPassed = false;
+			}
+			if (bHasAllocationThreshold && AllocationsPerOp > MaxAllocationsPerOp)
+			{
+				Test.AddError(FString::Printf(TEXT("%s: %.2f allocations/op exceeds the threshold of %.2f allocations/op"), *Name, AllocationsPerOp, MaxAllocationsPerOp));
+				bPassed = false;
+			}
+
+			Test.AddInfo(FString::Printf(TEXT("%s: %d ops, %.1f ns/op, %.2f allocations/op"), *Name, NumOps, NsPerOp, AllocationsPerOp));
+			Csv += FString::Printf(TEXT("%s,%d,%.1f,%.3f,%.1f,%.3f,%s\n"), *Name, NumOps, NsPerOp, AllocationsPerOp, MaxNsPerOp, MaxAllocationsPerOp, bPassed ? TEXT("true") : TEXT("false"));
+		}
+
+		/** Writes the results of every measured benchmark */
+		void WriteCsv() const
+		{
+			FString Path = FPaths::Combine(FPaths::AutomationDir(), TEXT("InventorySystemBenchmarks.csv"));
+			FParse::Value(FCommandLine::Get(), TEXT("InventoryBenchmarkCsv="), Path);
+			if (!FFileHelper::SaveStringToFile(Csv, *Path))
+			{
+				Test.AddError(FString::Printf(TEXT("Benchmark results could not be written to %s"), *Path));
+				return;
+			}
+			Test.AddInfo(FString::Printf(TEXT("Benchmark results written to %s"), *Path));
+		}
+
+	private:
+		FAutomationTestBase& Test;
+
+		double ThresholdScale = 1.0;
+
+		FString Csv;
+	};
+
+	static UInventorySystemComponent* CreateInventory(UWorld* World)
+	{
+		AActor* TestActor = World->SpawnActor<AActor>();
+		auto* Inventory = NewObject<UInventorySystemComponent>(TestActor);
+		TestActor->AddOwnedComponent(Inventory);
+		Inventory->RegisterComponent();
+		Inventory->InitializeComponent();
+		Inventory->RegisterContainer(InventorySystemGameplayTags::TAG_Inventory_Container_Bag, NewObject<UInventoryContainer>(Inventory));
+		return Inventory;
+	}
+
+	/** Adds unique items one at a time, each one getting its own entry */
+	static void FillUnique(UInventorySystemComponent* Inventory, const int32 NumEntries)
+	{
+		const FGameplayTag DefaultTag = InventorySystemGameplayTags::TAG_Inventory_Container_Default;
+		for (int32 Index = 0; Index < NumEntries; ++Index)
+		{
+			Inventory->TryAddItemDefinitionIn(DefaultTag, UTestItemDefinition_Unique::StaticClass(), 1);
+		}
+	}
+}
+
+bool FInventory_BenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace InventoryBenchmarks;
+
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	FBenchmarkRunner Runner(*this);
+
+	const FGameplayTag DefaultTag = InventorySystemGameplayTags::TAG_Inventory_Container_Default;
+	const FGameplayTag BagTag = InventorySystemGameplayTags::TAG_Inventory_Container_Bag;
+	const TSubclassOf<UTestItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+	const TSubclassOf<UTestItemDefinition_Unique> UniqueItemDef = UTestItemDefinition_Unique::StaticClass();
+
+	// Single items topping up and opening stacks of 10
+	constexpr int32 NumStackableAdds = 10000;
+	UInventorySystemComponent* StackableInventory = CreateInventory(World);
+	Runner.Measure(TEXT("Add.Stackable"), NumStackableAdds, [&]()
+	{
+		for (int32 Index = 0; Index < NumStackableAdds; ++Index)
+		{
+			StackableInventory->TryAddItemDefinitionIn(DefaultTag, TestItemDef, 1);
+		}
+	});
+	TestEqual(TEXT("Stackable items should be added"), StackableInventory->GetTotalCountByDefinition(TestItemDef), NumStackableAdds);
+
+	UInventorySystemComponent* SmallInventory = CreateInventory(World);
+	Runner.Measure(TEXT("Fill.1k"), 1000, [&]() { FillUnique(SmallInventory, 1000); });
+	TestEqual(TEXT("Container should hold 1k entries"), SmallInventory->GetAllStacks().Num(), 1000);
+
+	constexpr int32 NumEntries = 10000;
+	UInventorySystemComponent* Inventory = CreateInventory(World);
+	Runner.Measure(TEXT("Fill.10k"), NumEntries, [&]() { FillUnique(Inventory, NumEntries); });
+	TestEqual(TEXT("Container should hold 10k entries"), Inventory->GetAllStacks().Num(), NumEntries);
+
+	// Queries over 10k entries
+	constexpr int32 NumQueries = 1000;
+	int64 Sink = 0;
+	Runner.Measure(TEXT("Query.DefinitionCount"), NumQueries, [&]()
+	{
+		for (int32 Index = 0; Index < NumQueries; ++Index)
+		{
+			Sink += Inventory->GetTotalCountByDefinition(UniqueItemDef) + Inventory->GetStackCountByDefinitionIn(UniqueItemDef, DefaultTag);
+		}
+	});
+	TestEqual(TEXT("Definition counts should be returned"), Sink, static_cast<int64>(NumQueries) * NumEntries * 2);
+
+	constexpr int32 NumGetAllStacks = 100;
+	Sink = 0;
+	Runner.Measure(TEXT("Query.GetAllStacks"), NumGetAllStacks, [&]()
+	{
+		for (int32 Index = 0; Index < NumGetAllStacks; ++Index)
+		{
+			Sink += Inventory->GetAllStacks().Num();
+		}
+	});
+	TestEqual(TEXT("Every stack should be returned"), Sink, static_cast<int64>(NumGetAllStacks) * NumEntries);
+
+	TArray<UItemInstance*> Instances;
+	for (const FInventoryEntryHandle& Handle : Inventory->GetAllStacks())
+	{
+		Instances.Add(Handle.ItemInstance);
+	}
+	int32 NumFound = 0;
+	Runner.Measure(TEXT("Lookup.Handle"), Instances.Num(), [&]()
+	{
+		for (UItemInstance* Instance : Instances)
+		{
+			NumFound += Inventory->FindHandleFromInstance(Instance).IsHandleValid() ? 1 : 0;
+		}
+	});
+	TestEqual(TEXT("Every instance should be found"), NumFound, Instances.Num());
+
+	// Entries taken from the middle, the handles staying valid while other entries are removed
+	constexpr int32 NumChanges = 1000;
+	const TArray<FInventoryEntryHandle> Handles = Inventory->GetAllStacks();
+	const int32 MiddleIndex = Handles.Num() / 2;
+	int32 NumMoved = 0;
+	Runner.Measure(TEXT("Move.CrossContainer"), NumChanges, [&]()
+	{
+		for (int32 Index = 0; Index < NumChanges; ++Index)
+		{
+			NumMoved += Inventory->TryMoveByHandle(Handles[MiddleIndex - NumChanges + Index], Inventory->GetContainer(BagTag)).Succeeded() ? 1 : 0;
+		}
+	});
+	TestEqual(TEXT("Entries should be moved"), NumMoved, NumChanges);
+
+	int32 NumRemoved = 0;
+	Runner.Measure(TEXT("Remove.Middle"), NumChanges, [&]()
+	{
+		FGameplayTag FailureReason;
+		for (int32 Index = 0; Index < NumChanges; ++Index)
+		{
+			NumRemoved += Inventory->TryDestroyFromHandle(Handles[MiddleIndex + Index], FailureReason) ? 1 : 0;
+		}
+	});
+	TestEqual(TEXT("Entries should be removed"), NumRemoved, NumChanges);
+
+	Runner.WriteCsv();
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+#endif
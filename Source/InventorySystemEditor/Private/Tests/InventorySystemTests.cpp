@@ -4,13 +4,28 @@
 #include "Misc/AutomationTest.h"
 #include "InventorySystemCore/Public/Components/InventorySystemComponent.h"
 #include "InventorySystemCore/Public/Containers/InventoryContainer.h"
+#include "InventorySystemCore/Public/Containers/InventoryContainer_Grid.h"
+#include "InventorySystemCore/Public/Containers/Policies/StoragePolicy_Capacity.h"
+#include "InventorySystemCore/Public/Containers/Policies/StoragePolicy_TagRequirement.h"
 #include "InventorySystemCore/Public/Instances/ItemInstance.h"
+#include "InventorySystemCore/Public/Data/DefinitionNetIdTable.h"
 #include "InventorySystemCore/Public/Definitions/ItemDefinition.h"
 #include "InventorySystemCore/Public/Data/InventorySet.h"
+#include "InventorySystemCore/Public/Data/InventoryJournal.h"
+#include "InventorySystemCore/Public/Data/InventoryPrediction.h"
+#include "InventorySystemCore/Public/Data/InventorySnapshot.h"
+#include "InventorySystemCore/Public/Settings/InventorySystemSettings.h"
+#include "InventorySystemCore/Public/Subsystems/ItemInstancePool.h"
+#include "InventorySystemCore/Public/Transactions/InventoryTransaction.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Engine/Engine.h"
 #include "Engine/World.h"
 #include "Tests/AutomationEditorCommon.h"
+#include "TimerManager.h"
 #include "Tests/Definitions/TestItemDefinition.h"
+#include "Tests/Definitions/TestItemDefinition_Commodity.h"
 #include "Tests/Definitions/TestItemDefinition_Unique.h"
+#include "Tests/TestInventoryChangeListener.h"
 
 
 #if WITH_DEV_AUTOMATION_TESTS
@@ -24,12 +39,80 @@ IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_AddInvalidItemTest, "InventorySystem
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_MoveItemBetweenContainersTest, "InventorySystem.Move.BetweenContainers",
                                  EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_TransferItemsTest, "InventorySystem.Move.Transfer",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_TransactionTest, "InventorySystem.Move.Transaction",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_DefinitionNetIdTest, "InventorySystem.Replication.DefinitionNetId",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_HandleValidationTest, "InventorySystem.Handle.IsValid",
                                  EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
 
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_SetInjectionTest, "InventorySystem.Set.ApplyDefaultInventorySet",
                                  EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_HandleStabilityTest, "InventorySystem.Handle.Stability",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_AddBatchTest, "InventorySystem.Add.Batch",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_ChangeCoalescingTest, "InventorySystem.Events.Coalescing",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_InstancePoolTest, "InventorySystem.Pool.Reuse",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_DefinitionQueriesTest, "InventorySystem.Query.DefinitionCounts",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_ContainerAggregatesTest, "InventorySystem.Container.Aggregates",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_ContainerViewTest, "InventorySystem.Container.View",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_CompiledPolicyTest, "InventorySystem.Container.CompiledPolicy",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_ContainerReplicationRuleTest, "InventorySystem.Container.ReplicationRule",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_GridContainerTest, "InventorySystem.Container.Grid",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_PredictionTest, "InventorySystem.Prediction.Overlay",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_SnapshotTest, "InventorySystem.Persistence.Snapshot",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_CommodityTest, "InventorySystem.Add.Commodity",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_JournalTest, "InventorySystem.Persistence.Journal",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventory_AsyncSnapshotTest, "InventorySystem.Persistence.AsyncLoad",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+namespace InventorySystemTests
+{
+	/** Spawns an actor owning an initialized inventory component, holding its default container */
+	static UInventorySystemComponent* CreateInventory(UWorld* World)
+	{
+		AActor* TestActor = World->SpawnActor<AActor>();
+		UInventorySystemComponent* InventoryComponent = NewObject<UInventorySystemComponent>(TestActor);
+		TestActor->AddOwnedComponent(InventoryComponent);
+		InventoryComponent->RegisterComponent();
+		InventoryComponent->InitializeComponent();
+		return InventoryComponent;
+	}
+}
+
 bool FInventory_AddValidItemTest::RunTest(const FString& Parameters)
 {
 	// Create test world
@@ -254,6 +337,224 @@ bool FInventory_MoveItemBetweenContainersTest::RunTest(const FString& Parameters
 	return true;
 }
 
+bool FInventory_TransferItemsTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	const FGameplayTag ContainerTagA = InventorySystemGameplayTags::TAG_Inventory_Container_Default;
+	const FGameplayTag ContainerTagB = InventorySystemGameplayTags::TAG_Inventory_Container_Bag;
+
+	UInventoryContainer* ContainerA = NewObject<UInventoryContainer>(InventoryComponent);
+	UInventoryContainer* ContainerB = NewObject<UInventoryContainer>(InventoryComponent);
+	InventoryComponent->RegisterContainer(ContainerTagA, ContainerA);
+	InventoryComponent->RegisterContainer(ContainerTagB, ContainerB);
+
+	// A holds stacks of 10 and 5, B a stack of 8
+	const TSubclassOf<UTestItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+	InventoryComponent->TryAddItemDefinitionIn(ContainerTagA, TestItemDef, 15);
+	InventoryComponent->TryAddItemDefinitionIn(ContainerTagB, TestItemDef, 8);
+	const TArray<FInventoryEntryHandle> HandlesA = ContainerA->GetInventoryList().GetAllHandles();
+
+	// 2 items top up the stack of B, 5 are split into a new stack
+	const FInventoryEntryHandle FullStack = HandlesA[0].StackCount == 10 ? HandlesA[0] : HandlesA[1];
+	const FInventoryEntryHandle PartialStack = HandlesA[0].StackCount == 10 ? HandlesA[1] : HandlesA[0];
+	TestTrue(TEXT("Partial transfer should succeed"), InventoryComponent->TryTransferItems(FullStack, ContainerB, 7).Succeeded());
+	TestEqual(TEXT("Source stack should be split"), ContainerA->GetTotalCountByDefinition(TestItemDef), 8);
+	TestEqual(TEXT("Target should receive the items"), ContainerB->GetTotalCountByDefinition(TestItemDef), 15);
+	TestEqual(TEXT("Target stacks should be merged first"), ContainerB->GetStackCountByDefinition(TestItemDef), 2);
+
+	// The whole stack fits in the room left in the target stacks
+	TestTrue(TEXT("Whole stack transfer should succeed"), InventoryComponent->TryTransferItems(PartialStack, ContainerB, 5).Succeeded());
+	TestTrue(TEXT("Source stack should be removed"), ContainerA->IsHandleStale(PartialStack));
+	TestEqual(TEXT("Whole stack should be merged"), ContainerB->GetStackCountByDefinition(TestItemDef), 2);
+
+	// Refused transfers leave both containers untouched
+	const FInventoryResult Refused = InventoryComponent->TryTransferItems(FullStack, ContainerB, 4);
+	TestTrue(TEXT("Transfer above the stack count should be refused"), Refused.FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidCount);
+	TestEqual(TEXT("Source should be untouched"), ContainerA->GetTotalCountByDefinition(TestItemDef), 3);
+	TestEqual(TEXT("Target should be untouched"), ContainerB->GetTotalCountByDefinition(TestItemDef), 20);
+
+	// The target refuses a second unique item, which stays in the source
+	const TSubclassOf<UTestItemDefinition> UniqueItemDef = UTestItemDefinition_Unique::StaticClass();
+	UItemInstance* UniqueInstance = InventoryComponent->TryAddItemDefinitionIn(ContainerTagA, UniqueItemDef, 1).Instances[0];
+	InventoryComponent->TryAddItemDefinitionIn(ContainerTagB, UniqueItemDef, 1);
+	const FInventoryResult RefusedUnique = InventoryComponent->TryTransferItems(ContainerA->FindHandle(UniqueInstance), ContainerB, 1);
+	TestTrue(TEXT("Second unique item should be refused"), RefusedUnique.FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_Uniqueness);
+	TestTrue(TEXT("Refused unique item should stay in the source"), ContainerA->FindHandle(UniqueInstance).IsHandleValid());
+	TestEqual(TEXT("Target should keep a single unique item"), ContainerB->GetTotalCountByDefinition(UniqueItemDef), 1);
+
+	// The target refuses the new stacks above its capacity, the source keeps its items
+	UStoragePolicy_Capacity* Capacity = NewObject<UStoragePolicy_Capacity>(ContainerB);
+	Capacity->MaxStacks = ContainerB->GetInventoryList().GetAllHandles().Num();
+	ContainerB->AddStoragePolicy(Capacity);
+	const FInventoryResult RefusedCapacity = InventoryComponent->TryTransferItems(FullStack, ContainerB, 3);
+	TestFalse(TEXT("Transfer above the capacity should be refused"), RefusedCapacity.Succeeded());
+	TestEqual(TEXT("Source should keep the refused items"), ContainerA->GetTotalCountByDefinition(TestItemDef), 3);
+	TestEqual(TEXT("Target should not receive the refused items"), ContainerB->GetTotalCountByDefinition(TestItemDef), 20);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_TransactionTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+
+	// Two traders, each with its default container
+	UInventorySystemComponent* InventoryComponents[2];
+	for (UInventorySystemComponent*& InventoryComponent : InventoryComponents)
+	{
+		InventoryComponent = InventorySystemTests::CreateInventory(World);
+	}
+	UInventoryContainer* ContainerA = InventoryComponents[0]->GetContainer(InventorySystemGameplayTags::TAG_Inventory_Container_Default);
+	UInventoryContainer* ContainerB = InventoryComponents[1]->GetContainer(InventorySystemGameplayTags::TAG_Inventory_Container_Default);
+
+	// A gives its unique item and 4 of its 10 items, B gives 3 of its items
+	const TSubclassOf<UTestItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+	const TSubclassOf<UTestItemDefinition> UniqueItemDef = UTestItemDefinition_Unique::StaticClass();
+	UItemInstance* UniqueInstance = InventoryComponents[0]->TryAddItemDefinition(UniqueItemDef, 1).Instances[0];
+	InventoryComponents[0]->TryAddItemDefinition(TestItemDef, 10);
+	InventoryComponents[1]->TryAddItemDefinition(TestItemDef, 5);
+
+	FInventoryEntryHandle UniqueHandle, StackHandleA;
+	for (const FInventoryEntryHandle& Handle : ContainerA->GetInventoryList().GetAllHandles())
+	{
+		(Handle.ItemInstance == UniqueInstance ? UniqueHandle : StackHandleA) = Handle;
+	}
+	const FInventoryEntryHandle StackHandleB = ContainerB->GetInventoryList().GetAllHandles()[0];
+
+	UInventoryTransaction* Transaction = UInventoryTransaction::BeginTransaction(World);
+	FGameplayTag FailureReason;
+	TestTrue(TEXT("Unique item leg should be added"), Transaction->AddLeg(UniqueHandle, ContainerB, 1, FailureReason));
+	TestTrue(TEXT("Partial stack leg should be added"), Transaction->AddLeg(StackHandleA, ContainerB, 4, FailureReason));
+	TestTrue(TEXT("Counter leg should be added"), Transaction->AddLeg(StackHandleB, ContainerA, 3, FailureReason));
+
+	// Locked entries can be neither removed nor traded twice
+	TestFalse(TEXT("Locked entry should not be removable"), InventoryComponents[0]->TryRemoveFromHandle(UniqueHandle, FailureReason));
+	TestTrue(TEXT("Removal should report the lock"), FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_Locked);
+	TestFalse(TEXT("Locked entry should not be added twice"), Transaction->AddLeg(UniqueHandle, ContainerB, 1, FailureReason));
+	TestTrue(TEXT("Second leg should report the lock"), FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_Locked);
+
+	TestTrue(TEXT("Transaction should commit"), Transaction->Commit(FailureReason));
+	TestTrue(TEXT("Transaction should be committed"), Transaction->GetState() == EInventoryTransactionState::Committed);
+	TestEqual(TEXT("A should keep 6 items and receive 3"), ContainerA->GetTotalCountByDefinition(TestItemDef), 9);
+	TestEqual(TEXT("B should keep 2 items and receive 4"), ContainerB->GetTotalCountByDefinition(TestItemDef), 6);
+	TestEqual(TEXT("A should have given its unique item"), ContainerA->GetTotalCountByDefinition(UniqueItemDef), 0);
+	TestEqual(TEXT("B should have received the unique item"), ContainerB->GetTotalCountByDefinition(UniqueItemDef), 1);
+	TestTrue(TEXT("Unique instance should be owned by B"), UniqueInstance->GetTypedOuter<AActor>() == InventoryComponents[1]->GetOwner());
+	TestTrue(TEXT("Unlocked entries should be removable again"), InventoryComponents[0]->TryRemoveFromHandle(ContainerA->GetInventoryList().GetAllHandles()[0], FailureReason));
+
+	// Cancelling releases the locks without any change
+	UInventoryTransaction* Cancelled = UInventoryTransaction::BeginTransaction(World);
+	const FInventoryEntryHandle ReceivedHandle = ContainerB->GetInventoryList().GetAllHandles()[0];
+	TestTrue(TEXT("Leg should be added"), Cancelled->AddLeg(ReceivedHandle, ContainerA, 1, FailureReason));
+	Cancelled->Cancel();
+	TestFalse(TEXT("Cancelled transaction should not commit"), Cancelled->Commit(FailureReason));
+	TestFalse(TEXT("Cancelled leg should be unlocked"), ContainerB->GetInventoryList().IsEntryLocked(ReceivedHandle.EntryId));
+
+	// The legs received by a container are validated together: two unique items, or stacks overfilling it together
+	const FGameplayTag BagTag = InventorySystemGameplayTags::TAG_Inventory_Container_Bag;
+	UInventoryContainer* BagA = NewObject<UInventoryContainer>(InventoryComponents[0]);
+	UInventoryContainer* BagB = NewObject<UInventoryContainer>(InventoryComponents[1]);
+	InventoryComponents[0]->RegisterContainer(BagTag, BagA);
+	InventoryComponents[1]->RegisterContainer(BagTag, BagB);
+	UStoragePolicy_Capacity* Capacity = NewObject<UStoragePolicy_Capacity>(BagB);
+	Capacity->MaxStacks = 1;
+	BagB->AddStoragePolicy(Capacity);
+
+	UItemInstance* FirstUnique = InventoryComponents[0]->TryAddItemDefinition(UniqueItemDef, 1).Instances[0];
+	UItemInstance* SecondUnique = InventoryComponents[0]->TryAddItemDefinitionIn(BagTag, UniqueItemDef, 1).Instances[0];
+	InventoryComponents[0]->TryAddItemDefinitionIn(BagTag, TestItemDef, 4);
+	const FInventoryEntryHandle FirstHandle = ContainerA->FindHandle(FirstUnique);
+	const FInventoryEntryHandle SecondHandle = BagA->FindHandle(SecondUnique);
+	const FInventoryEntryHandle BagStack = BagA->GetInventoryList().GetHandlesOfType(TestItemDef)[0];
+
+	UInventoryTransaction* Duplicated = UInventoryTransaction::BeginTransaction(World);
+	Duplicated->AddLeg(FirstHandle, BagB, 1, FailureReason);
+	Duplicated->AddLeg(SecondHandle, BagB, 1, FailureReason);
+	TestFalse(TEXT("Two unique items to the same container should be refused"), Duplicated->Commit(FailureReason));
+	TestTrue(TEXT("Refusal should report the uniqueness"), FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_Uniqueness);
+	Duplicated->Cancel();
+
+	UInventoryTransaction* Overfilled = UInventoryTransaction::BeginTransaction(World);
+	Overfilled->AddLeg(FirstHandle, BagB, 1, FailureReason);
+	Overfilled->AddLeg(BagStack, BagB, 4, FailureReason);
+	TestFalse(TEXT("Stacks overfilling the container together should be refused"), Overfilled->Commit(FailureReason));
+	TestTrue(TEXT("Refusal should report the capacity"), FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_Capacity);
+	TestEqual(TEXT("Refused transaction should leave the giver untouched"), BagA->GetTotalCountByDefinition(TestItemDef), 4);
+	TestEqual(TEXT("Refused transaction should leave the receiver untouched"), BagB->GetInventoryList().GetAllHandles().Num(), 0);
+	Overfilled->Cancel();
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_ContainerReplicationRuleTest::RunTest(const FString& Parameters)
+{
+	// Every container is owner only, except the bags visible to the team
+	UInventorySystemSettings* Settings = GetMutableDefault<UInventorySystemSettings>();
+	const TMap<FGameplayTag, FInventoryReplicationRule> SavedRules = Settings->ContainerReplicationRules;
+	FInventoryReplicationRule OwnerOnlyRule;
+	OwnerOnlyRule.Condition = COND_OwnerOnly;
+	FInventoryReplicationRule TeamRule;
+	TeamRule.Condition = COND_NetGroup;
+	TeamRule.NetGroup = TEXT("Team");
+	Settings->ContainerReplicationRules = {{InventorySystemGameplayTags::TAG_Inventory_Container, OwnerOnlyRule}, {InventorySystemGameplayTags::TAG_Inventory_Container_Bag, TeamRule}};
+
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	UInventoryContainer* DefaultContainer = NewObject<UInventoryContainer>(InventoryComponent);
+	UInventoryContainer* BagContainer = NewObject<UInventoryContainer>(InventoryComponent);
+	InventoryComponent->RegisterContainer(InventorySystemGameplayTags::TAG_Inventory_Container_Default, DefaultContainer);
+	InventoryComponent->RegisterContainer(InventorySystemGameplayTags::TAG_Inventory_Container_Bag, BagContainer);
+
+	TestTrue(TEXT("Default container should inherit the rule of its parent tag"), DefaultContainer->GetReplicationRule() == OwnerOnlyRule);
+	TestTrue(TEXT("Bag container should use its own rule"), BagContainer->GetReplicationRule() == TeamRule);
+
+	// Without any rule, containers replicate to every relevant connection
+	Settings->ContainerReplicationRules.Reset();
+	TestTrue(TEXT("Unruled container should be public"), InventoryComponent->GetContainerReplicationRule(InventorySystemGameplayTags::TAG_Inventory_Container_Bag).Condition == COND_None);
+
+	// Cleaning
+	Settings->ContainerReplicationRules = SavedRules;
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_DefinitionNetIdTest::RunTest(const FString& Parameters)
+{
+	const FDefinitionNetIdTable& Table = FDefinitionNetIdTable::Get(UItemDefinition::StaticClass());
+	const int32 NetId = Table.GetNetId(UTestItemDefinition::StaticClass());
+	TestTrue(TEXT("Native definitions should have a net id"), NetId != INDEX_NONE);
+	TestTrue(TEXT("Net id should resolve to its class"), Table.ResolveNetId(NetId) == UTestItemDefinition::StaticClass());
+	TestTrue(TEXT("Subclasses should have their own net id"), Table.GetNetId(UTestItemDefinition_Unique::StaticClass()) != NetId);
+	TestEqual(TEXT("Network version hash should be stable"), FDefinitionNetIdTable::GetCombinedHash(), FDefinitionNetIdTable::GetCombinedHash());
+
+	// Listed classes are sent without the package map
+	FItemInstanceHeader Header;
+	Header.DefinitionClass = UTestItemDefinition::StaticClass();
+	FNetBitWriter Writer(nullptr, 64);
+	bool bSuccess = false;
+	Header.NetSerialize(Writer, nullptr, bSuccess);
+	TestTrue(TEXT("Header should be written"), bSuccess);
+	TestTrue(TEXT("Header should fit in a few bytes"), Writer.GetNumBits() <= 24);
+
+	FItemInstanceHeader ReceivedHeader;
+	FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+	ReceivedHeader.NetSerialize(Reader, nullptr, bSuccess);
+	TestTrue(TEXT("Header should be read"), bSuccess);
+	TestTrue(TEXT("Received definition should match"), ReceivedHeader == Header);
+
+	return true;
+}
+
 bool FInventory_HandleValidationTest::RunTest(const FString& Parameters)
 {
 	const FInventoryEntryHandle InvalidHandle;
@@ -285,4 +586,769 @@ bool FInventory_SetInjectionTest::RunTest(const FString& Parameters)
 	return true;
 }
 
+bool FInventory_HandleStabilityTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	// 3 stacks (10, 10, 5) of the stackable item
+	InventoryComponent->TryAddItemDefinition(UTestItemDefinition::StaticClass(), 25);
+	const TArray<FInventoryEntryHandle> Stacks = InventoryComponent->GetAllStacks();
+	TestEqual(TEXT("Three stacks should be created"), Stacks.Num(), 3);
+
+	// Removing the first stack swaps the last one into its place
+	FGameplayTag FailureReason;
+	TestTrue(TEXT("First stack should be removed"), InventoryComponent->TryRemoveFromHandle(Stacks[0], FailureReason));
+	TestTrue(TEXT("Removed stack handle should be stale"), Stacks[0].Container->IsHandleStale(Stacks[0]));
+	TestFalse(TEXT("Other handles should survive the removal"), Stacks[2].Container->IsHandleStale(Stacks[2]));
+
+	// The released slot is reused by the next stack, the old handle must not resolve to it
+	InventoryComponent->TryAddItemDefinition(UTestItemDefinition::StaticClass(), 10);
+	TestTrue(TEXT("Reused slot should not revive stale handles"), Stacks[0].Container->IsHandleStale(Stacks[0]));
+	TestFalse(TEXT("Stale handles should not be removed"), InventoryComponent->TryRemoveFromHandle(Stacks[0], FailureReason));
+
+	TestTrue(TEXT("Moved stack should be removed from its original handle"), InventoryComponent->TryRemoveFromHandle(Stacks[2], FailureReason));
+	TestEqual(TEXT("Remaining items should be counted"), InventoryComponent->GetTotalCountByDefinition(UTestItemDefinition::StaticClass()), 15);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_AddBatchTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	const TSubclassOf<UItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+
+	TArray<FInventoryAddRequest> Requests;
+	Requests.Emplace(TestItemDef, 15);
+	Requests.Emplace(nullptr, 1);
+	Requests.Emplace(UTestItemDefinition_Unique::StaticClass(), 1);
+	Requests.Emplace(TestItemDef, 5);
+
+	const FInventoryBatchResult BatchResult = InventoryComponent->TryAddItemDefinitions(Requests);
+	TestEqual(TEXT("One result per request"), BatchResult.Results.Num(), Requests.Num());
+	TestFalse(TEXT("Batch with an invalid request should not fully succeed"), BatchResult.Succeeded());
+	TestTrue(TEXT("Valid requests should succeed"), BatchResult.Results[0].Succeeded() && BatchResult.Results[2].Succeeded() && BatchResult.Results[3].Succeeded());
+	TestTrue(TEXT("Invalid request should report its failure"), BatchResult.Results[1].FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_InvalidDefinition);
+
+	// Requests of the same definition share the stacks
+	TestEqual(TEXT("Batched items should be stacked"), InventoryComponent->GetStackCountByDefinition(TestItemDef), 2);
+	TestEqual(TEXT("Batched items should be counted"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), 20);
+
+	// Requests fitting one by one but not together are all refused, before any is applied
+	UInventoryContainer* Bag = NewObject<UInventoryContainer>(InventoryComponent);
+	InventoryComponent->RegisterContainer(InventorySystemGameplayTags::TAG_Inventory_Container_Bag, Bag);
+	UStoragePolicy_Capacity* Capacity = NewObject<UStoragePolicy_Capacity>(Bag);
+	Capacity->MaxStacks = 3;
+	Bag->AddStoragePolicy(Capacity);
+
+	TArray<FInventoryAddRequest> BagRequests;
+	BagRequests.Emplace(TestItemDef, 20);
+	BagRequests.Emplace(TestItemDef, 15);
+	const FInventoryBatchResult Overfilled = Bag->TryAddItemDefinitions(BagRequests);
+	TestTrue(TEXT("Requests overfilling the container together should be refused"),
+		Overfilled.Results[0].FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_Capacity && Overfilled.Results[1].FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_Capacity);
+	TestEqual(TEXT("Refused batch should leave the container untouched"), Bag->GetTotalCountByDefinition(TestItemDef), 0);
+
+	// Unique items are checked against every stack of the batch
+	BagRequests.Reset();
+	BagRequests.Emplace(UTestItemDefinition_Unique::StaticClass(), 1);
+	BagRequests.Emplace(UTestItemDefinition_Unique::StaticClass(), 1);
+	BagRequests.Emplace(TestItemDef, 5);
+	const FInventoryBatchResult Duplicated = Bag->TryAddItemDefinitions(BagRequests);
+	TestTrue(TEXT("Duplicated unique items should be refused"), Duplicated.Results[1].FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_Uniqueness);
+	TestTrue(TEXT("Other requests should still be added"), Duplicated.Results[2].Succeeded());
+	TestEqual(TEXT("No unique item should be added"), Bag->GetTotalCountByDefinition(UTestItemDefinition_Unique::StaticClass()), 0);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_ChangeCoalescingTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	UTestInventoryChangeListener* Listener = NewObject<UTestInventoryChangeListener>();
+	Listener->Listen(InventoryComponent);
+
+	const TSubclassOf<UItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+	FGameplayTag FailureReason;
+
+	UItemInstance* FirstStack = InventoryComponent->TryAddItemDefinition(TestItemDef, 5).Instances[0];
+	UItemInstance* UniqueInstance = InventoryComponent->TryAddItemDefinition(UTestItemDefinition_Unique::StaticClass(), 1).Instances[0];
+	Listener->Reset();
+
+	InventoryComponent->SetDeferChangeNotifications(true);
+
+	// Modified then removed, reported as removed from the first count
+	InventoryComponent->TryConsumeFromHandle(InventoryComponent->FindHandleFromInstance(FirstStack), 2, FailureReason);
+	InventoryComponent->TryDestroyFromHandle(InventoryComponent->FindHandleFromInstance(FirstStack), FailureReason);
+
+	// Added then modified, reported as added with the last count
+	UItemInstance* SecondStack = InventoryComponent->TryAddItemDefinition(TestItemDef, 4).Instances.Last();
+	InventoryComponent->TryConsumeFromHandle(InventoryComponent->FindHandleFromInstance(SecondStack), 1, FailureReason);
+	InventoryComponent->TryAddItemDefinition(TestItemDef, 7);
+
+	// Added then removed, not reported
+	UItemInstance* ThirdStack = InventoryComponent->TryAddItemDefinition(TestItemDef, 2).Instances.Last();
+	InventoryComponent->TryDestroyFromHandle(InventoryComponent->FindHandleFromInstance(ThirdStack), FailureReason);
+
+	// Removed then added back, reported as modified
+	InventoryComponent->TryRemoveFromHandle(InventoryComponent->FindHandleFromInstance(UniqueInstance), FailureReason);
+	InventoryComponent->TryAddItemInstance(UniqueInstance, 1);
+
+	TestEqual(TEXT("Deferred changes should not be reported before the next tick"), Listener->Batches.Num(), 0);
+	TestEqual(TEXT("Deferred changes should not fire the per-entry events"), Listener->EntryChanges.Num(), 0);
+
+	++GFrameCounter;
+	World->GetTimerManager().Tick(0.f);
+
+	if (TestEqual(TEXT("Deferred changes should be reported once on the next tick"), Listener->Batches.Num(), 1))
+	{
+		const TArray<FInventoryChangeData>& Changes = Listener->Batches[0];
+		const FInventoryChangeData* FirstChange = Changes.FindByPredicate([FirstStack](const FInventoryChangeData& Change) { return Change.Instance == FirstStack; });
+		const FInventoryChangeData* SecondChange = Changes.FindByPredicate([SecondStack](const FInventoryChangeData& Change) { return Change.Instance == SecondStack; });
+		const FInventoryChangeData* UniqueChange = Changes.FindByPredicate([UniqueInstance](const FInventoryChangeData& Change) { return Change.Instance == UniqueInstance; });
+
+		TestEqual(TEXT("One change should be reported per entry"), Changes.Num(), 3);
+		TestTrue(TEXT("Modified then removed should be reported as removed"), FirstChange && FirstChange->ChangeType == EInventoryChangeType::Removed && FirstChange->OldCount == 5);
+		TestTrue(TEXT("Added then modified should be reported as added"), SecondChange && SecondChange->ChangeType == EInventoryChangeType::Added && SecondChange->NewCount == 10);
+		TestFalse(TEXT("Added then removed should not be reported"), Changes.ContainsByPredicate([ThirdStack](const FInventoryChangeData& Change) { return Change.Instance == ThirdStack; }));
+		TestTrue(TEXT("Removed then added should be reported as modified"), UniqueChange && UniqueChange->ChangeType == EInventoryChangeType::Modified);
+	}
+
+	// Batched changes in immediate mode are reported at the end of the scope, by both events
+	InventoryComponent->SetDeferChangeNotifications(false);
+	Listener->Reset();
+
+	TArray<FInventoryAddRequest> Requests;
+	Requests.Emplace(TestItemDef, 3);
+	Requests.Emplace(TestItemDef, 2);
+	InventoryComponent->TryAddItemDefinitions(Requests);
+
+	TestEqual(TEXT("Batch should be reported once"), Listener->Batches.Num(), 1);
+	TestTrue(TEXT("Batch should fire the per-entry events"), Listener->Batches.Num() == 1 && Listener->EntryChanges.Num() == Listener->Batches[0].Num());
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_InstancePoolTest::RunTest(const FString& Parameters)
+{
+	// The pool only exists in game worlds with pooling enabled
+	UInventorySystemSettings* Settings = GetMutableDefault<UInventorySystemSettings>();
+	const bool bSavedPoolItemInstances = Settings->bPoolItemInstances;
+	const int32 SavedMaxPooledInstances = Settings->MaxPooledInstances;
+	const float SavedReuseDelay = Settings->PooledInstanceReuseDelay;
+	Settings->bPoolItemInstances = true;
+	Settings->MaxPooledInstances = 1;
+	Settings->PooledInstanceReuseDelay = 0.f;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	AActor* TestActor = World->SpawnActor<AActor>();
+
+	const UItemInstancePool* Pool = World->GetSubsystem<UItemInstancePool>();
+	TestNotNull(TEXT("Pool should be created in game worlds"), Pool);
+
+	UItemDefinition* Definition = NewObject<UTestItemDefinition>();
+	UItemInstance* FirstInstance = UItemInstancePool::AcquireInstance(TestActor, UItemInstance::StaticClass());
+	UItemInstance* SecondInstance = UItemInstancePool::AcquireInstance(TestActor, UItemInstance::StaticClass());
+	FirstInstance->Initialize(Definition);
+	FirstInstance->AddTag(InventorySystemGameplayTags::TAG_Inventory_Container_Bag);
+	SecondInstance->Initialize(Definition);
+
+	// Only the instances kept by the pool are reset
+	UItemInstancePool::ReleaseInstance(FirstInstance);
+	UItemInstancePool::ReleaseInstance(SecondInstance);
+	TestEqual(TEXT("Pool should be capped by MaxPooledInstances"), Pool ? Pool->GetPooledCount(UItemInstance::StaticClass()) : 0, 1);
+	TestTrue(TEXT("Pooled instance should be reset"), FirstInstance->GetDefinitionClass() == nullptr && !FirstInstance->HasInstanceTags());
+	TestTrue(TEXT("Instance refused by a full pool should be left untouched"), SecondInstance->GetDefinitionClass() == UTestItemDefinition::StaticClass());
+
+	UItemInstance* ReusedInstance = UItemInstancePool::AcquireInstance(TestActor, UItemInstance::StaticClass());
+	TestTrue(TEXT("Pooled instance should be reused once its delay elapsed"), ReusedInstance == FirstInstance);
+	TestTrue(TEXT("Reused instance should be owned by the new actor"), ReusedInstance->GetOwningActor() == TestActor);
+	TestTrue(TEXT("Reused instance should be reset"), ReusedInstance->GetDefinitionClass() == nullptr && !ReusedInstance->HasInstanceTags() && ReusedInstance->GetComponents().IsEmpty());
+
+	// Instances are not handed out again before their delay elapsed
+	Settings->PooledInstanceReuseDelay = 3600.f;
+	UItemInstancePool::ReleaseInstance(ReusedInstance);
+	UItemInstance* NewInstance = UItemInstancePool::AcquireInstance(TestActor, UItemInstance::StaticClass());
+	TestTrue(TEXT("Pooled instance should not be reused before its delay"), NewInstance != ReusedInstance);
+	TestEqual(TEXT("Pooled instance should stay in the pool"), Pool ? Pool->GetPooledCount(UItemInstance::StaticClass()) : 0, 1);
+
+	// Cleaning
+	Settings->bPoolItemInstances = bSavedPoolItemInstances;
+	Settings->MaxPooledInstances = SavedMaxPooledInstances;
+	Settings->PooledInstanceReuseDelay = SavedReuseDelay;
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_DefinitionQueriesTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	const TSubclassOf<UItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+	const TSubclassOf<UItemDefinition> UniqueItemDef = UTestItemDefinition_Unique::StaticClass();
+
+	// 3 stacks (10, 10, 5) of the stackable item, surrounded by a unique item
+	InventoryComponent->TryAddItemDefinition(UniqueItemDef, 1);
+	InventoryComponent->TryAddItemDefinition(TestItemDef, 25);
+
+	TestEqual(TEXT("Stack count should be indexed"), InventoryComponent->GetStackCountByDefinition(TestItemDef), 3);
+	TestEqual(TEXT("Total count should be indexed"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), 25);
+	TestEqual(TEXT("Other definitions should not be mixed"), InventoryComponent->GetTotalCountByDefinition(UniqueItemDef), 1);
+
+	// Remove the unique item placed before the stacks, then the middle stack
+	FGameplayTag FailureReason;
+	const TArray<FInventoryEntryHandle> Stacks = InventoryComponent->GetAllStacks();
+	TestTrue(TEXT("Unique item should be removed"), InventoryComponent->TryRemoveFromHandle(Stacks[0], FailureReason));
+
+	const FInventoryEntryHandle MiddleStack = InventoryComponent->FindHandleFromInstance(Stacks[2].ItemInstance);
+	TestTrue(TEXT("Middle stack should be removed"), InventoryComponent->TryRemoveFromHandle(MiddleStack, FailureReason));
+
+	TestEqual(TEXT("Stack count should follow removals"), InventoryComponent->GetStackCountByDefinition(TestItemDef), 2);
+	TestEqual(TEXT("Total count should follow removals"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), 15);
+	TestEqual(TEXT("Removed definitions should not be counted"), InventoryComponent->GetTotalCountByDefinition(UniqueItemDef), 0);
+
+	// Top up the remaining stacks through the index
+	InventoryComponent->TryAddItemDefinition(TestItemDef, 5);
+	TestEqual(TEXT("Existing stacks should be topped up"), InventoryComponent->GetStackCountByDefinition(TestItemDef), 2);
+	TestEqual(TEXT("Total count should follow stack changes"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), 20);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_ContainerAggregatesTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	UInventoryContainer* Container = InventoryComponent->GetContainer(InventorySystemGameplayTags::TAG_Inventory_Container_Default);
+	TestNotNull(TEXT("Default container should exist"), Container);
+	if (!Container)
+	{
+		return false;
+	}
+
+	const TSubclassOf<UItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+
+	// 3 stacks (10, 10, 5) of 0.5 kg items
+	InventoryComponent->TryAddItemDefinition(TestItemDef, 25);
+	TestEqual(TEXT("Stacks should be aggregated"), Container->GetOccupiedStacks(), 3);
+	TestEqual(TEXT("Weight should be aggregated"), Container->GetTotalWeight(), 12.5f);
+
+	// Only 3 stacks allowed: topping up the last stack is accepted, a fourth stack is refused
+	UStoragePolicy_Capacity* Capacity = NewObject<UStoragePolicy_Capacity>(Container);
+	Capacity->MaxStacks = 3;
+	Container->AddStoragePolicy(Capacity);
+
+	TestTrue(TEXT("Existing stacks should be topped up"), InventoryComponent->TryAddItemDefinition(TestItemDef, 5).Succeeded());
+	const FInventoryResult Refused = InventoryComponent->TryAddItemDefinition(TestItemDef, 1);
+	TestTrue(TEXT("New stack should be refused"), Refused.FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_Capacity);
+
+	// Removals are reflected without iterating
+	FGameplayTag FailureReason;
+	TestTrue(TEXT("Stack should be removed"), InventoryComponent->TryRemoveFromHandle(InventoryComponent->GetAllStacks()[0], FailureReason));
+	TestEqual(TEXT("Stacks should follow removals"), Container->GetOccupiedStacks(), 2);
+	TestEqual(TEXT("Weight should follow removals"), Container->GetTotalWeight(), 10.f);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_ContainerViewTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	UInventoryContainer* Container = InventoryComponent->GetContainer(InventorySystemGameplayTags::TAG_Inventory_Container_Default);
+	TestNotNull(TEXT("Default container should exist"), Container);
+	if (!Container)
+	{
+		return false;
+	}
+
+	// Largest stacks first
+	UInventoryView* View = Container->CreateView(FGameplayTag(), EInventoryViewSortKey::StackCount, true);
+	InventoryComponent->TryAddItemDefinition(UTestItemDefinition::StaticClass(), 15);
+	InventoryComponent->TryAddItemDefinition(UTestItemDefinition_Unique::StaticClass(), 1);
+	View->FlushChanges();
+
+	TArray<FInventoryEntryHandle> Handles = View->GetHandles();
+	TestEqual(TEXT("View should follow additions"), Handles.Num(), 3);
+	TestEqual(TEXT("Largest stack should be sorted first"), Handles[0].StackCount, 10);
+	TestEqual(TEXT("Smallest stack should be sorted last"), Handles[2].StackCount, 1);
+
+	// Definition queries include child definitions
+	TestEqual(TEXT("Child definitions should match"), Container->GetInventoryList().GetHandlesOfType(UTestItemDefinition::StaticClass()).Num(), 3);
+	TestEqual(TEXT("Parent definitions should not match"), Container->GetInventoryList().GetHandlesOfType(UTestItemDefinition_Unique::StaticClass()).Num(), 1);
+
+	FGameplayTag FailureReason;
+	TestTrue(TEXT("Stack should be removed"), InventoryComponent->TryRemoveFromHandle(Handles[0], FailureReason));
+	Handles = View->GetHandles();
+	TestEqual(TEXT("View should follow removals"), Handles.Num(), 2);
+	TestEqual(TEXT("Remaining largest stack should be sorted first"), Handles[0].StackCount, 5);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_CompiledPolicyTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	const FInventoryResult Result = InventoryComponent->TryAddItemDefinition(UTestItemDefinition::StaticClass(), 1);
+	TestTrue(TEXT("Item should be added"), Result.Succeeded() && Result.Num() == 1);
+	if (!Result.Succeeded() || Result.Num() != 1)
+	{
+		return false;
+	}
+	UItemInstance* Instance = Result.Instances[0];
+
+	UStoragePolicy_TagRequirement* Policy = NewObject<UStoragePolicy_TagRequirement>(InventoryComponent);
+	FGameplayTag FailureReason;
+
+	// The test definition has no tag: nothing required is accepted, a required tag is refused
+	TestNotNull(TEXT("Tag requirements should compile"), Policy->GetCompiledPredicate());
+	TestTrue(TEXT("Compiled predicate should accept like the policy"), Policy->GetCompiledPredicate()->Evaluate(*Instance->GetDefinition()) && Policy->CanStoreItem(Instance, FailureReason));
+
+	Policy->RequiredTags.AddTag(InventorySystemGameplayTags::TAG_Inventory_Container_Bag);
+	Policy->InvalidateCompiledPredicate();
+	TestFalse(TEXT("Compiled predicate should refuse missing exact tags"), Policy->GetCompiledPredicate()->Evaluate(*Instance->GetDefinition()));
+	TestFalse(TEXT("Policy should refuse missing exact tags"), Policy->CanStoreItem(Instance, FailureReason));
+
+	// Non exact matching requires any of the tags
+	Policy->bExactMatch = false;
+	Policy->RequiredTags.Reset();
+	Policy->InvalidateCompiledPredicate();
+	TestFalse(TEXT("Compiled predicate should refuse without any required tag"), Policy->GetCompiledPredicate()->Evaluate(*Instance->GetDefinition()));
+	TestFalse(TEXT("Policy should refuse without any required tag"), Policy->CanStoreItem(Instance, FailureReason));
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_GridContainerTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	const FGameplayTag GridTag = InventorySystemGameplayTags::TAG_Inventory_Container_Bag;
+	UInventoryContainer_Grid* Grid = NewObject<UInventoryContainer_Grid>(InventoryComponent);
+	InventoryComponent->RegisterContainer(GridTag, Grid);
+
+	// 3 single cell stacks (10, 10, 5), placed on the first row
+	const TSubclassOf<UTestItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+	TestTrue(TEXT("Items should be added to the grid"), InventoryComponent->TryAddItemDefinitionIn(GridTag, TestItemDef, 25).Succeeded());
+	TestTrue(TEXT("Third cell should be occupied"), Grid->IsCellOccupied(2, 0));
+	TestFalse(TEXT("Fourth cell should be free"), Grid->IsCellOccupied(3, 0));
+
+	const TArray<FInventoryEntryHandle> Handles = Grid->GetInventoryList().GetAllHandles();
+	FGameplayTag FailureReason;
+	TestTrue(TEXT("Stack should move to a free cell"), Grid->TryMoveEntryTo(Handles[1], 5, 3, false, FailureReason));
+	TestFalse(TEXT("Stack should not move onto another one"), Grid->TryMoveEntryTo(Handles[1], 0, 0, false, FailureReason));
+	TestTrue(TEXT("Overlap should be refused for lack of space"), FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_NoSpace);
+
+	// Compaction gathers the remaining stacks at the beginning of the grid
+	FInventoryEntryHandle FirstStack = Handles[0];
+	TestTrue(TEXT("First stack should be removed"), Grid->TryRemoveItem(FirstStack, FailureReason));
+	TestTrue(TEXT("Grid should be compacted"), Grid->SortAndCompact());
+	TestTrue(TEXT("First cell should be occupied after compaction"), Grid->IsCellOccupied(0, 0));
+	TestTrue(TEXT("Second cell should be occupied after compaction"), Grid->IsCellOccupied(1, 0));
+	TestFalse(TEXT("Moved stack should be compacted"), Grid->IsCellOccupied(5, 3));
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_PredictionTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	const FGameplayTag DefaultTag = InventorySystemGameplayTags::TAG_Inventory_Container_Default;
+	const TSubclassOf<UTestItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+	UInventoryContainer* Container = InventoryComponent->GetContainer(DefaultTag);
+	TestTrue(TEXT("Items should be added"), InventoryComponent->TryAddItemDefinitionIn(DefaultTag, TestItemDef, 5).Succeeded());
+	const FInventoryEntryHandle Handle = Container->GetInventoryList().GetAllHandles()[0];
+
+	// The overlay only adds deltas, the replicated state stays untouched
+	FInventoryPredictionOverlay Overlay;
+	FInventoryPredictedChange Consume;
+	Consume.Operation = EInventoryPredictedOperation::Consume;
+	Consume.Container = Container;
+	Consume.DefinitionClass = TestItemDef;
+	Consume.EntryId = Handle.EntryId;
+	Consume.Generation = Handle.Generation;
+	Consume.Count = 2;
+	const int32 ConsumeKey = Overlay.AddPrediction(Consume).PredictionKey;
+
+	FInventoryPredictedChange OtherConsume = Consume;
+	OtherConsume.Count = 1;
+	const int32 OtherKey = Overlay.AddPrediction(OtherConsume).PredictionKey;
+
+	TestNotEqual(TEXT("Prediction keys should be unique"), ConsumeKey, OtherKey);
+	TestEqual(TEXT("Count delta should sum the predictions"), Overlay.GetCountDelta(Container, TestItemDef), -3);
+	TestEqual(TEXT("Entry delta should sum the predictions"), Overlay.GetEntryDelta(Container, Handle.EntryId, Handle.Generation), -3);
+
+	// State of an unrelated change arrives first, it does not show the predictions
+	TArray<FInventoryPredictedChange> Reconciled;
+	Overlay.Reconcile(Container, Reconciled);
+	TestEqual(TEXT("Unrelated state should not end the predictions"), Reconciled.Num(), 0);
+
+	// Accepted before its state is received: kept until the container shows the change
+	FInventoryPredictedChange Ended;
+	TestFalse(TEXT("Accepted prediction should wait for the replicated state"), Overlay.Acknowledge(ConsumeKey, true, Ended));
+	TestTrue(TEXT("Refused prediction should be rolled back"), Overlay.Acknowledge(OtherKey, false, Ended));
+	TestEqual(TEXT("Rolled back prediction should be reported"), Ended.PredictionKey, OtherKey);
+	TestEqual(TEXT("Rolled back consumption should no longer count"), Overlay.GetCountDelta(Container, TestItemDef), -2);
+
+	Overlay.Reconcile(Container, Reconciled);
+	TestEqual(TEXT("Accepted prediction should wait for its change to replicate"), Reconciled.Num(), 0);
+
+	// A smaller change of the source stack is not the predicted one
+	FGameplayTag FailureReason;
+	TestTrue(TEXT("Unrelated consumption should be applied"), InventoryComponent->TryConsumeFromHandle(Handle, 1, FailureReason));
+	Overlay.Reconcile(Container, Reconciled);
+	TestEqual(TEXT("Smaller change should not end the prediction"), Reconciled.Num(), 0);
+
+	// The server applies the change, as the replicated state would
+	TestTrue(TEXT("Predicted consumption should be applied"), InventoryComponent->TryConsumeFromHandle(Handle, 2, FailureReason));
+	Overlay.Reconcile(Container, Reconciled);
+	TestEqual(TEXT("Accepted prediction should end with the replicated state"), Reconciled.Num(), 1);
+	TestTrue(TEXT("Overlay should be empty"), Overlay.IsEmpty());
+
+	// State showing the change received before the acknowledgement, then unanswered predictions expire
+	Consume.Count = 1;
+	const int32 LateKey = Overlay.AddPrediction(Consume).PredictionKey;
+	Overlay.Reconcile(Container, Reconciled);
+	TestFalse(TEXT("Acknowledgement should wait for the change"), Overlay.GetPredictions()[0].bReplicated);
+	TestTrue(TEXT("Predicted consumption should be applied"), InventoryComponent->TryConsumeFromHandle(Handle, 1, FailureReason));
+	Overlay.Reconcile(Container, Reconciled);
+	TestTrue(TEXT("Acknowledgement after the state should end the prediction"), Overlay.Acknowledge(LateKey, true, Ended));
+	TArray<FInventoryPredictedChange> Expired;
+	OtherConsume.ExpirationTime = 1.0;
+	Overlay.AddPrediction(OtherConsume);
+	Overlay.Expire(2.0, Expired);
+	TestEqual(TEXT("Unanswered prediction should expire"), Expired.Num(), 1);
+	TestFalse(TEXT("Unanswered prediction should be rolled back"), Expired[0].bAccepted);
+
+	// Accepted, its state never shown: reported as confirmed by the component
+	Expired.Reset();
+	const int32 AcceptedKey = Overlay.AddPrediction(OtherConsume).PredictionKey;
+	TestFalse(TEXT("Accepted prediction should wait for the replicated state"), Overlay.Acknowledge(AcceptedKey, true, Ended));
+	Overlay.Expire(2.0, Expired);
+	TestTrue(TEXT("Accepted prediction should expire as accepted"), Expired.Num() == 1 && Expired[0].bAccepted);
+
+	// On authority, predicted operations run directly
+	TestTrue(TEXT("Items should be added"), InventoryComponent->TryAddItemDefinitionIn(DefaultTag, TestItemDef, 1).Succeeded());
+	int32 PredictionKey = INDEX_NONE;
+	TestTrue(TEXT("Consumption should run on authority"), InventoryComponent->PredictConsumeItems(Handle, 1, PredictionKey, FailureReason));
+	TestEqual(TEXT("Nothing should be predicted on authority"), PredictionKey, 0);
+	TestEqual(TEXT("Stack should be partially consumed"), InventoryComponent->GetPredictedStackCount(Handle), 1);
+	TestFalse(TEXT("Consuming more than the stack should fail"), InventoryComponent->TryConsumeFromHandle(Handle, 2, FailureReason));
+	TestTrue(TEXT("Whole stack should be consumed"), InventoryComponent->TryConsumeFromHandle(Handle, 1, FailureReason));
+	TestEqual(TEXT("Consumed stack should be removed"), InventoryComponent->GetPredictedTotalCountByDefinitionIn(TestItemDef, DefaultTag), 0);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_SnapshotTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	const FGameplayTag DefaultTag = InventorySystemGameplayTags::TAG_Inventory_Container_Default;
+	const FGameplayTag InstanceTag = InventorySystemGameplayTags::TAG_Inventory_Container_Bag;
+	const TSubclassOf<UTestItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+	const TSubclassOf<UTestItemDefinition_Unique> UniqueItemDef = UTestItemDefinition_Unique::StaticClass();
+
+	const FInventoryResult Result = InventoryComponent->TryAddItemDefinitionIn(DefaultTag, TestItemDef, 25);
+	TestTrue(TEXT("Items should be added"), Result.Succeeded());
+	TestTrue(TEXT("Unique item should be added"), InventoryComponent->TryAddItemDefinitionIn(DefaultTag, UniqueItemDef, 1).Succeeded());
+	Result.Instances[0]->AddTag(InstanceTag);
+
+	TArray<uint8> Data;
+	InventoryComponent->SaveSnapshot(Data);
+	TestTrue(TEXT("Snapshot should be written"), Data.Num() > 0);
+
+	// Tables are shared: one definition path per class, whatever the number of stacks
+	FInventorySnapshot Snapshot;
+	TestTrue(TEXT("Snapshot should be decoded"), Snapshot.Decode(MakeMemoryView(Data)));
+	TestEqual(TEXT("Every stack should be decoded"), Snapshot.GetNumEntries(), 4);
+
+	InventoryComponent->Empty();
+	TestEqual(TEXT("Inventory should be emptied"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), 0);
+
+	TestTrue(TEXT("Snapshot should be loaded"), InventoryComponent->LoadSnapshot(Data));
+	TestEqual(TEXT("Item count should be restored"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), 25);
+	TestEqual(TEXT("Stacks should be restored"), InventoryComponent->GetStackCountByDefinition(TestItemDef), 3);
+	TestEqual(TEXT("Unique item should be restored"), InventoryComponent->GetTotalCountByDefinition(UniqueItemDef), 1);
+
+	bool bTagRestored = false;
+	for (const FInventoryEntryHandle& Handle : InventoryComponent->GetAllStacks())
+	{
+		bTagRestored |= IsValid(Handle.ItemInstance) && Handle.ItemInstance->GetInstanceTags().HasTagExact(InstanceTag);
+	}
+	TestTrue(TEXT("Instance tags should be restored"), bTagRestored);
+
+	// Corrupted data is refused before touching the inventory
+	TArray<uint8> Truncated = Data;
+	Truncated.SetNum(Data.Num() - 3);
+	TestFalse(TEXT("Truncated snapshot should be refused"), InventoryComponent->LoadSnapshot(Truncated));
+	TArray<uint8> NotSnapshot = Data;
+	NotSnapshot[0] ^= 0xFF;
+	TestFalse(TEXT("Data without magic should be refused"), InventoryComponent->LoadSnapshot(NotSnapshot));
+	TestEqual(TEXT("Refused snapshots should leave the inventory untouched"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), 25);
+
+	// Saved entries are restored as is, even if the rules of the container changed since
+	UStoragePolicy_Capacity* Capacity = NewObject<UStoragePolicy_Capacity>(InventoryComponent->GetContainer(DefaultTag));
+	Capacity->MaxStacks = 1;
+	InventoryComponent->GetContainer(DefaultTag)->AddStoragePolicy(Capacity);
+	TestTrue(TEXT("Snapshot should be loaded"), InventoryComponent->LoadSnapshot(Data));
+	TestEqual(TEXT("Stacks above the new capacity should be restored"), InventoryComponent->GetStackCountByDefinition(TestItemDef), 3);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_CommodityTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	const FGameplayTag DefaultTag = InventorySystemGameplayTags::TAG_Inventory_Container_Default;
+	const FGameplayTag BagTag = InventorySystemGameplayTags::TAG_Inventory_Container_Bag;
+	InventoryComponent->RegisterContainer(BagTag, NewObject<UInventoryContainer>(InventoryComponent));
+	const TSubclassOf<UTestItemDefinition_Commodity> CommodityItemDef = UTestItemDefinition_Commodity::StaticClass();
+
+	UTestInventoryChangeListener* Listener = NewObject<UTestInventoryChangeListener>();
+	Listener->Listen(InventoryComponent);
+
+	InventoryComponent->SetJournalChanges(true);
+	TArray<uint8> Checkpoint;
+	InventoryComponent->SaveCheckpoint(Checkpoint);
+
+	// Commodities are stored as counters, stacked as usual
+	const FInventoryResult Result = InventoryComponent->TryAddItemDefinitionIn(DefaultTag, CommodityItemDef, 25);
+	TestTrue(TEXT("Commodity items should be added"), Result.Succeeded());
+	TestEqual(TEXT("Commodity items should not create instances"), Result.Num(), 0);
+	TestEqual(TEXT("Commodity items should be stacked"), InventoryComponent->GetStackCountByDefinition(CommodityItemDef), 3);
+
+	TArray<FInventoryEntryHandle> Stacks = InventoryComponent->GetAllStacks();
+	TestTrue(TEXT("Commodity handles should have no instance"), Stacks.Num() == 3 && Stacks[0].ItemInstance == nullptr && Stacks[0].DefinitionClass == CommodityItemDef);
+	TestTrue(TEXT("Commodity entries should be reported without instance"), Listener->EntryChanges.Num() == 3 && Listener->EntryChanges[0].Instance == nullptr && Listener->EntryChanges[0].DefinitionClass == CommodityItemDef);
+
+	// Whole stack moved, then part of another one transferred
+	UInventoryContainer* Bag = InventoryComponent->GetContainer(BagTag);
+	TestTrue(TEXT("Commodity stack should be moved"), InventoryComponent->TryMoveByHandle(Stacks[0], Bag).Succeeded());
+	TestTrue(TEXT("Commodity items should be transferred"), InventoryComponent->TryTransferItems(Stacks[1], Bag, 3).Succeeded());
+	TestEqual(TEXT("Bag should receive the moved and transferred items"), Bag->GetTotalCountByDefinition(CommodityItemDef), 13);
+	TestEqual(TEXT("Default container should keep the rest"), InventoryComponent->GetContainer(DefaultTag)->GetTotalCountByDefinition(CommodityItemDef), 12);
+
+	// Coalesced changes of different commodity stacks are kept apart, by entry identifier and generation
+	InventoryComponent->SetDeferChangeNotifications(true);
+	Listener->Reset();
+	FGameplayTag FailureReason;
+	for (const FInventoryEntryHandle& Handle : InventoryComponent->GetAllStacks())
+	{
+		if (Handle.Container != Bag)
+		{
+			InventoryComponent->TryConsumeFromHandle(Handle, 1, FailureReason);
+		}
+	}
+	++GFrameCounter;
+	World->GetTimerManager().Tick(0.f);
+	TestTrue(TEXT("Each consumed commodity stack should be reported"), Listener->Batches.Num() == 1 && Listener->Batches[0].Num() == 2
+		&& Listener->Batches[0][0].EntryId != Listener->Batches[0][1].EntryId);
+	InventoryComponent->SetDeferChangeNotifications(false);
+
+	// The journal identifies commodity entries by their slot
+	TArray<uint8> Compacted;
+	TestTrue(TEXT("Journal should be compacted"), FInventoryJournal::Compact(MakeMemoryView(Checkpoint), MakeMemoryView(InventoryComponent->GetJournal().GetData()), Compacted));
+	InventoryComponent->Empty();
+	TestTrue(TEXT("Compacted snapshot should be loaded"), InventoryComponent->LoadSnapshot(Compacted));
+	TestEqual(TEXT("Bag commodities should be replayed"), InventoryComponent->GetContainer(BagTag)->GetTotalCountByDefinition(CommodityItemDef), 13);
+	TestEqual(TEXT("Default commodities should be replayed"), InventoryComponent->GetContainer(DefaultTag)->GetTotalCountByDefinition(CommodityItemDef), 10);
+	TestEqual(TEXT("Commodity stacks should be replayed"), InventoryComponent->GetStackCountByDefinition(CommodityItemDef), 4);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_JournalTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	const FGameplayTag DefaultTag = InventorySystemGameplayTags::TAG_Inventory_Container_Default;
+	const TSubclassOf<UTestItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+	const TSubclassOf<UTestItemDefinition_Unique> UniqueItemDef = UTestItemDefinition_Unique::StaticClass();
+
+	InventoryComponent->SetJournalChanges(true);
+	TestTrue(TEXT("Items should be added"), InventoryComponent->TryAddItemDefinitionIn(DefaultTag, TestItemDef, 15).Succeeded());
+	TArray<uint8> Checkpoint;
+	InventoryComponent->SaveCheckpoint(Checkpoint);
+	TestEqual(TEXT("Checkpoint should restart the journal"), InventoryComponent->GetJournal().GetNumRecords(), 0);
+
+	// Stacks (10, 5) become (10, 10, 2), the first one is removed then a unique item is added
+	TestTrue(TEXT("Items should be added after the checkpoint"), InventoryComponent->TryAddItemDefinitionIn(DefaultTag, TestItemDef, 7).Succeeded());
+	FGameplayTag FailureReason;
+	TestTrue(TEXT("First stack should be removed"), InventoryComponent->TryDestroyFromHandle(InventoryComponent->GetAllStacks()[0], FailureReason));
+	TestTrue(TEXT("Unique item should be added"), InventoryComponent->TryAddItemDefinitionIn(DefaultTag, UniqueItemDef, 1).Succeeded());
+	TestTrue(TEXT("Changes should be journaled"), InventoryComponent->GetJournal().GetNumRecords() > 0);
+
+	const TArray<uint8> JournalData = InventoryComponent->GetJournal().GetData();
+	const int32 ExpectedCount = InventoryComponent->GetTotalCountByDefinition(TestItemDef);
+	const int32 ExpectedStacks = InventoryComponent->GetStackCountByDefinition(TestItemDef);
+	TestEqual(TEXT("Expected count should match the changes"), ExpectedCount, 12);
+
+	// Folding the journal into the checkpoint gives the current state
+	TArray<uint8> Compacted;
+	TestTrue(TEXT("Journal should be compacted"), FInventoryJournal::Compact(MakeMemoryView(Checkpoint), MakeMemoryView(JournalData), Compacted));
+	InventoryComponent->Empty();
+	TestTrue(TEXT("Compacted snapshot should be loaded"), InventoryComponent->LoadSnapshot(Compacted));
+	TestEqual(TEXT("Compacted count should match"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), ExpectedCount);
+	TestEqual(TEXT("Compacted stacks should match"), InventoryComponent->GetStackCountByDefinition(TestItemDef), ExpectedStacks);
+	TestEqual(TEXT("Unique item should be restored"), InventoryComponent->GetTotalCountByDefinition(UniqueItemDef), 1);
+	TestEqual(TEXT("Loading should restart the journal"), InventoryComponent->GetJournal().GetNumRecords(), 0);
+
+	// Entries keep their saved slots through the load, so changes made after it replay over the loaded snapshot
+	const FGameplayTag InstanceTag = InventorySystemGameplayTags::TAG_Inventory_Container_Bag;
+	for (const FInventoryEntryHandle& Handle : InventoryComponent->GetAllStacks())
+	{
+		if (Handle.ItemInstance)
+		{
+			// Instance tags are journaled with the whole state of their entry
+			const int32 NumRecords = InventoryComponent->GetJournal().GetNumRecords();
+			Handle.ItemInstance->AddTag(InstanceTag);
+			TestTrue(TEXT("Instance tag change should be journaled"), InventoryComponent->GetJournal().GetNumRecords() > NumRecords);
+		}
+		else if (Handle.StackCount > 3)
+		{
+			TestTrue(TEXT("Loaded stack should be consumed"), InventoryComponent->TryConsumeFromHandle(Handle, 3, FailureReason));
+		}
+	}
+	TestTrue(TEXT("Changes after the load should be journaled"), InventoryComponent->GetJournal().GetNumRecords() > 0);
+
+	const TArray<uint8> LoadedJournalData = InventoryComponent->GetJournal().GetData();
+	TestTrue(TEXT("Compacted snapshot and journal should be replayed"), InventoryComponent->LoadSnapshotWithJournal(Compacted, LoadedJournalData));
+	TestEqual(TEXT("Consumption after the load should be replayed"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), ExpectedCount - 3);
+	bool bTagReplayed = false;
+	for (const FInventoryEntryHandle& Handle : InventoryComponent->GetAllStacks())
+	{
+		bTagReplayed |= IsValid(Handle.ItemInstance) && Handle.ItemInstance->GetInstanceTags().HasTagExact(InstanceTag);
+	}
+	TestTrue(TEXT("Instance tag added after the load should be replayed"), bTagReplayed);
+
+	// Replay after a crash, the last record being cut in the middle
+	TArray<uint8> CutJournal = JournalData;
+	CutJournal.SetNum(JournalData.Num() - 1);
+	TestTrue(TEXT("Checkpoint and journal should be replayed"), InventoryComponent->LoadSnapshotWithJournal(Checkpoint, CutJournal));
+	TestEqual(TEXT("Complete records should be replayed"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), ExpectedCount);
+	TestEqual(TEXT("Cut record should be ignored"), InventoryComponent->GetTotalCountByDefinition(UniqueItemDef), 0);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+bool FInventory_AsyncSnapshotTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	UInventorySystemComponent* InventoryComponent = InventorySystemTests::CreateInventory(World);
+
+	const FGameplayTag DefaultTag = InventorySystemGameplayTags::TAG_Inventory_Container_Default;
+	const TSubclassOf<UTestItemDefinition> TestItemDef = UTestItemDefinition::StaticClass();
+	const TSubclassOf<UTestItemDefinition_Unique> UniqueItemDef = UTestItemDefinition_Unique::StaticClass();
+
+	// Runs the game thread tasks and the timers as frames would, until the load ends
+	auto WaitForLoad = [World, InventoryComponent]()
+	{
+		for (int32 Frame = 0; Frame < 10000 && InventoryComponent->IsLoadingSnapshot(); ++Frame)
+		{
+			FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+			++GFrameCounter;
+			World->GetTimerManager().Tick(0.f);
+			FPlatformProcess::Sleep(0.001f);
+		}
+	};
+
+	TestTrue(TEXT("Items should be added"), InventoryComponent->TryAddItemDefinitionIn(DefaultTag, TestItemDef, 250).Succeeded());
+	TestTrue(TEXT("Unique items should be added"), InventoryComponent->TryAddItemDefinitionIn(DefaultTag, UniqueItemDef, 5).Succeeded());
+	TArray<uint8> Data;
+	InventoryComponent->SaveSnapshot(Data);
+
+	// Invalid data leaves the inventory untouched
+	TArray<uint8> Corrupted = Data;
+	Corrupted.SetNum(Data.Num() / 2);
+	InventoryComponent->LoadSnapshotAsync(Corrupted, FOnInventorySnapshotLoaded());
+	TestTrue(TEXT("Load should be running"), InventoryComponent->IsLoadingSnapshot());
+	WaitForLoad();
+	TestFalse(TEXT("Invalid load should end"), InventoryComponent->IsLoadingSnapshot());
+	TestEqual(TEXT("Invalid load should keep the items"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), 250);
+
+	InventoryComponent->Empty();
+	InventoryComponent->LoadSnapshotAsync(Data, FOnInventorySnapshotLoaded());
+
+	// Changes are refused until the load ends, as it would overwrite them
+	const FInventoryResult RefusedResult = InventoryComponent->TryAddItemDefinitionIn(DefaultTag, TestItemDef, 1);
+	TestFalse(TEXT("Addition during a load should be refused"), RefusedResult.Succeeded());
+	TestTrue(TEXT("Refusal should report the load"), RefusedResult.FailureReason == InventorySystemGameplayTags::TAG_Inventory_Failure_Loading);
+
+	WaitForLoad();
+	TestFalse(TEXT("Load should end"), InventoryComponent->IsLoadingSnapshot());
+	TestEqual(TEXT("Count should be restored"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), 250);
+	TestEqual(TEXT("Stacks should be restored"), InventoryComponent->GetStackCountByDefinition(TestItemDef), 25);
+	TestEqual(TEXT("Unique items should be restored"), InventoryComponent->GetTotalCountByDefinition(UniqueItemDef), 5);
+	TestTrue(TEXT("Addition after the load should succeed"), InventoryComponent->TryAddItemDefinitionIn(DefaultTag, TestItemDef, 1).Succeeded());
+
+	// A cancelled load keeps what was materialized, the next load replaces it
+	InventoryComponent->LoadSnapshotAsync(Data, FOnInventorySnapshotLoaded());
+	InventoryComponent->CancelSnapshotLoad();
+	TestFalse(TEXT("Load should be cancelled"), InventoryComponent->IsLoadingSnapshot());
+	TestTrue(TEXT("Synchronous load should succeed"), InventoryComponent->LoadSnapshot(Data));
+	TestEqual(TEXT("Count should be restored after a cancel"), InventoryComponent->GetTotalCountByDefinition(TestItemDef), 250);
+
+	// Cleaning
+	World->DestroyWorld(false);
+
+	return true;
+}
+
 #endif
@@ -28,6 +28,7 @@ public:
 		check(StorableFragment);
 
 		StorableFragment->MaxStackCount = 10;
+		StorableFragment->Weight = 0.5f;
 		Fragments.Add(StorableFragment);
 	}
 
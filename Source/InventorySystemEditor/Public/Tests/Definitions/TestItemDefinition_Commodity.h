@@ -0,0 +1,27 @@
+// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TestItemDefinition.h"
+#include "TestItemDefinition_Commodity.generated.h"
+
+/**
+ * @class UTestItemDefinition_Commodity
+ * @see UTestItemDefinition
+ * This class of ItemDefinition is created for automation test only for a commodity item, stored without instance.
+ * /!\ SHOULD NOT USED FOR GAMEPLAY /!\
+ */
+UCLASS(Experimental, Hidden)
+
+class INVENTORYSYSTEMEDITOR_API UTestItemDefinition_Commodity : public UTestItemDefinition
+{
+	GENERATED_BODY()
+
+public:
+	UTestItemDefinition_Commodity(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get())
+		: Super(ObjectInitializer.Get())
+	{
+		StorableFragment->bCommodity = true;
+	}
+};
@@ -0,0 +1,49 @@
+// Licensed under the MIT License. See the LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InventorySystemComponent.h"
+#include "UObject/Object.h"
+#include "TestInventoryChangeListener.generated.h"
+
+/**
+ * @class UTestInventoryChangeListener
+ * @see UInventorySystemComponent
+ * Records the change events of an inventory component, for automation tests only.
+ * /!\ SHOULD NOT USED FOR GAMEPLAY /!\
+ */
+UCLASS(Experimental, Hidden)
+class INVENTORYSYSTEMEDITOR_API UTestInventoryChangeListener : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Binds the batch and per-entry events of an inventory */
+	void Listen(UInventorySystemComponent* Inventory)
+	{
+		Inventory->OnInventoryBatchChanged.AddDynamic(this, &ThisClass::HandleBatchChanged);
+		Inventory->OnInventoryEntryAdded.AddDynamic(this, &ThisClass::HandleEntryChanged);
+		Inventory->OnInventoryEntryRemoved.AddDynamic(this, &ThisClass::HandleEntryChanged);
+		Inventory->OnInventoryEntryChanged.AddDynamic(this, &ThisClass::HandleEntryChanged);
+	}
+
+	void Reset()
+	{
+		Batches.Reset();
+		EntryChanges.Reset();
+	}
+
+	/** Changes received by OnInventoryBatchChanged, one array per event */
+	TArray<TArray<FInventoryChangeData>> Batches;
+
+	/** Changes received by the per-entry events */
+	TArray<FInventoryChangeData> EntryChanges;
+
+protected:
+	UFUNCTION()
+	void HandleBatchChanged(const TArray<FInventoryChangeData>& Changes) { Batches.Add(Changes); }
+
+	UFUNCTION()
+	void HandleEntryChanged(const FInventoryChangeData& Data) { EntryChanges.Add(Data); }
+};